@@ -30,6 +30,11 @@
 #include <QPushButton>
 #include <QGroupBox>
 #include <QGridLayout>
+#include <QVBoxLayout>
+#include <QScrollArea>
+#include <QIcon>
+
+#include <algorithm>
 
 using namespace stackviz;
 
@@ -43,8 +48,8 @@ DisplayManagerWidget::DisplayManagerWidget( )
 {
 }
 
-void DisplayManagerWidget::init(  const std::vector< visimpl::EventWidget* >* eventData,
-                                  const std::vector< visimpl::HistogramWidget* >* histData )
+void DisplayManagerWidget::init(  const std::vector< visimpl::Summary::EventRow >* eventData,
+                                  const std::vector< visimpl::Summary::HistogramRow >* histData )
 {
   setMinimumWidth( 500 );
 
@@ -60,7 +65,7 @@ void DisplayManagerWidget::init(  const std::vector< visimpl::EventWidget* >* ev
   auto globalLayout = new QGridLayout( );
 
   // Events
-  _eventsLayout = new QGridLayout( );
+  _eventsLayout = new QVBoxLayout( );
   _eventsLayout->setAlignment( Qt::AlignTop );
 
   auto eventScrollContainer = new QWidget( );
@@ -89,7 +94,7 @@ void DisplayManagerWidget::init(  const std::vector< visimpl::EventWidget* >* ev
   eventGroup->layout( )->addWidget( eventScroll );
 
   // Histograms
-  _histogramsLayout = new QGridLayout( );
+  _histogramsLayout = new QVBoxLayout( );
   _histogramsLayout->setAlignment( Qt::AlignTop );
 
   auto histoScrollContainer = new QWidget( );
@@ -152,156 +157,215 @@ void DisplayManagerWidget::clearWidgets(void)
 
 void DisplayManagerWidget::clearEventWidgets(void)
 {
-  auto removeEventWidget = [this](TDisplayEventTuple &e)
-  {
-    auto container = std::get< TDM_E_CONTAINER >( e );
-    _eventsLayout->removeWidget( container );
+  while (!_events.empty())
+    removeEventRow(_events.size() - 1);
+}
 
-    delete container;
-  };
-  std::for_each(_events.begin(), _events.end(), removeEventWidget);
+void DisplayManagerWidget::clearHistogramWidgets(void)
+{
+  while (!_histograms.empty())
+    removeHistogramRow(_histograms.size() - 1);
+}
 
-  QLayoutItem *item;
-  while ((item = _eventsLayout->takeAt(0)) != nullptr)
-  {
-    delete item->widget();
-    delete item;
-  }
+void DisplayManagerWidget::refresh()
+{
+  refreshEvents();
 
-  _events.clear();
+  refreshHistograms();
 }
 
-void DisplayManagerWidget::clearHistogramWidgets(void)
+namespace
 {
-  auto removeHistogramWidget = [this](TDisplayHistogramTuple &e)
+  // Loaded once, every row shares the same icon instances.
+  const QIcon &showIcon()
   {
-    auto container = std::get< TDM_H_CONTAINER >( e );
-    _histogramsLayout->removeWidget( container );
+    static const QIcon icon(":icons/show.svg");
+    return icon;
+  }
 
-    delete container;
-  };
-  std::for_each(_histograms.begin(), _histograms.end(), removeHistogramWidget);
+  const QIcon &hideIcon()
+  {
+    static const QIcon icon(":icons/hide.svg");
+    return icon;
+  }
 
-  QLayoutItem *item;
-  while ((item = _histogramsLayout->takeAt(0)) != nullptr)
+  const QIcon &trashIcon()
   {
-    delete item->widget();
-    delete item;
+    static const QIcon icon(":icons/trash.svg");
+    return icon;
   }
 
-  _histograms.clear();
+  QFrame *separatorLine(QWidget *parent)
+  {
+    QFrame *line = new QFrame(parent);
+    line->setFrameShape(QFrame::HLine);
+    line->setFrameShadow(QFrame::Sunken);
+
+    return line;
+  }
 }
 
-void DisplayManagerWidget::refresh()
+TDisplayEventTuple DisplayManagerWidget::createEventRow(const visimpl::Summary::EventRow &ev)
 {
-  if (_dirtyFlagEvents) refreshEvents();
+  QWidget *container = new QWidget();
+  container->setMaximumHeight(50);
+  // Fill name
+  QGridLayout *contLayout = new QGridLayout();
+  container->setLayout(contLayout);
+
+  QLabel *nameLabel = new QLabel(tr(ev.widget->name().c_str()), container);
+  QPushButton *hideButton = new QPushButton(container);
+  hideButton->setIcon(showIcon());
+  hideButton->setCheckable(true);
+  hideButton->setChecked(true);
+  hideButton->setWhatsThis("Click to show/hide the row in main view.");
 
-  if (_dirtyFlagHistograms) refreshHistograms();
+  QPushButton *deleteButton = new QPushButton(container);
+  deleteButton->setIcon(trashIcon());
+
+  QFrame *line = separatorLine(container);
+
+  contLayout->addWidget(nameLabel, 0, 0, 1, 2);
+  contLayout->addWidget(hideButton, 0, 2, 1, 1);
+  contLayout->addWidget(deleteButton, 0, 3, 1, 1);
+  contLayout->addWidget(line, 1, 0, 1, 4);
+
+  connect(hideButton, SIGNAL(clicked( )),
+          this,       SLOT(hideEventClicked( )));
+
+  connect(deleteButton, SIGNAL(clicked( )),
+          this,         SLOT(deleteEventClicked( )));
+
+  return std::make_tuple(container, nameLabel, hideButton, deleteButton, line);
 }
 
-void DisplayManagerWidget::refreshEvents(void)
+TDisplayHistogramTuple DisplayManagerWidget::createHistogramRow(const visimpl::Summary::HistogramRow &hist)
 {
-  clearEventWidgets();
+  QWidget *container = new QWidget();
+  container->setMaximumHeight(50);
 
-  unsigned int row = 0;
-  for (const auto &ev : *_eventData)
-  {
-    QWidget *container = new QWidget();
-    container->setMaximumHeight(50);
-    // Fill name
-    QGridLayout *contLayout = new QGridLayout();
-    container->setLayout(contLayout);
+  // Fill name
+  QGridLayout *contLayout = new QGridLayout();
+  container->setLayout(contLayout);
 
-    QLabel *nameLabel = new QLabel(tr(ev->name().c_str()), container);
-    QPushButton *hideButton = new QPushButton(container);
-    hideButton->setIcon(QIcon(QPixmap(":icons/show.svg")));
-    hideButton->setCheckable(true);
-    hideButton->setChecked(true);
-    hideButton->setWhatsThis("Click to show/hide the row in main view.");
+  QLabel *nameLabel = new QLabel(tr(hist.name.c_str()), container);
 
-    QPushButton *deleteButton = new QPushButton(container);
-    deleteButton->setIcon(QIcon(QPixmap(":icons/trash.svg")));
+  QLabel *numberLabel = new QLabel(QString::number(hist.size), container);
 
-    contLayout->addWidget(nameLabel, row, 0, 1, 2);
-    contLayout->addWidget(hideButton, row, 2, 1, 1);
-    contLayout->addWidget(deleteButton, row, 3, 1, 1);
+  QPushButton *hideButton = new QPushButton(container);
+  hideButton->setIcon(showIcon());
+  hideButton->setCheckable(true);
+  hideButton->setChecked(true);
+  hideButton->setWhatsThis("Click to show/hide the row in main view.");
 
-    _eventsLayout->addWidget(container);
+  QPushButton *deleteButton = new QPushButton(container);
+  deleteButton->setIcon(trashIcon());
 
-    if (row < _eventData->size() - 1)
-    {
-      QFrame *line = new QFrame(container);
-      line->setFrameShape(QFrame::HLine);
-      line->setFrameShadow(QFrame::Sunken);
-
-      _eventsLayout->addWidget(line);
-    }
+  QFrame *line = separatorLine(container);
 
-    connect(hideButton, SIGNAL(clicked( )),
-            this,       SLOT(hideEventClicked( )));
+  contLayout->addWidget(nameLabel, 0, 0, 1, 2);
+  contLayout->addWidget(numberLabel, 0, 2, 1, 1);
+  contLayout->addWidget(hideButton, 0, 3, 1, 1);
+  contLayout->addWidget(deleteButton, 0, 4, 1, 1);
+  contLayout->addWidget(line, 1, 0, 1, 5);
 
-    connect(deleteButton, SIGNAL(clicked( )),
-            this,         SLOT(deleteEventClicked( )));
+  connect(hideButton, SIGNAL(clicked( )),
+          this,       SLOT(hideHistoClicked( )));
 
-    _events.push_back(std::make_tuple(container, nameLabel, hideButton, deleteButton));
-    ++row;
-  }
+  connect(deleteButton, SIGNAL(clicked( )),
+          this,         SLOT(deleteHistoClicked( )));
 
-  _dirtyFlagEvents = false;
+  return std::make_tuple(container, nameLabel, numberLabel, hideButton, deleteButton, line);
 }
 
-void DisplayManagerWidget::refreshHistograms(void)
+void DisplayManagerWidget::removeEventRow(unsigned int row)
 {
-  clearHistogramWidgets();
+  auto container = std::get< TDM_E_CONTAINER >( _events[row] );
+  _eventsLayout->removeWidget( container );
 
-  unsigned int row = 0;
-  for (const auto &hist : *_histData)
-  {
-    QWidget *container = new QWidget();
-    container->setMaximumHeight(50);
+  // The row may own the button whose click is being handled.
+  container->hide( );
+  container->deleteLater( );
 
-    // Fill name
-    QGridLayout *contLayout = new QGridLayout();
-    container->setLayout(contLayout);
+  _events.erase(_events.begin() + row);
+  _eventKeys.erase(_eventKeys.begin() + row);
+}
 
-    QLabel *nameLabel = new QLabel(tr(hist->name().c_str()), container);
+void DisplayManagerWidget::removeHistogramRow(unsigned int row)
+{
+  auto container = std::get< TDM_H_CONTAINER >( _histograms[row] );
+  _histogramsLayout->removeWidget( container );
 
-    QLabel *numberLabel = new QLabel(QString::number(hist->gidsSize()), container);
+  // The row may own the button whose click is being handled.
+  container->hide( );
+  container->deleteLater( );
 
-    QPushButton *hideButton = new QPushButton(container);
-    hideButton->setIcon(QIcon(QPixmap(":icons/show.svg")));
-    hideButton->setCheckable(true);
-    hideButton->setChecked(true);
-    hideButton->setWhatsThis("Click to show/hide the row in main view.");
+  _histograms.erase(_histograms.begin() + row);
+  _histogramKeys.erase(_histogramKeys.begin() + row);
+}
 
-    QPushButton *deleteButton = new QPushButton(container);
-    deleteButton->setIcon(QIcon(QPixmap(":icons/trash.svg")));
+void DisplayManagerWidget::refreshEvents(void)
+{
+  // Rows are matched to the summary rows by id, only the ones that appeared
+  // or disappeared since the last refresh are created or destroyed.
+  for (int row = static_cast<int>(_eventKeys.size()) - 1; row >= 0; --row)
+  {
+    const auto key = _eventKeys[row];
+    const auto sameId = [key](const visimpl::Summary::EventRow &ev) { return ev.id == key; };
+    if (std::none_of(_eventData->begin(), _eventData->end(), sameId))
+      removeEventRow(row);
+  }
 
-    contLayout->addWidget(nameLabel, row, 0, 1, 2);
-    contLayout->addWidget(numberLabel, row, 2, 1, 1);
-    contLayout->addWidget(hideButton, row, 3, 1, 1);
-    contLayout->addWidget(deleteButton, row, 4, 1, 1);
+  unsigned int row = 0;
+  for (const auto &ev : *_eventData)
+  {
+    if (row >= _eventKeys.size() || _eventKeys[row] != ev.id)
+    {
+      _events.insert(_events.begin() + row, createEventRow(ev));
+      _eventKeys.insert(_eventKeys.begin() + row, ev.id);
 
-    if (row == 0) deleteButton->setEnabled(false);
+      _eventsLayout->insertWidget(row, std::get< TDM_E_CONTAINER >( _events[row] ));
+    }
+    else if (_dirtyFlagEvents)
+    {
+      std::get< TDM_E_NAME >( _events[row] )->setText(tr(ev.widget->name().c_str()));
+    }
 
-    _histogramsLayout->addWidget(container);
+    std::get< TDM_E_LINE >( _events[row] )->setVisible(row < _eventData->size() - 1);
+    ++row;
+  }
 
-    if (row < _histData->size() - 1)
-    {
-      QFrame *line = new QFrame(container);
-      line->setFrameShape(QFrame::HLine);
-      line->setFrameShadow(QFrame::Sunken);
+  _dirtyFlagEvents = false;
+}
 
-      _histogramsLayout->addWidget(line);
-    }
+void DisplayManagerWidget::refreshHistograms(void)
+{
+  for (int row = static_cast<int>(_histogramKeys.size()) - 1; row >= 0; --row)
+  {
+    const auto key = _histogramKeys[row];
+    const auto sameId = [key](const visimpl::Summary::HistogramRow &hist) { return hist.id == key; };
+    if (std::none_of(_histData->begin(), _histData->end(), sameId))
+      removeHistogramRow(row);
+  }
 
-    connect(hideButton, SIGNAL(clicked( )),
-            this,       SLOT(hideHistoClicked( )));
+  unsigned int row = 0;
+  for (const auto &hist : *_histData)
+  {
+    if (row >= _histogramKeys.size() || _histogramKeys[row] != hist.id)
+    {
+      _histograms.insert(_histograms.begin() + row, createHistogramRow(hist));
+      _histogramKeys.insert(_histogramKeys.begin() + row, hist.id);
 
-    connect(deleteButton, SIGNAL(clicked( )),
-            this,         SLOT(deleteHistoClicked( )));
+      _histogramsLayout->insertWidget(row, std::get< TDM_H_CONTAINER >( _histograms[row] ));
+    }
+    else if (_dirtyFlagHistograms)
+    {
+      std::get< TDM_H_NAME >( _histograms[row] )->setText(tr(hist.name.c_str()));
+      std::get< TDM_H_NUMBER >( _histograms[row] )->setText(QString::number(hist.size));
+    }
 
-    _histograms.push_back(std::make_tuple(container, nameLabel, numberLabel, hideButton, deleteButton));
+    std::get< TDM_H_DELETE >( _histograms[row] )->setEnabled(row != 0);
+    std::get< TDM_H_LINE >( _histograms[row] )->setVisible(row < _histData->size() - 1);
     ++row;
   }
 
@@ -324,9 +388,9 @@ void DisplayManagerWidget::hideEventClicked()
 
       bool hidden = button->isChecked();
 
-      button->setIcon(QIcon(hidden ? ":icons/show.svg" : ":icons/hide.svg"));
+      button->setIcon(hidden ? showIcon() : hideIcon());
 
-      emit(eventVisibilityChanged(counter, hidden));
+      emit(eventVisibilityChanged(_eventKeys[counter], hidden));
 
       break;
     }
@@ -347,9 +411,7 @@ void DisplayManagerWidget::deleteEventClicked()
 
     if (author->parent() == container)
     {
-
-      emit(removeEvent(counter));
-      _dirtyFlagEvents = true;
+      emit(removeEvent(_eventKeys[counter]));
 
       refreshEvents();
 
@@ -376,9 +438,9 @@ void DisplayManagerWidget::hideHistoClicked()
 
       bool hidden = button->isChecked();
 
-      button->setIcon(QIcon(hidden ? ":icons/show.svg" : ":icons/hide.svg"));
+      button->setIcon(hidden ? showIcon() : hideIcon());
 
-      emit(subsetVisibilityChanged(counter, hidden));
+      emit(subsetVisibilityChanged(_histogramKeys[counter], hidden));
 
       break;
     }
@@ -399,9 +461,7 @@ void DisplayManagerWidget::deleteHistoClicked()
 
     if (author->parent() == container)
     {
-
-      emit(removeHistogram(counter));
-      _dirtyFlagHistograms = true;
+      emit(removeHistogram(_histogramKeys[counter]));
 
       refreshHistograms();
 
@@ -411,6 +471,3 @@ void DisplayManagerWidget::deleteHistoClicked()
     ++counter;
   }
 }
-
-
-
@@ -26,8 +26,9 @@
 // Sumrice
 #include <sumrice/sumrice.h>
 
-class QGridLayout;
+class QVBoxLayout;
 class QWidget;
+class QFrame;
 class QLabel;
 class QPushButton;
 
@@ -40,15 +41,15 @@ namespace stackviz
     TDM_E_NAME,
     TDM_E_SHOW,
     TDM_E_DELETE,
-//    TDM_E_LINE,
+    TDM_E_LINE,
     TDM_E_MAXCOLUMN
   } TDispMngrEventName;
 
   typedef std::tuple< QWidget*,
                       QLabel*,
                       QPushButton*,
-                      QPushButton*
-//                      QFrame*
+                      QPushButton*,
+                      QFrame*
                       > TDisplayEventTuple;
 
   typedef enum
@@ -58,6 +59,7 @@ namespace stackviz
     TDM_H_NUMBER,
     TDM_H_SHOW,
     TDM_H_DELETE,
+    TDM_H_LINE,
     TDM_H_MAXCOLUMN
   } TDispMngrHistoName;
 
@@ -65,7 +67,8 @@ namespace stackviz
                       QLabel*,
                       QLabel*,
                       QPushButton*,
-                      QPushButton*
+                      QPushButton*,
+                      QFrame*
                       > TDisplayHistogramTuple;
 
 
@@ -77,8 +80,8 @@ namespace stackviz
 
     DisplayManagerWidget( );
 
-    void init( const std::vector< visimpl::EventWidget* >* eventData,
-               const std::vector< visimpl::HistogramWidget* >* histData );
+    void init( const std::vector< visimpl::Summary::EventRow >* eventData,
+               const std::vector< visimpl::Summary::HistogramRow >* histData );
 
     void refresh( );
 
@@ -89,6 +92,7 @@ namespace stackviz
 
   signals:
 
+    // Rows are identified by the id of their summary row.
     void eventVisibilityChanged( unsigned int, bool );
     void removeEvent( unsigned int );
 
@@ -113,11 +117,17 @@ namespace stackviz
     void refreshEvents( void );
     void refreshHistograms( void );
 
+    TDisplayEventTuple createEventRow( const visimpl::Summary::EventRow& ev );
+    TDisplayHistogramTuple createHistogramRow( const visimpl::Summary::HistogramRow& hist );
+
+    void removeEventRow( unsigned int row );
+    void removeHistogramRow( unsigned int row );
+
 //    QTableWidget* _eventTable;
 //    QTableWidget* _histoTable;
 
-    const std::vector< visimpl::EventWidget* >* _eventData;
-    const std::vector< visimpl::HistogramWidget* >* _histData;
+    const std::vector< visimpl::Summary::EventRow >* _eventData;
+    const std::vector< visimpl::Summary::HistogramRow >* _histData;
 
 //    std::vector< visimpl::EventWidget* > _availableEvents;
 //    std::vector< visimpl::HistogramWidget* > _availableHistograms;
@@ -125,8 +135,13 @@ namespace stackviz
     std::vector< TDisplayEventTuple > _events;
     std::vector< TDisplayHistogramTuple > _histograms;
 
-    QGridLayout* _eventsLayout;
-    QGridLayout* _histogramsLayout;
+    // Id of the summary row shown by each row. Ids are never reused, so
+    // rows of recreated summary rows do not keep stale names or states.
+    std::vector< unsigned int > _eventKeys;
+    std::vector< unsigned int > _histogramKeys;
+
+    QVBoxLayout* _eventsLayout;
+    QVBoxLayout* _histogramsLayout;
 
     bool _dirtyFlagEvents;
     bool _dirtyFlagHistograms;
@@ -66,6 +66,8 @@ MainWindow::MainWindow( QWidget* parent_ )
 , _summary( nullptr )
 , _player( nullptr )
 , _subsetEventManager( nullptr )
+, _subsetEventLoader( nullptr )
+, _analysisCache( nullptr )
 , _autoCalculateCorrelations( false )
 , _dockSimulation( nullptr )
 , _playButton( nullptr )
@@ -102,6 +104,14 @@ MainWindow::MainWindow( QWidget* parent_ )
   // Connect about dialog
   connect( _ui->actionAbout, SIGNAL( triggered( void )),
            this, SLOT( aboutDialog( void )));
+
+  _subsetEventLoader = new visimpl::SubsetEventLoader( this );
+
+  connect( _subsetEventLoader, SIGNAL( subsetsReady( void )),
+           this, SLOT( _onSubsetsReady( void )));
+
+  connect( _subsetEventLoader, SIGNAL( finished( const QString& )),
+           this, SLOT( _onSubsetEventsLoaded( const QString& )));
 }
 
 void MainWindow::init( const std::string&
@@ -150,6 +160,12 @@ MainWindow::~MainWindow( void )
 {
   delete _ui;
 
+  // Joins the summary's rebuild worker, which may be using the cache.
+  delete _summary;
+  _summary = nullptr;
+
+  delete _analysisCache;
+
 #ifdef VISIMPL_USE_ZEROEQ
 
   if( _zeqConnection )
@@ -208,11 +224,22 @@ void MainWindow::openBlueConfig( const std::string& fileName,
     {
       try
       {
-        auto spikeData = new simil::SpikeData( fileName, simil::TBlueConfig, target );
-        spikeData->reduceDataToGIDS( );
+        simil::SpikeData* spikeData = nullptr;
+        {
+          visimpl::LoadProfiler::Scope scope( "Spike data" );
+          spikeData = visimpl::SpikeCache::load( fileName, simil::TBlueConfig, target );
+        }
+        _datasetKey = visimpl::SpikeCache::cacheFile( fileName, simil::TBlueConfig, target );
+        {
+          visimpl::LoadProfiler::Scope scope( "GID reduction" );
+          spikeData->reduceDataToGIDS( );
+        }
 
         auto player = new simil::SpikesPlayer( );
-        player->LoadData( spikeData );
+        {
+          visimpl::LoadProfiler::Scope scope( "Player" );
+          player->LoadData( spikeData );
+        }
         _player = player;
 
         _subsetEventManager = _player->data( )->subsetsEvents( );
@@ -259,8 +286,18 @@ void MainWindow::openHDF5File( const std::string& networkFile,
 
   try
   {
+    simil::SpikeData* spikeData = nullptr;
+    {
+      visimpl::LoadProfiler::Scope scope( "Spike data" );
+      spikeData = visimpl::SpikeCache::load( networkFile, simil::TDataType::THDF5, activityFile );
+    }
+    _datasetKey = visimpl::SpikeCache::cacheFile( networkFile, simil::TDataType::THDF5, activityFile );
+
     simil::SpikesPlayer *player = new simil::SpikesPlayer();
-    player->LoadData(simil::TDataType::THDF5, networkFile, activityFile);
+    {
+      visimpl::LoadProfiler::Scope scope( "Player" );
+      player->LoadData( spikeData );
+    }
     _player = player;
 
     _subsetEventManager = _player->data()->subsetsEvents();
@@ -290,10 +327,20 @@ void MainWindow::openCSVFile( const std::string& networkFile,
 
   try
   {
+    simil::SpikeData* spikeData = nullptr;
+    {
+      visimpl::LoadProfiler::Scope scope( "Spike data" );
+      spikeData = visimpl::SpikeCache::load( networkFile, simil::TDataType::TCSV, activityFile );
+    }
+    _datasetKey = visimpl::SpikeCache::cacheFile( networkFile, simil::TDataType::TCSV, activityFile );
+
     simil::SpikesPlayer *player = new simil::SpikesPlayer();
     _player = player;
 
-    player->LoadData(simil::TDataType::TCSV, networkFile, activityFile);
+    {
+      visimpl::LoadProfiler::Scope scope( "Player" );
+      player->LoadData( spikeData );
+    }
 
     _subsetEventManager = _player->data()->subsetsEvents();
   }
@@ -314,46 +361,70 @@ void MainWindow::openCSVFile( const std::string& networkFile,
 
 void MainWindow::openSubsetEventFile(const std::string &filePath, bool append)
 {
+  // Subsets still being read belong to a previous file or dataset.
+  _subsetEventLoader->cancel();
+
   if (filePath.empty() || !_subsetEventManager) return;
 
-  QApplication::setOverrideCursor(Qt::WaitCursor);
+  if (!visimpl::SubsetEventLoader::supported(filePath))
+  {
+    const auto errorText = tr("Subset Events file not found: %1").arg(QString::fromStdString(filePath));
+    QMessageBox::critical(this, tr("Error loading Events file"), errorText, QMessageBox::Ok);
+    return;
+  }
 
   if (!append) _subsetEventManager->clear();
 
   _summary->clearEvents();
 
-  QString errorText;
-  try
-  {
-    if (filePath.find("json") != std::string::npos)
-    {
-      _subsetEventManager->loadJSON(filePath);
-    }
-    else
-      if (filePath.find("h5") != std::string::npos)
-      {
-        _subsetEventManager->loadH5(filePath);
-        _autoCalculateCorrelations = true;
-      }
-      else
-      {
-        errorText = tr("Subset Events file not found: %1").arg(QString::fromStdString(filePath));
-      }
-  }
-  catch(const std::exception &e)
-  {
-    if(_subsetEventManager) _subsetEventManager->clear();
+  // Parsed on a worker thread, subsets are added to the summary as they are
+  // converted and the events once the whole file has been read.
+  _subsetEventLoader->load(filePath);
 
-    errorText = QString::fromLocal8Bit(e.what());
-  }
+  showStatusBarMessage(tr("Loading %1...").arg(QString::fromStdString(filePath)));
+}
 
-  QApplication::restoreOverrideCursor();
+void MainWindow::_onSubsetsReady( void )
+{
+  if( !_summary ) return;
+
+  auto subsets = _subsetEventLoader->takeSubsets( );
+  for( auto& subset : subsets )
+    _summary->importSubset( subset.first, std::move( subset.second ));
+}
+
+void MainWindow::_onRebuildProgress( unsigned int done, unsigned int total )
+{
+  if( done < total )
+    _ui->statusbar->showMessage( tr( "Rebuilding histograms %1/%2" )
+                                   .arg( done ).arg( total ));
+  else
+    _ui->statusbar->clearMessage( );
+}
+
+void MainWindow::_onSubsetEventsLoaded( const QString& errorText )
+{
+  _ui->statusbar->clearMessage( );
 
   if(!errorText.isEmpty())
   {
     QMessageBox::critical(this, tr("Error loading Events file"), errorText, QMessageBox::Ok);
     return;
   }
+
+  _onSubsetsReady( );
+
+  _subsetEventLoader->merge( _subsetEventManager );
+
+  const auto suffix = QFileInfo( QString::fromStdString( _subsetEventLoader->filePath( ))).suffix( );
+  if( suffix.toLower( ) == "h5" )
+    _autoCalculateCorrelations = true;
+
+  _summary->clearEvents( );
+  _summary->generateEventsRep( );
+
+  if( _displayManager )
+    _displayManager->refresh( );
 }
 
 void MainWindow::openBlueConfigThroughDialog( void )
@@ -440,12 +511,6 @@ void MainWindow::openSubsetEventsFileThroughDialog( void )
     _lastOpenedSubsetsFileName = QFileInfo( eventsFilename ).path( );
 
     openSubsetEventFile( eventsFilename.toStdString( ), false );
-
-    _summary->generateEventsRep( );
-    _summary->importSubsetsFromSubsetMngr( );
-
-    if( _displayManager )
-      _displayManager->refresh( );
   }
 }
 
@@ -501,8 +566,8 @@ void MainWindow::showDisplayManagerWidget( void )
   if( !_displayManager)
   {
     _displayManager = new DisplayManagerWidget( );
-    _displayManager->init( _summary->eventWidgets(),
-                           _summary->histogramWidgets( ));
+    _displayManager->init( _summary->eventRows( ),
+                           _summary->histogramRows( ));
 
     connect( _displayManager, SIGNAL( eventVisibilityChanged( unsigned int, bool )),
              _summary, SLOT( eventVisibility( unsigned int, bool )));
@@ -605,12 +670,23 @@ void MainWindow::initPlaybackDock( )
 
 void MainWindow::initSummaryWidget( )
 {
+  // The previous summary is destroyed before its cache, so its rebuild
+  // worker is joined while the cache is still alive.
+  delete _summary;
+
   _summary = new visimpl::Summary( this, visimpl::T_STACK_EXPANDABLE );
 
+  delete _analysisCache;
+  _analysisCache = nullptr;
+
+  if( !_datasetKey.empty( ) && visimpl::AnalysisCache::enabled( ))
+    _analysisCache = new visimpl::AnalysisCache( _datasetKey );
+
   if( _simulationType == simil::TSimSpikes )
   {
     auto spikesPlayer = dynamic_cast< simil::SpikesPlayer* >( _player );
 
+    _summary->analysisCache( _analysisCache );
     _summary->Init( spikesPlayer->data( ));
     _summary->simulationPlayer( _player );
   }
@@ -627,6 +703,9 @@ void MainWindow::initSummaryWidget( )
   connect( _summary, SIGNAL( histogramClicked( float )),
            this, SLOT( PlayAt( float )));
 
+  connect( _summary, SIGNAL( rebuildProgress( unsigned int, unsigned int )),
+           this, SLOT( _onRebuildProgress( unsigned int, unsigned int )));
+
 #ifdef VISIMPL_USE_ZEROEQ
   connect( _summary, SIGNAL( histogramClicked( visimpl::HistogramWidget* )),
              this, SLOT( HistogramClicked( visimpl::HistogramWidget* )));
@@ -1004,6 +1083,7 @@ void MainWindow::calculateCorrelations(void)
 
   constexpr double deltaTime = 0.125;
 
+  cc.analysisCache( _analysisCache );
   cc.configureEvents(eventNames, deltaTime);
 
   auto correlateSubsets = [&eventNames, &cc](const std::string &event)
@@ -1111,6 +1191,12 @@ void MainWindow::openH5FilesThroughDialog(void)
 
 void MainWindow::updateUIonOpen(const std::string &eventsFile)
 {
+  if( auto spikesPlayer = dynamic_cast< simil::SpikesPlayer* >( _player ))
+  {
+    visimpl::LoadProfiler::counter( "GIDs", spikesPlayer->gids( ).size( ));
+    visimpl::LoadProfiler::counter( "Spikes", spikesPlayer->data( )->spikes( ).size( ));
+  }
+
   configurePlayer( );
   initSummaryWidget( );
 
@@ -1123,6 +1209,8 @@ void MainWindow::updateUIonOpen(const std::string &eventsFile)
     _displayManager->refresh( );
 
   _ui->actionShowDataManager->setEnabled(true);
+
+  visimpl::LoadProfiler::report( );
 }
 
 #ifdef SIMIL_WITH_REST_API
@@ -1139,6 +1227,9 @@ void stackviz::MainWindow::openRestListener( const std::string& networkFile,
 
   _simulationType = simulationType;
 
+  // Streamed data keeps growing, nothing derived from it is cached.
+  _datasetKey.clear( );
+
   _importer = new simil::LoaderRestData( );
 
   simil::Network* netData = _importer->loadNetwork(url,port);
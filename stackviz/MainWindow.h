@@ -136,6 +136,10 @@ namespace stackviz
 
     void loadComplete( void );
 
+    void _onSubsetsReady( void );
+    void _onSubsetEventsLoaded( const QString& errorText );
+    void _onRebuildProgress( unsigned int done, unsigned int total );
+
 
   protected:
     void configurePlayer( void );
@@ -162,6 +166,12 @@ namespace stackviz
 
     simil::SimulationPlayer* _player;
     simil::SubsetEventManager* _subsetEventManager;
+    visimpl::SubsetEventLoader* _subsetEventLoader;
+
+    // Identifies the opened files for the analysis cache, empty when the
+    // data is not cacheable.
+    std::string _datasetKey;
+    visimpl::AnalysisCache* _analysisCache;
 
     bool _autoCalculateCorrelations;
 
@@ -24,6 +24,7 @@
 #include "MainWindow.h"
 
 #include <QApplication>
+#include <QCoreApplication>
 #include <QDebug>
 #include <QOpenGLWidget>
 #include <QDir>
@@ -39,6 +40,15 @@
 
 void usageMessage(  char* progName );
 void dumpVersion( void );
+int runBatch( const std::string& outputPrefix,
+              simil::TDataType dataType,
+              const std::string& networkFile,
+              const std::string& activityFile,
+              const std::string& target,
+              const std::string& subsetEventFile,
+              const std::string& correlations,
+              unsigned int bins,
+              float deltaTime );
 
 int main( int argc, char** argv )
 {
@@ -54,12 +64,14 @@ int main( int argc, char** argv )
     dir.absolutePath( ) + QString( "/Plugins" ));
 #endif
 
-  QApplication application(argc,argv);
-
   std::string networkFile, activityFile, subsetEventFile;
   std::string zeqUri;
   std::string target;
   std::string correlations;
+  std::string batchPrefix;
+  unsigned int batchBins = 2500;
+  // Same correlation step as the summary widget.
+  float batchDeltaTime = 0.125f;
 
   simil::TDataType dataType = simil::TBlueConfig;
   // @felix This shouldn't be constexpr? Could change to voltages in the future?
@@ -83,6 +95,45 @@ int main( int argc, char** argv )
       return 0;
     }
 
+    if ( std::strcmp( argv[i], "--profile-load" ) == 0 )
+    {
+      visimpl::LoadProfiler::enabled( true );
+      continue;
+    }
+
+    if( std::strcmp( argv[ i ], "--batch" ) == 0 )
+    {
+      if( ++i < argc )
+      {
+        batchPrefix = argv[ i ];
+        continue;
+      }
+      else
+        usageMessage( argv[0] );
+    }
+
+    if( std::strcmp( argv[ i ], "--bins" ) == 0 )
+    {
+      if( ++i < argc && std::atoi( argv[ i ]) > 0 )
+      {
+        batchBins = std::atoi( argv[ i ]);
+        continue;
+      }
+      else
+        usageMessage( argv[0] );
+    }
+
+    if( std::strcmp( argv[ i ], "--delta-time" ) == 0 )
+    {
+      if( ++i < argc && std::atof( argv[ i ]) > 0.0 )
+      {
+        batchDeltaTime = std::atof( argv[ i ]);
+        continue;
+      }
+      else
+        usageMessage( argv[0] );
+    }
+
     if( std::strcmp( argv[ i ], "-zeq" ) == 0 )
     {
 #ifdef VISIMPL_USE_ZEROEQ
@@ -215,6 +266,17 @@ int main( int argc, char** argv )
     }
   }
 
+  // Batch jobs run without a display, the analysis creates no widgets.
+  if( !batchPrefix.empty( ))
+  {
+    QCoreApplication application( argc, argv );
+
+    return runBatch( batchPrefix, dataType, networkFile, activityFile, target,
+                     subsetEventFile, correlations, batchBins, batchDeltaTime );
+  }
+
+  QApplication application(argc,argv);
+
   stackviz::MainWindow mainWindow;
   mainWindow.setWindowTitle("StackViz");
 
@@ -295,6 +357,12 @@ void usageMessage( char* progName )
             << std::endl
             << "\t[ -mw | --maximize-window ]"
             << std::endl
+            << "\t[ --profile-load ]"
+            << std::endl
+            << "\t[ --batch <output_prefix> [ --bins <number> ] "
+            << "[ --delta-time <seconds> ] "
+            << "[ -correlations <subset;subset...> ] ]"
+            << std::endl
             << "\t[ --version ]"
             << std::endl
             << "\t[ --help | -h ]"
@@ -339,3 +407,105 @@ void dumpVersion( void )
   std::cerr << std::endl;
   std::cerr << std::endl;
 }
+
+int runBatch( const std::string& outputPrefix,
+              simil::TDataType dataType,
+              const std::string& networkFile,
+              const std::string& activityFile,
+              const std::string& target,
+              const std::string& subsetEventFile,
+              const std::string& correlations,
+              unsigned int bins,
+              float deltaTime )
+{
+  if( networkFile.empty( ) || dataType == simil::TREST )
+  {
+    std::cerr << "Batch mode requires a BlueConfig, HDF5 or CSV dataset."
+              << std::endl;
+    return -1;
+  }
+
+  simil::SpikeData* spikeData = nullptr;
+
+  try
+  {
+    {
+      visimpl::LoadProfiler::Scope scope( "Spike data" );
+      spikeData = visimpl::SpikeCache::load( networkFile, dataType,
+          dataType == simil::TBlueConfig ? target : activityFile );
+    }
+
+    if( dataType == simil::TBlueConfig )
+    {
+      visimpl::LoadProfiler::Scope scope( "GID reduction" );
+      spikeData->reduceDataToGIDS( );
+    }
+
+    if( !subsetEventFile.empty( ))
+    {
+      if( subsetEventFile.find( "json" ) != std::string::npos )
+        spikeData->subsetsEvents( )->loadJSON( subsetEventFile );
+      else if( subsetEventFile.find( "h5" ) != std::string::npos )
+        spikeData->subsetsEvents( )->loadH5( subsetEventFile );
+      else
+        std::cerr << "Subset Events file not found: " << subsetEventFile
+                  << std::endl;
+    }
+  }
+  catch( const std::exception& e )
+  {
+    std::cerr << "ERROR: " << e.what( ) << " " << __FILE__ << ":" << __LINE__
+              << std::endl;
+
+    if( spikeData )
+      delete spikeData;
+
+    return -1;
+  }
+
+  visimpl::LoadProfiler::counter( "GIDs", spikeData->gids( ).size( ));
+  visimpl::LoadProfiler::counter( "Spikes", spikeData->spikes( ).size( ));
+
+  // Shared with later interactive sessions on the same dataset.
+  visimpl::AnalysisCache* analysisCache = nullptr;
+  if( visimpl::AnalysisCache::enabled( ))
+    analysisCache = new visimpl::AnalysisCache(
+        visimpl::SpikeCache::cacheFile( networkFile, dataType,
+            dataType == simil::TBlueConfig ? target : activityFile ));
+
+  visimpl::BatchAnalysis analysis( spikeData );
+  analysis.analysisCache( analysisCache );
+
+  std::vector< std::string > subsets;
+  if( correlations.empty( ))
+  {
+    subsets = analysis.subsetNames( );
+  }
+  else
+  {
+    for( const auto& subset : QString::fromStdString( correlations ).split( ";" ))
+      subsets.push_back( subset.toStdString( ));
+  }
+
+  {
+    visimpl::LoadProfiler::Scope scope( "Histograms" );
+    analysis.computeHistograms( bins, subsets );
+  }
+
+  {
+    visimpl::LoadProfiler::Scope scope( "Correlations" );
+    analysis.computeCorrelations( subsets, deltaTime,
+                                  spikeData->startTime( ), spikeData->endTime( ));
+  }
+
+  const bool success =
+      analysis.writeHistograms( outputPrefix + "_histograms.csv" ) &&
+      analysis.writeCorrelations( outputPrefix + "_correlations.csv" );
+
+  visimpl::LoadProfiler::report( );
+
+  delete analysisCache;
+  delete spikeData;
+
+  return success ? 0 : -1;
+}
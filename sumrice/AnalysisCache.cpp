@@ -0,0 +1,480 @@
+/*
+ * Copyright (c) 2015-2020 VG-Lab/URJC.
+ *
+ * Authors: Sergio E. Galindo <sergio.galindo@urjc.es>
+ *
+ * This file is part of ViSimpl <https://github.com/vg-lab/visimpl>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+#include "AnalysisCache.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace visimpl
+{
+  static const char ANALYSIS_CACHE_MAGIC[ 8 ] = { 'V', 'S', 'A', 'N', 'A', 'L', 'Y', 'S' };
+
+  // Increase whenever the entries written by AnalysisCache change.
+  static const uint32_t ANALYSIS_CACHE_VERSION = 2;
+
+  // Histogram resolutions kept per entry, the oldest is dropped first.
+  static const size_t ANALYSIS_CACHE_RESOLUTIONS = 4;
+
+  // Default size limit of every dataset's entries together, overridden in
+  // megabytes by VISIMPL_ANALYSIS_CACHE_LIMIT_MB.
+  static const uint64_t ANALYSIS_CACHE_LIMIT_MB = 512;
+
+  namespace
+  {
+    template< typename T >
+    void writeValue( QSaveFile& file, const T& value )
+    {
+      file.write( reinterpret_cast< const char* >( &value ), sizeof( T ));
+    }
+
+    template< typename T >
+    void writeArray( QSaveFile& file, const T* values, uint64_t count )
+    {
+      file.write( reinterpret_cast< const char* >( values ), sizeof( T ) * count );
+    }
+
+    void writeString( QSaveFile& file, const std::string& value )
+    {
+      writeValue( file, static_cast< uint32_t >( value.size( )));
+      file.write( value.data( ), value.size( ));
+    }
+
+    //! Bounds checked reader over an entry read into memory.
+    class BufferReader
+    {
+    public:
+      BufferReader( const QByteArray& data )
+      : _cursor( data.constData( )), _end( data.constData( ) + data.size( ))
+      { }
+
+      template< typename T >
+      bool value( T& value_ )
+      {
+        return array( &value_, 1 );
+      }
+
+      template< typename T >
+      bool array( T* values, uint64_t count )
+      {
+        const uint64_t bytes = sizeof( T ) * count;
+        if( bytes > static_cast< uint64_t >( _end - _cursor ))
+          return false;
+
+        std::memcpy( values, _cursor, bytes );
+        _cursor += bytes;
+        return true;
+      }
+
+      bool string( std::string& value_ )
+      {
+        uint32_t length = 0;
+        if( !value( length ) || length > static_cast< uint64_t >( _end - _cursor ))
+          return false;
+
+        value_.assign( _cursor, length );
+        _cursor += length;
+        return true;
+      }
+
+    protected:
+      const char* _cursor;
+      const char* _end;
+    };
+
+    QByteArray sha1( const QByteArray& data )
+    {
+      return QCryptographicHash::hash( data, QCryptographicHash::Sha1 ).toHex( );
+    }
+
+    //! Hashes the sorted gids, so equal subsets share entries.
+    std::string subsetHash( std::vector< uint32_t > gids )
+    {
+      if( gids.empty( ))
+        return "all";
+
+      std::sort( gids.begin( ), gids.end( ));
+
+      return sha1( QByteArray::fromRawData(
+          reinterpret_cast< const char* >( gids.data( )),
+          gids.size( ) * sizeof( uint32_t ))).toStdString( );
+    }
+
+    bool readEntry( const QString& path, QByteArray& data )
+    {
+      QFile file( path );
+      if( !file.exists( ) || !file.open( QIODevice::ReadOnly ))
+        return false;
+
+      data = file.readAll( );
+
+      // Keeps recently used entries out of the eviction.
+      file.setFileTime( QDateTime::currentDateTime( ),
+                        QFileDevice::FileModificationTime );
+
+      return true;
+    }
+
+    // Entries are opened by the key hash, the full key stored in them guards
+    // against collisions.
+    bool validHeader( BufferReader& reader, const std::string& key )
+    {
+      char magic[ 8 ];
+      uint32_t version = 0;
+      std::string storedKey;
+
+      return reader.array( magic, 8 ) &&
+             std::memcmp( magic, ANALYSIS_CACHE_MAGIC, 8 ) == 0 &&
+             reader.value( version ) && version == ANALYSIS_CACHE_VERSION &&
+             reader.string( storedKey ) && storedKey == key;
+    }
+
+    struct HistogramResolution
+    {
+      std::vector< uint32_t > local;
+      std::vector< uint32_t > global;
+    };
+
+    bool readResolutions( const QString& path, const std::string& key,
+                          std::vector< HistogramResolution >& resolutions )
+    {
+      QByteArray data;
+      if( !readEntry( path, data ))
+        return false;
+
+      BufferReader reader( data );
+      if( !validHeader( reader, key ))
+        return false;
+
+      uint32_t count = 0;
+      if( !reader.value( count ))
+        return false;
+
+      std::vector< HistogramResolution > result;
+      for( uint32_t i = 0; i < count; ++i )
+      {
+        uint32_t bins = 0;
+        if( !reader.value( bins ) || bins == 0 ||
+            bins > static_cast< uint64_t >( data.size( )) / ( 2 * sizeof( uint32_t )))
+          return false;
+
+        HistogramResolution resolution;
+        resolution.local.resize( bins );
+        resolution.global.resize( bins );
+
+        if( !reader.array( resolution.local.data( ), bins ) ||
+            !reader.array( resolution.global.data( ), bins ))
+          return false;
+
+        result.push_back( std::move( resolution ));
+      }
+
+      resolutions = std::move( result );
+      return true;
+    }
+
+    uint64_t cacheLimit( void )
+    {
+      const char* value = std::getenv( "VISIMPL_ANALYSIS_CACHE_LIMIT_MB" );
+      const uint64_t limit = value ? std::strtoull( value, nullptr, 10 ) : 0;
+
+      return ( limit > 0 ? limit : ANALYSIS_CACHE_LIMIT_MB ) << 20;
+    }
+
+    //! Removes the least recently used entries of every dataset until they
+    //! fit the limit.
+    void evict( const QString& root )
+    {
+      QFileInfoList files;
+      QDirIterator entries( root, QStringList( "*.bin" ), QDir::Files,
+                            QDirIterator::Subdirectories );
+      while( entries.hasNext( ))
+      {
+        entries.next( );
+        files.push_back( entries.fileInfo( ));
+      }
+
+      uint64_t total = 0;
+      for( const auto& info : files )
+        total += info.size( );
+
+      const uint64_t limit = cacheLimit( );
+      if( total <= limit )
+        return;
+
+      std::sort( files.begin( ), files.end( ),
+                 []( const QFileInfo& a, const QFileInfo& b )
+                 { return a.lastModified( ) < b.lastModified( ); });
+
+      for( const auto& info : files )
+      {
+        if( total <= limit )
+          break;
+
+        if( QFile::remove( info.absoluteFilePath( )))
+          total -= info.size( );
+      }
+    }
+  }
+
+  AnalysisCache::AnalysisCache( const std::string& datasetKey )
+  : _directory( QStandardPaths::writableLocation( QStandardPaths::CacheLocation ) +
+                "/analysis/" +
+                QString::fromLatin1( sha1( QByteArray::fromStdString( datasetKey ))))
+  {
+    if( enabled( ))
+      evict( QFileInfo( _directory ).path( ));
+  }
+
+  bool AnalysisCache::enabled( void )
+  {
+    return std::getenv( "VISIMPL_DISABLE_ANALYSIS_CACHE" ) == nullptr;
+  }
+
+  std::string AnalysisCache::histogramKey( const GIDUSet& subset,
+                                           float startTime,
+                                           float endTime )
+  {
+    return "histogram|" +
+           subsetHash( std::vector< uint32_t >( subset.begin( ), subset.end( ))) +
+           "|" + std::to_string( startTime ) + "|" + std::to_string( endTime );
+  }
+
+  std::string AnalysisCache::correlationKey( const GIDVec& subset,
+                                             const std::string& eventName,
+                                             const EventVec& event,
+                                             double eventStartTime,
+                                             double eventEndTime,
+                                             float deltaTime,
+                                             float initTime,
+                                             float endTime )
+  {
+    std::string ranges = std::to_string( eventStartTime ) + "-" +
+                         std::to_string( eventEndTime ) + ":";
+    for( const auto& range : event )
+      ranges += std::to_string( range.first ) + "-" +
+                std::to_string( range.second ) + ";";
+
+    return "correlation|" +
+           subsetHash( std::vector< uint32_t >( subset.begin( ), subset.end( ))) +
+           "|" + eventName + "|" + sha1( QByteArray::fromStdString( ranges )).toStdString( ) +
+           "|" + std::to_string( deltaTime ) +
+           "|" + std::to_string( initTime ) + "|" + std::to_string( endTime );
+  }
+
+  QString AnalysisCache::_entryFile( const std::string& key ) const
+  {
+    return _directory + "/" +
+           QString::fromLatin1( sha1( QByteArray::fromStdString( key ))) + ".bin";
+  }
+
+  bool AnalysisCache::readHistogram( const std::string& key,
+                                     std::vector< unsigned int >& histogram,
+                                     std::vector< unsigned int >& globalHistogram ) const
+  {
+    if( !enabled( ) || histogram.empty( ))
+      return false;
+
+    std::vector< HistogramResolution > resolutions;
+    if( !readResolutions( _entryFile( key ), key, resolutions ))
+      return false;
+
+    // The coarsest compatible resolution needs the fewest additions.
+    const HistogramResolution* source = nullptr;
+    for( const auto& resolution : resolutions )
+    {
+      if( resolution.local.size( ) % histogram.size( ) == 0 &&
+          ( !source || resolution.local.size( ) < source->local.size( )))
+        source = &resolution;
+    }
+
+    if( !source )
+      return false;
+
+    const size_t factor = source->local.size( ) / histogram.size( );
+
+    std::fill( histogram.begin( ), histogram.end( ), 0 );
+    globalHistogram.assign( histogram.size( ), 0 );
+    for( size_t i = 0; i < source->local.size( ); ++i )
+    {
+      histogram[ i / factor ] += source->local[ i ];
+      globalHistogram[ i / factor ] += source->global[ i ];
+    }
+
+    return true;
+  }
+
+  bool AnalysisCache::writeHistogram( const std::string& key,
+                                      const std::vector< unsigned int >& histogram,
+                                      const std::vector< unsigned int >& globalHistogram ) const
+  {
+    if( !enabled( ) || histogram.empty( ) ||
+        histogram.size( ) != globalHistogram.size( ))
+      return false;
+
+    const QString path = _entryFile( key );
+
+    // Missing or stale entries are simply replaced.
+    std::vector< HistogramResolution > resolutions;
+    readResolutions( path, key, resolutions );
+
+    const uint32_t bins = histogram.size( );
+    for( const auto& resolution : resolutions )
+    {
+      if( resolution.local.size( ) % bins == 0 )
+        return true;
+    }
+
+    resolutions.erase( std::remove_if( resolutions.begin( ), resolutions.end( ),
+        [ bins ]( const HistogramResolution& resolution )
+        {
+          return bins % resolution.local.size( ) == 0;
+        }), resolutions.end( ));
+
+    while( resolutions.size( ) >= ANALYSIS_CACHE_RESOLUTIONS )
+      resolutions.erase( resolutions.begin( ));
+
+    HistogramResolution added;
+    added.local.assign( histogram.begin( ), histogram.end( ));
+    added.global.assign( globalHistogram.begin( ), globalHistogram.end( ));
+    resolutions.push_back( std::move( added ));
+
+    QDir( ).mkpath( _directory );
+
+    QSaveFile file( path );
+    if( !file.open( QIODevice::WriteOnly ))
+    {
+      std::cerr << "Unable to write analysis cache " << path.toStdString( )
+                << " " << __FILE__ << ":" << __LINE__ << std::endl;
+      return false;
+    }
+
+    file.write( ANALYSIS_CACHE_MAGIC, 8 );
+    writeValue( file, ANALYSIS_CACHE_VERSION );
+    writeString( file, key );
+
+    writeValue( file, static_cast< uint32_t >( resolutions.size( )));
+    for( const auto& resolution : resolutions )
+    {
+      writeValue( file, static_cast< uint32_t >( resolution.local.size( )));
+      writeArray( file, resolution.local.data( ), resolution.local.size( ));
+      writeArray( file, resolution.global.data( ), resolution.global.size( ));
+    }
+
+    return file.commit( );
+  }
+
+  bool AnalysisCache::readCorrelation( const std::string& key,
+                                       ContingencyTable& table ) const
+  {
+    if( !enabled( ))
+      return false;
+
+    QByteArray data;
+    if( !readEntry( _entryFile( key ), data ))
+      return false;
+
+    BufferReader reader( data );
+    if( !validHeader( reader, key ))
+      return false;
+
+    ContingencyTable result;
+    uint64_t neurons = 0;
+
+    bool valid = reader.value( result.totalBins ) &&
+                 reader.value( result.activeBins ) &&
+                 reader.value( neurons );
+
+    result.neurons.reserve(
+        std::min< uint64_t >( neurons, data.size( ) / ( 6 * sizeof( uint32_t ))));
+    for( uint64_t i = 0; valid && i < neurons; ++i )
+    {
+      uint32_t gid = 0;
+      Contingency counts;
+
+      valid = reader.value( gid ) &&
+              reader.value( counts.firedPattern ) &&
+              reader.value( counts.firedNotPattern ) &&
+              reader.value( counts.notFiredPattern ) &&
+              reader.value( counts.notFiredNotPattern ) &&
+              reader.value( counts.totalFiring );
+
+      result.neurons.insert( std::make_pair( gid, counts ));
+    }
+
+    if( !valid )
+      return false;
+
+    table = std::move( result );
+    return true;
+  }
+
+  bool AnalysisCache::writeCorrelation( const std::string& key,
+                                        const ContingencyTable& table ) const
+  {
+    if( !enabled( ))
+      return false;
+
+    const QString path = _entryFile( key );
+    QDir( ).mkpath( _directory );
+
+    QSaveFile file( path );
+    if( !file.open( QIODevice::WriteOnly ))
+    {
+      std::cerr << "Unable to write analysis cache " << path.toStdString( )
+                << " " << __FILE__ << ":" << __LINE__ << std::endl;
+      return false;
+    }
+
+    file.write( ANALYSIS_CACHE_MAGIC, 8 );
+    writeValue( file, ANALYSIS_CACHE_VERSION );
+    writeString( file, key );
+
+    writeValue( file, table.totalBins );
+    writeValue( file, table.activeBins );
+    writeValue( file, static_cast< uint64_t >( table.neurons.size( )));
+
+    for( const auto& neuron : table.neurons )
+    {
+      writeValue( file, neuron.first );
+      writeValue( file, neuron.second.firedPattern );
+      writeValue( file, neuron.second.firedNotPattern );
+      writeValue( file, neuron.second.notFiredPattern );
+      writeValue( file, neuron.second.notFiredNotPattern );
+      writeValue( file, neuron.second.totalFiring );
+    }
+
+    return file.commit( );
+  }
+}
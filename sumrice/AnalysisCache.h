@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2015-2020 VG-Lab/URJC.
+ *
+ * Authors: Sergio E. Galindo <sergio.galindo@urjc.es>
+ *
+ * This file is part of ViSimpl <https://github.com/vg-lab/visimpl>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef __VISIMPL_ANALYSISCACHE__
+#define __VISIMPL_ANALYSISCACHE__
+
+#include "types.h"
+
+#include <simil/simil.h>
+#include <sumrice/api.h>
+
+#include <QString>
+
+#include <string>
+#include <vector>
+
+namespace visimpl
+{
+  /*! \brief Sidecar cache of results derived from a dataset.
+   *
+   * Histogram bin counts and correlation contingency tables are stored in
+   * the user cache directory, one file per result, under a directory keyed
+   * by the dataset. Each entry is keyed by the subset membership and the
+   * analysis parameters, so reopening a dataset only reads back what was
+   * already computed with the same settings.
+   *
+   * Histogram entries are not keyed by their bin count. They keep the few
+   * finest resolutions counted so far, and a read is served from any of
+   * them whose bin count is a multiple of the requested one by summing
+   * consecutive bins, as every requested bin edge is also a stored one.
+   * Other bin counts would split stored bins, so they are counted and
+   * stored alongside instead of approximated.
+   *
+   * The least recently used entries of every dataset are evicted once they
+   * exceed VISIMPL_ANALYSIS_CACHE_LIMIT_MB (512 MB by default). Setting
+   * VISIMPL_DISABLE_ANALYSIS_CACHE in the environment bypasses it.
+   */
+  class SUMRICE_API AnalysisCache
+  {
+  public:
+
+    /*! \param datasetKey identifies the dataset and changes with its
+     * contents, e.g. SpikeCache::cacheFile of its source files.
+     */
+    AnalysisCache( const std::string& datasetKey );
+
+    static bool enabled( void );
+
+    static std::string histogramKey( const GIDUSet& subset,
+                                     float startTime,
+                                     float endTime );
+
+    /*! \param eventStartTime, eventEndTime range over which the event
+     * activity was binned.
+     */
+    static std::string correlationKey( const GIDVec& subset,
+                                       const std::string& eventName,
+                                       const EventVec& event,
+                                       double eventStartTime,
+                                       double eventEndTime,
+                                       float deltaTime,
+                                       float initTime,
+                                       float endTime );
+
+    /*! \brief Fills histogram and globalHistogram, sized by the caller to
+     * the requested bins, from a stored resolution that is a multiple of it.
+     */
+    bool readHistogram( const std::string& key,
+                        std::vector< unsigned int >& histogram,
+                        std::vector< unsigned int >& globalHistogram ) const;
+
+    //! Adds a resolution, dropping the stored ones derivable from it.
+    bool writeHistogram( const std::string& key,
+                         const std::vector< unsigned int >& histogram,
+                         const std::vector< unsigned int >& globalHistogram ) const;
+
+    bool readCorrelation( const std::string& key,
+                          ContingencyTable& table ) const;
+
+    bool writeCorrelation( const std::string& key,
+                           const ContingencyTable& table ) const;
+
+  protected:
+
+    QString _entryFile( const std::string& key ) const;
+
+    QString _directory;
+  };
+}
+
+#endif /* __VISIMPL_ANALYSISCACHE__ */
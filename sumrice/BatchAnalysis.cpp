@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) 2015-2020 VG-Lab/URJC.
+ *
+ * Authors: Sergio E. Galindo <sergio.galindo@urjc.es>
+ *
+ * This file is part of ViSimpl <https://github.com/vg-lab/visimpl>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "BatchAnalysis.h"
+#include "CorrelationComputer.h"
+#include "Histogram.h"
+
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <utility>
+
+namespace visimpl
+{
+  // Focus resolution of the Summary rows, relative to their bins.
+  constexpr float SUMMARY_ZOOM_FACTOR = 1.5f;
+
+  BatchAnalysis::BatchAnalysis( simil::SpikeData* data )
+  : _data( data )
+  , _analysisCache( nullptr )
+  { }
+
+  void BatchAnalysis::analysisCache( AnalysisCache* cache )
+  {
+    _analysisCache = cache;
+  }
+
+  std::vector< std::string > BatchAnalysis::subsetNames( void ) const
+  {
+    std::vector< std::string > names;
+
+    const auto subsets = _data->subsetsEvents( )->subsets( );
+    for( auto subset = subsets.first; subset != subsets.second; ++subset )
+      names.push_back( subset->first );
+
+    return names;
+  }
+
+  std::vector< GIDVec > BatchAnalysis::_resolveSubsets(
+      const std::vector< std::string >& subsets ) const
+  {
+    std::vector< GIDVec > result;
+    result.reserve( subsets.size( ));
+
+    for( const auto& subset : subsets )
+    {
+      result.push_back( _data->subsetsEvents( )->getSubset( subset ));
+
+      if( result.back( ).empty( ))
+        std::cout << "Warning: subset " << subset << " NOT found." << std::endl;
+    }
+
+    return result;
+  }
+
+  void BatchAnalysis::computeHistograms( unsigned int bins,
+                                         const std::vector< std::string >& subsets )
+  {
+    _histogramNames.clear( );
+    _histogramNames.push_back( "All" );
+    _histogramNames.insert( _histogramNames.end( ), subsets.begin( ), subsets.end( ));
+
+    // Subsets are resolved before the parallel section, the manager is not
+    // meant to be shared between threads.
+    const auto subsetGids = _resolveSubsets( subsets );
+
+    // Same sources as the Summary rows, the main row has no filter.
+    std::vector< HistogramWidget::DataSource > sources( _histogramNames.size( ));
+    for( unsigned int i = 0; i < sources.size( ); ++i )
+    {
+      auto& source = sources[ i ];
+
+      if( i == 0 )
+        source.gids = std::make_shared< const GIDUSet >( );
+      else
+        source.gids = std::make_shared< const GIDUSet >(
+            subsetGids[ i - 1 ].begin( ), subsetGids[ i - 1 ].end( ));
+
+      source.spikes = &_data->spikes( );
+      source.startTime = _data->startTime( );
+      source.endTime = _data->endTime( );
+      source.cache = _analysisCache;
+    }
+
+    _histograms.assign( _histogramNames.size( ), std::vector< unsigned int >( ));
+
+#ifdef VISIMPL_USE_OPENMP
+    #pragma omp parallel for schedule( dynamic )
+#endif
+    for( int row = 0; row < static_cast< int >( _histograms.size( )); ++row )
+    {
+      HistogramWidget::Histogram histogram;
+      histogram.resize( bins, 0 );
+      HistogramWidget::_buildHistogram( sources[ row ], histogram );
+
+      if( _analysisCache )
+      {
+        HistogramWidget::Histogram focus;
+        focus.resize( bins * SUMMARY_ZOOM_FACTOR, 0 );
+        HistogramWidget::_buildHistogram( sources[ row ], focus );
+      }
+
+      _histograms[ row ].assign( histogram.begin( ), histogram.end( ));
+    }
+  }
+
+  void BatchAnalysis::computeCorrelations( const std::vector< std::string >& subsets,
+                                           double deltaTime,
+                                           float initTime, float endTime )
+  {
+    CorrelationComputer computer( _data );
+    computer.analysisCache( _analysisCache );
+
+    const auto eventNames = _data->subsetsEvents( )->eventNames( );
+    computer.configureEvents( eventNames, deltaTime );
+
+    // The computer only reads the spikes and the configured events once the
+    // subsets are resolved here.
+    const auto subsetGids = _resolveSubsets( subsets );
+
+    std::vector< std::pair< unsigned int, std::string >> pairs;
+    for( unsigned int i = 0; i < subsets.size( ); ++i )
+      for( const auto& event : eventNames )
+        pairs.emplace_back( i, event );
+
+    _correlations.assign( pairs.size( ), Correlation( ));
+
+#ifdef VISIMPL_USE_OPENMP
+    #pragma omp parallel for schedule( dynamic )
+#endif
+    for( int i = 0; i < static_cast< int >( pairs.size( )); ++i )
+    {
+      const unsigned int subset = pairs[ i ].first;
+      const std::string& event = pairs[ i ].second;
+
+      _correlations[ i ] =
+          computer.computeCorrelation( subsets[ subset ], subsetGids[ subset ],
+                                       event, initTime, endTime, deltaTime );
+      _correlations[ i ].fullName = subsets[ subset ] + event;
+    }
+  }
+
+  bool BatchAnalysis::writeHistograms( const std::string& fileName ) const
+  {
+    std::ofstream file( fileName );
+    if( !file )
+    {
+      std::cerr << "Unable to write " << fileName << " "
+                << __FILE__ << ":" << __LINE__ << std::endl;
+      return false;
+    }
+
+    file << "bin,start_time,end_time";
+    for( const auto& name : _histogramNames )
+      file << "," << name;
+    file << std::endl;
+
+    if( _histograms.empty( ))
+      return true;
+
+    const unsigned int bins = _histograms.front( ).size( );
+    const float startTime = _data->startTime( );
+    const float deltaTime = ( _data->endTime( ) - startTime ) / bins;
+
+    for( unsigned int bin = 0; bin < bins; ++bin )
+    {
+      file << bin << "," << startTime + bin * deltaTime
+           << "," << startTime + ( bin + 1 ) * deltaTime;
+
+      for( const auto& histogram : _histograms )
+        file << "," << histogram[ bin ];
+
+      file << std::endl;
+    }
+
+    return static_cast< bool >( file );
+  }
+
+  bool BatchAnalysis::writeCorrelations( const std::string& fileName ) const
+  {
+    std::ofstream file( fileName );
+    if( !file )
+    {
+      std::cerr << "Unable to write " << fileName << " "
+                << __FILE__ << ":" << __LINE__ << std::endl;
+      return false;
+    }
+
+    file << "subset,event,gid,hit,false_alarm,miss,correct_rejection,"
+         << "entropy,joint_entropy,mutual_information,result" << std::endl;
+
+    for( const auto& correlation : _correlations )
+    {
+      for( const auto& value : correlation.values )
+      {
+        const CorrelationValues& values = value.second;
+
+        file << correlation.subsetName << "," << correlation.eventName << ","
+             << value.first << "," << values.hit << "," << values.falseAlarm
+             << "," << values.miss << "," << values.cr << "," << values.entropy
+             << "," << values.jointEntropy << "," << values.mutualInformation
+             << "," << values.result << std::endl;
+      }
+    }
+
+    return static_cast< bool >( file );
+  }
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2015-2020 VG-Lab/URJC.
+ *
+ * Authors: Sergio E. Galindo <sergio.galindo@urjc.es>
+ *
+ * This file is part of ViSimpl <https://github.com/vg-lab/visimpl>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef __VISIMPL_BATCHANALYSIS__
+#define __VISIMPL_BATCHANALYSIS__
+
+#include "types.h"
+#include "AnalysisCache.h"
+
+#include <simil/simil.h>
+#include <sumrice/api.h>
+
+#include <string>
+#include <vector>
+
+namespace visimpl
+{
+  /*! \brief Window-less summary histograms and correlations of a dataset.
+   *
+   * Computes the same per-bin spike counts as the Summary rows and the same
+   * per-neuron correlation values as CorrelationComputer, without creating
+   * any widget, so they can run in batch jobs. Rows and subset/event pairs
+   * are computed in parallel when built with OpenMP. Results are written as
+   * CSV files and, when a cache is given, stored in it for later sessions.
+   */
+  class SUMRICE_API BatchAnalysis
+  {
+  public:
+
+    BatchAnalysis( simil::SpikeData* data );
+
+    //! Results are read from and stored in the given cache, null disables it.
+    void analysisCache( AnalysisCache* cache );
+
+    //! Names of every subset of the dataset.
+    std::vector< std::string > subsetNames( void ) const;
+
+    /*! \brief Builds a histogram of all neurons followed by one per subset.
+     * The focus resolution of the Summary rows is counted too when caching,
+     * so opening the dataset afterwards finds both.
+     */
+    void computeHistograms( unsigned int bins,
+                            const std::vector< std::string >& subsets );
+
+    /*! \brief Correlates every given subset with every event of the
+     * dataset over [initTime, endTime).
+     */
+    void computeCorrelations( const std::vector< std::string >& subsets,
+                              double deltaTime,
+                              float initTime, float endTime );
+
+    //! One line per bin with its time range and the count of every row.
+    bool writeHistograms( const std::string& fileName ) const;
+
+    //! One line per subset, event and neuron with its correlation values.
+    bool writeCorrelations( const std::string& fileName ) const;
+
+  protected:
+
+    //! Subset members in the given order, warns about missing ones.
+    std::vector< GIDVec > _resolveSubsets(
+        const std::vector< std::string >& subsets ) const;
+
+    simil::SpikeData* _data;
+    AnalysisCache* _analysisCache;
+
+    std::vector< std::string > _histogramNames;
+    std::vector< std::vector< unsigned int >> _histograms;
+
+    std::vector< Correlation > _correlations;
+  };
+}
+
+#endif /* __VISIMPL_BATCHANALYSIS__ */
@@ -27,6 +27,7 @@ namespace visimpl
   CorrelationComputer::CorrelationComputer( simil::SpikeData* simData )
   : _simData( simData )
   , _subsetEvents( simData->subsetsEvents( ))
+  , _analysisCache( nullptr )
   , _startTime{0}
   , _endTime{-1}
   { }
@@ -38,15 +39,22 @@ namespace visimpl
     _endTime   = std::max( _simData->subsetsEvents( )->totalTime( ), _simData->endTime( ));
 
     _eventNames = eventsNames;
+    _events.clear();
     _eventTimeBins.clear();
 
     auto insertBin = [this, &deltaTime](const std::string &name)
     {
+      _events[ name ] = _subsetEvents->getEvent( name );
       _eventTimeBins[ name ] = _eventTimePerBin( name, _startTime, _endTime, deltaTime );
     };
     std::for_each(_eventNames.cbegin(), _eventNames.cend(), insertBin);
   }
 
+  void CorrelationComputer::analysisCache( AnalysisCache* cache )
+  {
+    _analysisCache = cache;
+  }
+
   double CorrelationComputer::_entropy( unsigned int active, unsigned int totalBins ) const
   {
     double result = 0.0;
@@ -70,21 +78,152 @@ namespace visimpl
   {
 
     const GIDVec gids = _subsetEvents->getSubset( subset );
-    Correlation correlation_;
 
     if( gids.empty( ))
     {
       std::cout << "Warning: subset " << subset << " NOT found." << std::endl;
-      return correlation_;
+      return Correlation( );
     }
 
-    auto eventTime = _eventTimeBins.find( eventName );
-    if( eventTime == _eventTimeBins.end( ))
+    if( _eventTimeBins.find( eventName ) == _eventTimeBins.end( ))
     {
       std::cout << "Event " << eventName << " not configured." << std::endl;
+      return Correlation( );
+    }
+
+    return computeCorrelation( subset, gids, eventName,
+                               initTime, endTime, deltaTime );
+  }
+
+  Correlation CorrelationComputer::computeCorrelation( const std::string& subset,
+                                                       const GIDVec& gids,
+                                                       const std::string& eventName,
+                                                       float initTime,
+                                                       float endTime,
+                                                       float deltaTime ) const
+  {
+    Correlation correlation_;
+
+    auto eventTime = _eventTimeBins.find( eventName );
+    if( gids.empty( ) || eventTime == _eventTimeBins.end( ))
       return correlation_;
+
+    const TGIDUSet giduset( gids.begin( ), gids.end( ));
+
+    // Bin counts only depend on the subset, the event and the analysis range,
+    // reuse them from previous runs when available.
+    std::string cacheKey;
+    if( _analysisCache )
+      cacheKey = AnalysisCache::correlationKey( gids, eventName,
+                                                _events.at( eventName ),
+                                                _startTime, _endTime,
+                                                deltaTime, initTime, endTime );
+
+    ContingencyTable table;
+    if( !_analysisCache || !_analysisCache->readCorrelation( cacheKey, table ))
+    {
+      table = _contingencyTable( gids, eventTime->second,
+                                 initTime, endTime, deltaTime );
+
+      if( _analysisCache )
+        _analysisCache->writeCorrelation( cacheKey, table );
     }
 
+    const unsigned int analysisTotalBins = table.totalBins;
+    const double entropyPattern = _entropy( table.activeBins, analysisTotalBins );
+
+    correlation_.subsetName = subset;
+    correlation_.eventName = eventName;
+    correlation_.gids = giduset;
+
+    // Calculate normalization factors by the inverse of active/inactive bins.
+    const double normBins = 1.0 / analysisTotalBins;
+
+    // Initialize maximum value probes.
+    double maxHitValue = 0.0;
+    double maxFHValue = 0.0;
+    double maxResValue = 0.0;
+
+    double avgHitValue = 0.0;
+    double avgFHValue = 0.0;
+    double avgResValue = 0.0;
+
+    auto computeCorrelation = [&](const uint32_t id)
+    {
+      const auto neuronStats = table.neurons.find(id);
+      if(neuronStats == table.neurons.end()) return;
+
+      const unsigned int binsFiringPattern = neuronStats->second.firedPattern;
+      const unsigned int binsFiringNotPattern = neuronStats->second.firedNotPattern;
+      const unsigned int binsNotFiringPattern = neuronStats->second.notFiredPattern;
+      const unsigned int binsNotFiringNotPattern = neuronStats->second.notFiredNotPattern;
+
+      const unsigned int binsTotalFiring = neuronStats->second.totalFiring;
+
+      // Calculate corresponding values according to current event activity.
+      CorrelationValues values;
+
+      // Hit value relates to spiking neurons during active event.
+      values.hit  = std::max( 0.0, std::min( 1.0, binsFiringPattern * normBins ));
+      values.cr   = std::max( 0.0, std::min( 1.0, binsNotFiringNotPattern * normBins ));
+      values.miss = std::max( 0.0, std::min( 1.0, binsNotFiringPattern * normBins ));
+      // False hit is related to spiking neurons when event is not active.
+      values.falseAlarm = std::max( 0.0, std::min( 1.0, binsFiringNotPattern * normBins ));
+
+      values.entropy = _entropy( binsTotalFiring, analysisTotalBins );
+
+      values.jointEntropy = 0.0;
+      if( values.hit > 0 )
+        values.jointEntropy -= ( values.hit * std::log2( values.hit ));
+
+      if( values.cr > 0 )
+        values.jointEntropy -= ( values.cr * std::log2( values.cr ));
+
+      if( values.miss > 0 )
+        values.jointEntropy -= ( values.miss * std::log2( values.miss ));
+
+      if( values.falseAlarm > 0 )
+        values.jointEntropy -= ( values.falseAlarm * std::log2( values.falseAlarm ));
+
+      values.mutualInformation =
+          entropyPattern + values.entropy - values.jointEntropy;
+
+      // Result responds to Hit minus False Hit.
+      values.result = values.mutualInformation;
+
+      // Store maximum values.
+      if( values.hit > maxHitValue )
+        maxHitValue = values.hit;
+
+      if( values.falseAlarm > maxFHValue )
+        maxFHValue = values.falseAlarm;
+
+      if( values.result > maxResValue )
+        maxResValue = values.result;
+
+      avgHitValue += values.hit;
+      avgFHValue += values.falseAlarm;
+      avgResValue += values.result;
+
+        // Store neuron correlation value.
+      correlation_.values.insert( std::make_pair( id, values ));
+    };
+    std::for_each(gids.cbegin(), gids.cend(), computeCorrelation);
+
+    avgHitValue /= table.neurons.size( );
+    avgFHValue /= table.neurons.size( );
+    avgResValue /= table.neurons.size( );
+
+    return correlation_;
+  }
+
+  ContingencyTable
+  CorrelationComputer::_contingencyTable( const GIDVec& gids,
+                                          const std::vector< float >& eventTime,
+                                          float initTime,
+                                          float endTime,
+                                          float deltaTime ) const
+  {
     const TGIDUSet giduset( gids.begin( ), gids.end( ));
 
     const TSpikes& spikes = _simData->spikes( );
@@ -114,7 +253,7 @@ namespace visimpl
     double currentTime = 0.0;
     for( unsigned int i = 0; i < totalBins; ++i, currentTime += deltaTime )
     {
-      const auto time = eventTime->second[ i ];
+      const auto time = eventTime[ i ];
       const bool value = ( time >= threshold );
 
       if( value )
@@ -128,8 +267,6 @@ namespace visimpl
 
     }
 
-    const double entropyPattern = _entropy( analysisActiveBins, analysisTotalBins );
-
     std::vector< std::set< uint32_t >> binSpikes( totalBins );
     std::unordered_map< uint32_t, std::unordered_set< unsigned int >> neuronActiveBins;
 
@@ -216,89 +353,21 @@ namespace visimpl
     };
     std::for_each(gids.cbegin(), gids.cend(), computeStatistics);
 
-    correlation_.subsetName = subset;
-    correlation_.eventName = eventName;
-    correlation_.gids = giduset;
+    ContingencyTable table;
+    table.totalBins = analysisTotalBins;
+    table.activeBins = analysisActiveBins;
 
-    // Calculate normalization factors by the inverse of active/inactive bins.
-    const double normBins = 1.0 / analysisTotalBins;
-
-    // Initialize maximum value probes.
-    double maxHitValue = 0.0;
-    double maxFHValue = 0.0;
-    double maxResValue = 0.0;
-
-    double avgHitValue = 0.0;
-    double avgFHValue = 0.0;
-    double avgResValue = 0.0;
-
-    auto computeCorrelation = [&](const uint32_t id)
+    for( const auto& neuron : neuronSpikes )
     {
-      const auto neuronStats = neuronSpikes.find(id);
-      if(neuronStats == neuronSpikes.end()) return;
-
-      const unsigned int binsFiringPattern = std::get< tPatternFiring >( neuronStats->second );
-      const unsigned int binsFiringNotPattern = std::get< tNotPatternFiring >( neuronStats->second );
-      const unsigned int binsNotFiringPattern = std::get< tPatternNotFiring >( neuronStats->second );
-      const unsigned int binsNotFiringNotPattern = std::get< tNotPatternNotFiring >( neuronStats->second );
-
-      const unsigned int binsTotalFiring = std::get< tTotalFiring >( neuronStats->second );
-
-      // Calculate corresponding values according to current event activity.
-      CorrelationValues values;
-
-      // Hit value relates to spiking neurons during active event.
-      values.hit  = std::max( 0.0, std::min( 1.0, binsFiringPattern * normBins ));
-      values.cr   = std::max( 0.0, std::min( 1.0, binsNotFiringNotPattern * normBins ));
-      values.miss = std::max( 0.0, std::min( 1.0, binsNotFiringPattern * normBins ));
-      // False hit is related to spiking neurons when event is not active.
-      values.falseAlarm = std::max( 0.0, std::min( 1.0, binsFiringNotPattern * normBins ));
-
-      values.entropy = _entropy( binsTotalFiring, analysisTotalBins );
-
-      values.jointEntropy = 0.0;
-      if( values.hit > 0 )
-        values.jointEntropy -= ( values.hit * std::log2( values.hit ));
-
-      if( values.cr > 0 )
-        values.jointEntropy -= ( values.cr * std::log2( values.cr ));
-
-      if( values.miss > 0 )
-        values.jointEntropy -= ( values.miss * std::log2( values.miss ));
-
-      if( values.falseAlarm > 0 )
-        values.jointEntropy -= ( values.falseAlarm * std::log2( values.falseAlarm ));
-
-      values.mutualInformation =
-          entropyPattern + values.entropy - values.jointEntropy;
-
-      // Result responds to Hit minus False Hit.
-      values.result = values.mutualInformation;
-
-      // Store maximum values.
-      if( values.hit > maxHitValue )
-        maxHitValue = values.hit;
-
-      if( values.falseAlarm > maxFHValue )
-        maxFHValue = values.falseAlarm;
-
-      if( values.result > maxResValue )
-        maxResValue = values.result;
-
-      avgHitValue += values.hit;
-      avgFHValue += values.falseAlarm;
-      avgResValue += values.result;
-
-        // Store neuron correlation value.
-      correlation_.values.insert( std::make_pair( id, values ));
-    };
-    std::for_each(gids.cbegin(), gids.cend(), computeCorrelation);
-
-    avgHitValue /= neuronSpikes.size( );
-    avgFHValue /= neuronSpikes.size( );
-    avgResValue /= neuronSpikes.size( );
+      Contingency& counts = table.neurons[ neuron.first ];
+      counts.firedPattern = std::get< tPatternFiring >( neuron.second );
+      counts.firedNotPattern = std::get< tNotPatternFiring >( neuron.second );
+      counts.notFiredPattern = std::get< tPatternNotFiring >( neuron.second );
+      counts.notFiredNotPattern = std::get< tNotPatternNotFiring >( neuron.second );
+      counts.totalFiring = std::get< tTotalFiring >( neuron.second );
+    }
 
-    return correlation_;
+    return table;
   }
 
   std::vector< Correlation >
@@ -24,6 +24,7 @@
 #define __SIMIL_CORRELATIONCOMPUTER__
 
 #include "types.h"
+#include "AnalysisCache.h"
 
 #include <unordered_map>
 #include <simil/simil.h>
@@ -40,6 +41,9 @@ namespace visimpl
     void configureEvents( const std::vector< std::string >& events,
                           double deltaTime );
 
+    //! Optional cache of contingency tables, not owned.
+    void analysisCache( AnalysisCache* cache );
+
     std::vector< Correlation >
     correlateSubset( const std::string& subset,
                const std::vector< std::string >& events,
@@ -55,6 +59,18 @@ namespace visimpl
                   float deltaTime = 0.125f,
                   float selectionThreshold = 0.0f);
 
+    /*! \brief Correlates an already resolved subset with a configured event.
+     * Only reads the spikes, the configured events and the cache, so it can
+     * run from several threads at once. Prints nothing, unknown events give
+     * an empty correlation.
+     */
+    Correlation computeCorrelation( const std::string& subset,
+                                    const GIDVec& gids,
+                                    const std::string& event,
+                                    float initTime,
+                                    float endTime,
+                                    float deltaTime ) const;
+
     std::vector< std::string > correlationNames( void ) const;
 
     const Correlation* correlation( const std::string& subsetName ) const;
@@ -68,6 +84,12 @@ namespace visimpl
                                     float endTime,
                                     float deltaTime);
 
+    ContingencyTable _contingencyTable( const GIDVec& gids,
+                                        const std::vector< float >& eventTime,
+                                        float initTime,
+                                        float endTime,
+                                        float deltaTime ) const;
+
     double _entropy( unsigned int active, unsigned int totalBins ) const;
 
     std::string _composeName( const std::string& subsetName, const std::string& eventName ) const;
@@ -76,9 +98,12 @@ namespace visimpl
 
     simil::SubsetEventManager* _subsetEvents;
 
+    AnalysisCache* _analysisCache;
+
     double _startTime;
     double _endTime;
     std::vector< std::string > _eventNames;
+    std::unordered_map< std::string, EventVec > _events;
     std::unordered_map< std::string, std::vector< float >> _eventTimeBins;
 
     std::map< std::string, Correlation > _correlations;
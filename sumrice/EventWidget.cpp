@@ -32,7 +32,6 @@ namespace visimpl
   : QFrame( nullptr )
   , _events( nullptr )
   , _index( 0 )
-  , _heightPerRow( 50 )
   , _columns( 20 )
   , _centralColumns( _columns - 2)
   , _margin( 20 )
@@ -40,101 +39,6 @@ namespace visimpl
 
   }
 
-  void EventWidget::resizeEvent( QResizeEvent* /*event*/ )
-  {
-    unsigned int w = width( );
-    unsigned int h = height( );
-
-    unsigned int up = _margin;
-    unsigned int down = h - _margin;
-
-    unsigned int counter = 0;
-    for( auto& e : *_events )
-    {
-      if( counter != _index )
-      {
-        counter++;
-        continue;
-      }
-      unsigned int left;
-      unsigned int right;
-
-      e._cachedCustomSolidRep.clear( );
-      e._cachedCustomTransRep.clear( );
-      e._cachedCommonRep.clear( );
-
-      e._cachedCustomSolidRep.reserve( e.percentages.size( ));
-      e._cachedCustomTransRep.reserve( e.percentages.size( ));
-      e._cachedCommonRep.reserve( e.percentages.size( ));
-
-      for( const auto& timeFrameChunk : e.percentages )
-      {
-        left = timeFrameChunk.first * w;
-        right = timeFrameChunk.second * w;
-
-        // Create cached custom representation for events.
-        QPainterPath customSolid;
-        customSolid.moveTo( left, up );
-        customSolid.lineTo( left, down );
-        customSolid.lineTo( right, down );
-        customSolid.lineTo( right, up );
-        customSolid.closeSubpath( );
-
-        e._cachedCustomSolidRep.push_back( customSolid );
-
-        QPainterPath customTransparent;
-        customTransparent.moveTo( left, down );
-        customTransparent.lineTo( left, h );
-        customTransparent.lineTo( right, h );
-        customTransparent.lineTo( right, down );
-        customTransparent.closeSubpath( );
-
-        e._cachedCustomTransRep.push_back( customTransparent );
-
-        // Create cached common representation for histograms.
-        QPainterPath common;
-        common.moveTo( left, 0 );
-        common.lineTo( left, _heightPerRow);
-        common.lineTo( right, _heightPerRow );
-        common.lineTo( right, 0 );
-        common.closeSubpath( );
-
-        e._cachedCommonRep.push_back( common );
-      }
-
-      break;
-    }
-  }
-
-  void EventWidget::updateCommonRepSizeVert( unsigned int newHeight )
-  {
-    _heightPerRow = newHeight;
-
-    unsigned int w = width( );
-
-    unsigned int left;
-    unsigned int right;
-    for( auto& e : *_events )
-    {
-      e._cachedCommonRep.clear( );
-      for( const auto& timeFrameChunk : e.percentages )
-      {
-        left = timeFrameChunk.first * w;
-        right = timeFrameChunk.second * w;
-
-        // Create cached common representation for histograms.
-        QPainterPath common;
-        common.moveTo( left, 0 );
-        common.lineTo( left, _heightPerRow);
-        common.lineTo( right, _heightPerRow );
-        common.lineTo( right, 0 );
-        common.closeSubpath( );
-
-        e._cachedCommonRep.push_back( common );
-      }
-    }
-  }
-
   void EventWidget::paintEvent( QPaintEvent* /*event_*/ )
   {
     QPainter painter( this );
@@ -143,6 +47,10 @@ namespace visimpl
     painter.fillRect( rect( ), QBrush( QColor( 255, 255, 255, 255 ),
                                        Qt::SolidPattern ));
 
+    const int h = height( );
+    const int up = _margin;
+    const int down = h - _margin;
+
     unsigned int counter = 0;
     for( auto& e : *_events )
     {
@@ -154,28 +62,25 @@ namespace visimpl
 
       QColor color = e.color;
 
+      const auto& spans = e.spans( width( ));
+
       if( counter == _index )
       {
         color.setAlpha( 255 );
-        painter.setBrush( QBrush( color, Qt::SolidPattern ));
-
-        for( const auto& p : e._cachedCustomSolidRep )
-          painter.drawPath( p );
+        for( const auto& span : spans )
+          painter.fillRect( span.first, up, span.second - span.first,
+                            down - up, color );
 
         color.setAlpha( 50 );
-        painter.setBrush( QBrush( color, Qt::SolidPattern ));
-
-        for( const auto& p : e._cachedCustomTransRep )
-          painter.drawPath( p );
+        for( const auto& span : spans )
+          painter.fillRect( span.first, down, span.second - span.first,
+                            h - down, color );
       }
       else
       {
         color.setAlpha( 50 );
-        painter.setBrush( QBrush( color, Qt::SolidPattern ));
-
-        for( const auto& p : e._cachedCommonRep )
-          painter.drawPath( p );
-
+        for( const auto& span : spans )
+          painter.fillRect( span.first, 0, span.second - span.first, h, color );
       }
 
       ++counter;
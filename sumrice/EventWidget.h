@@ -48,17 +48,13 @@ namespace visimpl
     void name( const std::string& name_ );
     const std::string& name( void ) const;
 
-    void updateCommonRepSizeVert( unsigned int newHeight );
-
   protected:
 
-    virtual void resizeEvent( QResizeEvent* event );
     virtual void paintEvent( QPaintEvent* event );
 
     std::vector< TEvent >* _events;
 
     unsigned int _index;
-    unsigned int _heightPerRow;
     unsigned int _columns;
     unsigned int _centralColumns;
     unsigned int _margin;
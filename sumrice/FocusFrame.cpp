@@ -24,16 +24,11 @@
 
 #include <QPainter>
 
+#include <algorithm>
+
 FocusFrame::FocusFrame( QWidget* parent_ )
 : QFrame( parent_ )
-, _visibleStart( 0.0f )
-, _width( 0.0f )
-, _offset( 0.0f )
-, _currentPosition( 0 )
-, _firstPointLocal( 0 )
-, _lastPointLocal( 0 )
-, _firstPointGlobal( 0 )
-, _lastPointGlobal( 0 )
+, _markerPosition( 0.0f )
 , _colorLocal( "#e31a1c" )
 , _colorGlobal( "#1f78b4" )
 , _fillPlots( true )
@@ -43,39 +38,30 @@ void FocusFrame::viewRegion( const visimpl::HistogramWidget& histogram,
                              float marker,// float offset,
                              float regionWidth )
 {
-  unsigned int maxSize = histogram.focusHistogramSize( );
-  
-  unsigned int position = maxSize * marker;
-  unsigned int regionW =  maxSize * regionWidth;
-
-  int start = position - regionW - 1;
-  unsigned int end = position + regionW;
-  if( start < 0 )
+  float start = marker - regionWidth;
+  float end = marker + regionWidth;
+  if( start < 0.0f )
   {
-    start = 0;
-    end = 2 * regionW;
+    start = 0.0f;
+    end = 2 * regionWidth;
   }
-  else if( end > maxSize )
+  else if( end > 1.0f )
   {
-    end = maxSize;
-    start = end - ( 2 * regionW );
+    end = 1.0f;
+    start = end - ( 2 * regionWidth );
   }
 
-  _currentPosition = position;
-
-  _curveLocal = histogram.focusLocalFunction( );
-  _curveGlobal = histogram.focusGlobalFunction( );
-
-  _firstPointLocal = start;
-  _firstPointGlobal = start;
+  _markerPosition = ( marker - start ) / ( end - start );
 
-  _lastPointLocal = end;
-  _lastPointGlobal = end;
+  // Only the visible window is sampled, one point per pixel column.
+  const unsigned int samples = std::max( 2, width( ));
+  histogram.focusWindow( start, end, samples, _curveLocal, _curveGlobal );
 }
 
 void FocusFrame::clear( void )
 {
-  _firstPointGlobal = _lastPointGlobal = 0;
+  _curveLocal.clear( );
+  _curveGlobal.clear( );
 }
 
 void FocusFrame::paintEvent( QPaintEvent* /*event_*/ )
@@ -87,46 +73,20 @@ void FocusFrame::paintEvent( QPaintEvent* /*event_*/ )
   painter.fillRect( rect( ), QBrush( QColor( 255, 255, 255, 255 ),
                                      Qt::SolidPattern ));
 
-  if( _lastPointGlobal == _firstPointGlobal )
+  if( _curveGlobal.empty( ))
     return;
 
   QPainterPath pathLocal;
   QPainterPath pathGlobal;
 
-  QPolygonF::iterator current;
-
-//  int offset = _offset * width( );
-  float delta = width( ) / float( _lastPointLocal - _firstPointLocal - 1);
-
-  unsigned int counter = 0;
   pathGlobal.moveTo( 0, height( ));
-  for( current  = _curveGlobal.begin( ) + _firstPointGlobal;
-       current != _curveGlobal.begin( ) + _lastPointGlobal;
-       current++ )
-  {
-    int coordX = counter * delta;
-//        ( current - ( _curveGlobal.begin( ) + _firstPointGlobal) )
-    //* delta; //(*current).x( ) * width( );
-    int coordY = (*current).y( ) * height( );
-
-    pathGlobal.lineTo( coordX, coordY );
-    counter++;
-  }
+  for( const auto& point : _curveGlobal )
+    pathGlobal.lineTo( point.x( ) * width( ), point.y( ) * height( ));
   pathGlobal.lineTo( width( ), height( ));
 
-  counter = 0;
   pathLocal.moveTo( 0, height( ));
-  for( current  = _curveLocal.begin( ) + _firstPointLocal;
-       current != _curveLocal.begin( ) + _lastPointLocal;
-       current++ )
-  {
-    int coordX = counter * delta;
-//        ( current - ( _curveLocal.begin( ) + _firstPointLocal) )
-           // * delta; //(*current).x( ) * width( );
-    int coordY = (*current).y( ) * height( );
-    pathLocal.lineTo( coordX, coordY );
-    counter++;
-  }
+  for( const auto& point : _curveLocal )
+    pathLocal.lineTo( point.x( ) * width( ), point.y( ) * height( ));
   pathLocal.lineTo( width( ), height( ));
 
   QColor globalColor( _colorGlobal );
@@ -159,10 +119,7 @@ void FocusFrame::paintEvent( QPaintEvent* /*event_*/ )
 
   }
 
-  float markerPos = ( _currentPosition - _firstPointLocal ) /
-                  float( _lastPointLocal - _firstPointLocal - 1 );
-
-  int positionX = markerPos * width( );
+  int positionX = _markerPosition * width( );
 
   QLine marker( QPoint( positionX, 0 ), QPoint( positionX, height( )));
   painter.setPen( QColor( 177, 50, 50 ));
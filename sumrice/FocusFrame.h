@@ -52,18 +52,11 @@ public:
 
 protected:
 
+  // Visible window only, sampled at the frame width.
   QPolygonF _curveLocal;
   QPolygonF _curveGlobal;
-  float _visibleStart;
-  float _width;
-  float _offset;
 
-  unsigned int _currentPosition;
-  unsigned int _firstPointLocal;
-  unsigned int _lastPointLocal;
-
-  unsigned int _firstPointGlobal;
-  unsigned int _lastPointGlobal;
+  float _markerPosition;
 
   QColor _colorLocal;
   QColor _colorGlobal;
@@ -34,6 +34,8 @@
 #endif
 
 #include <exception>
+#include <algorithm>
+#include <cmath>
 
 namespace visimpl
 {
@@ -45,6 +47,8 @@ namespace visimpl
   , _startTime( 0.0f )
   , _endTime( 0.0f )
   , _player( nullptr )
+  , _spikeStream( nullptr )
+  , _analysisCache( nullptr )
   , _scaleFuncLocal( nullptr )
   , _scaleFuncGlobal( nullptr )
   , _colorScaleLocal( T_COLOR_LINEAR )
@@ -56,6 +60,7 @@ namespace visimpl
   , _normRule( T_NORM_MAX )
   , _repMode( T_REP_DENSE )
   , _fillPlots( true )
+  , _filteredGIDs( std::make_shared< const GIDUSet >( ))
   , _lastMousePosition( nullptr )
   , _regionPercentage( nullptr )
   , _paintRegion( false )
@@ -67,6 +72,11 @@ namespace visimpl
   , _events( nullptr )
   , _autoBuildHistogram( true )
   , _autoCalculateColors( true )
+  , _lazy( false )
+  , _dataPending( false )
+  , _building( false )
+  , _backgroundDirty( true )
+  , _eventsStamp( 0 )
   {
   }
 
@@ -80,6 +90,8 @@ namespace visimpl
   , _startTime( startTime )
   , _endTime( endTime )
   , _player( nullptr )
+  , _spikeStream( nullptr )
+  , _analysisCache( nullptr )
   , _scaleFuncLocal( nullptr )
   , _scaleFuncGlobal( nullptr )
   , _colorScaleLocal( T_COLOR_LINEAR )
@@ -91,6 +103,7 @@ namespace visimpl
   , _normRule( T_NORM_MAX )
   , _repMode( T_REP_DENSE )
   , _fillPlots( true )
+  , _filteredGIDs( std::make_shared< const GIDUSet >( ))
   , _lastMousePosition( nullptr )
   , _regionPercentage( nullptr )
   , _paintRegion( false )
@@ -102,6 +115,11 @@ namespace visimpl
   , _events( nullptr )
   , _autoBuildHistogram( true )
   , _autoCalculateColors( true )
+  , _lazy( false )
+  , _dataPending( false )
+  , _building( false )
+  , _backgroundDirty( true )
+  , _eventsStamp( 0 )
   {
   }
 
@@ -113,6 +131,8 @@ namespace visimpl
   , _startTime( spikeReport.startTime( ))
   , _endTime( spikeReport.endTime( ))
   , _player( nullptr )
+  , _spikeStream( nullptr )
+  , _analysisCache( nullptr )
   , _scaleFuncLocal( nullptr )
   , _scaleFuncGlobal( nullptr )
   , _colorScaleLocal( T_COLOR_LINEAR )
@@ -124,6 +144,7 @@ namespace visimpl
   , _normRule( T_NORM_MAX )
   , _repMode( T_REP_DENSE )
   , _fillPlots( true )
+  , _filteredGIDs( std::make_shared< const GIDUSet >( ))
   , _lastMousePosition( nullptr )
   , _regionPercentage( nullptr )
   , _paintRegion( false )
@@ -135,6 +156,11 @@ namespace visimpl
   , _events( nullptr )
   , _autoBuildHistogram( true )
   , _autoCalculateColors( true )
+  , _lazy( false )
+  , _dataPending( false )
+  , _building( false )
+  , _backgroundDirty( true )
+  , _eventsStamp( 0 )
   {
   }
 
@@ -159,6 +185,11 @@ namespace visimpl
     _zoomFactor = zoomFactor_;
     bins( binsNumber );
 
+    // bins() returns early when the count matches the default, lazy rows
+    // would otherwise never be built.
+    if( _lazy && _mainHistogram.empty( ))
+      _dataPending = true;
+
     colorScaleLocal( _colorScaleLocal );
     colorScaleGlobal( _colorScaleGlobal );
 
@@ -176,73 +207,171 @@ namespace visimpl
   {
     _startTime = _player->startTime( );
     _endTime = _player->endTime( );
+
+    if( _lazy )
+    {
+      _dataPending = true;
+      return;
+    }
+
     BuildHistogram( histogramNumber );
     CalculateColors( histogramNumber );
   }
 
   void HistogramWidget::BuildHistogram( THistogram histogramNumber )
   {
-    Histogram* histogram = &_mainHistogram;
+    _buildHistogram( histogramNumber == T_HIST_FOCUS ? _focusHistogram :
+                                                       _mainHistogram );
+  }
 
-    if( histogramNumber == T_HIST_FOCUS )
-      histogram = &_focusHistogram;
+  HistogramWidget::DataSource HistogramWidget::dataSource( void ) const
+  {
+    DataSource source;
+    source.gids = _filteredGIDs;
+    source.spikes = _spikes;
+    source.startTime = _startTime;
+    source.endTime = _endTime;
+    source.stream = _spikeStream;
+    source.cache = _analysisCache;
 
-    std::vector< unsigned int > globalHistogram( histogram->size( ), 0 );
+    return source;
+  }
 
-    float totalTime = _endTime - _startTime ;
+  HistogramWidget::ColorConfig HistogramWidget::colorConfig( void ) const
+  {
+    ColorConfig config;
+    config.repMode = _repMode;
+    config.normRule = _normRule;
+    config.colorScaleLocal = _colorScaleLocal;
+    config.colorScaleGlobal = _colorScaleGlobal;
+    config.scaleFuncLocal = _scaleFuncLocal;
+    config.scaleFuncGlobal = _scaleFuncGlobal;
+    config.colorMapper = _colorMapper;
 
-    bool filter = _filteredGIDs.size( ) > 0;
+    return config;
+  }
 
-#ifndef VISIMPL_USE_OPENMP
+  void HistogramWidget::_buildHistogram( Histogram& histogram )
+  {
+    _buildHistogram( dataSource( ), histogram );
+  }
+
+  void HistogramWidget::_buildHistogram( const DataSource& source,
+                                         Histogram& histogram )
+  {
+    std::vector< unsigned int > globalHistogram( histogram.size( ), 0 );
+
+    // Counts are rebuilt from scratch, they are not accumulated.
+    std::fill( histogram.begin( ), histogram.end( ), 0 );
+    histogram._maxValueHistogramLocal = 0;
+    histogram._maxValueHistogramGlobal = 0;
+
+    bool filter = source.gids->size( ) > 0;
+
+    // The same subset and time range were counted before at a compatible
+    // resolution, read them back instead of walking the spikes again.
+    std::string cacheKey;
+    if( source.cache )
+      cacheKey = AnalysisCache::histogramKey( *source.gids,
+                                              source.startTime, source.endTime );
 
-    const float deltaTime = ( totalTime ) / histogram->size( );
-    float currentTime = _startTime + deltaTime;
+    if( !source.cache ||
+        !source.cache->readHistogram( cacheKey, histogram, globalHistogram ))
+    {
+      _countSpikes( source, histogram, globalHistogram, filter );
+
+      if( source.cache )
+        source.cache->writeHistogram( cacheKey, histogram, globalHistogram );
+    }
+
+    _updateMaxima( histogram, globalHistogram, filter );
+  }
 
-    auto globalBin = globalHistogram.begin( );
-    auto spike = _spikes->begin( );
-    for( unsigned int& bin: *histogram )
+  void HistogramWidget::_updateMaxima(
+      Histogram& histogram,
+      const std::vector< unsigned int >& globalHistogram,
+      bool filter )
+  {
+    histogram._maxValueHistogramLocal = 0;
+    for( auto bin: histogram )
     {
-      while( spike != _spikes->end( ) && spike->first <= currentTime )
+      if( bin > histogram._maxValueHistogramLocal )
       {
-        if( !filter || _filteredGIDs.find( spike->second ) != _filteredGIDs.end( ))
+        histogram._maxValueHistogramLocal = bin;
+      }
+    }
+
+    histogram._maxValueHistogramGlobal = histogram._maxValueHistogramLocal;
+
+    if( filter )
+    {
+      for( auto bin : globalHistogram )
+      {
+        if( bin > histogram._maxValueHistogramGlobal )
         {
-          bin++;
+          histogram._maxValueHistogramGlobal = bin;
         }
-        spike++;
-        (*globalBin)++;
       }
+    }
+  }
+
+  unsigned int HistogramWidget::_binIndex( float time, float startTime,
+                                           float invTotalTime, unsigned int bins )
+  {
+    const float perc =
+        std::max( 0.0f, std::min( 1.0f, ( time - startTime ) * invTotalTime ));
 
-      currentTime += deltaTime;
-      ++globalBin;
+    return std::min( bins - 1, static_cast< unsigned int >( perc * bins ));
+  }
+
+  void HistogramWidget::_countSpikes( const DataSource& source,
+                                      Histogram& histogram,
+                                      std::vector< unsigned int >& globalHistogram,
+                                      bool filter )
+  {
+    const GIDUSet& gids = *source.gids;
+    const simil::Spikes& spikes = *source.spikes;
+
+    float totalTime = source.endTime - source.startTime ;
+    const float invTotalTime = 1.0f / totalTime;
+    const unsigned int bins = histogram.size( );
+
+#ifndef VISIMPL_USE_OPENMP
+
+    for( const auto& spike : spikes )
+    {
+      const unsigned int bin =
+          _binIndex( spike.first, source.startTime, invTotalTime, bins );
+
+      if( !filter || gids.find( spike.second ) != gids.end( ))
+        histogram[ bin ]++;
+
+      globalHistogram[ bin ]++;
     }
 
 #else
 
-    const float invTotalTime = 1.0f / totalTime;
     unsigned int numThreads = 4;
 
     omp_set_dynamic( 0 );
     omp_set_num_threads( numThreads );
-    const auto& references = _spikes->refData( );
+    const auto& references = spikes.refData( );
     for( int i = 0; i < ( int ) references.size( ); i++)
     {
       simil::TSpikes::const_iterator spikeIt = references[ i ];
 
       float endTime = ( i < ( ( int )references.size( ) - 1 )) ?
                       references[ i + 1]->first :
-                      _endTime;
+                      source.endTime;
 
-      int bin;
-      while( spikeIt->first < endTime && spikeIt != _spikes->end( ))
+      while( spikeIt != spikes.end( ) && spikeIt->first < endTime )
       {
-        float perc =
-            std::max( 0.0f,
-                      std::min( 1.0f, ( spikeIt->first - _startTime )* invTotalTime ));
-        bin = perc * histogram->size( );
+        const unsigned int bin =
+            _binIndex( spikeIt->first, source.startTime, invTotalTime, bins );
 
-        if( !filter || _filteredGIDs.find( spikeIt->second ) != _filteredGIDs.end( ))
+        if( !filter || gids.find( spikeIt->second ) != gids.end( ))
         {
-          ( *histogram )[ bin ]++;
+          histogram[ bin ]++;
         }
         ( globalHistogram )[ bin ]++;
         ++spikeIt;
@@ -250,28 +379,82 @@ namespace visimpl
     }
 #endif // VISIMPL_USE_OPENMP
 
-    unsigned int cont = 0;
-    for( auto bin: *histogram )
-    {
-      if( bin > histogram->_maxValueHistogramLocal )
-      {
-        histogram->_maxValueHistogramLocal = bin;
-      }
-      cont++;
-    }
+    // Streamed reports keep no spikes in memory, the loops above found none.
+    if( source.stream )
+      _buildFromStream( source, histogram, globalHistogram, filter );
+  }
+
+  void HistogramWidget::_buildFromStream( const DataSource& source,
+                                          Histogram& histogram,
+                                          std::vector< unsigned int >& globalHistogram,
+                                          bool filter )
+  {
+    const GIDUSet& gids = *source.gids;
+    const float startTime = source.startTime;
+    const float endTime = source.endTime;
+    SpikeStream* stream = source.stream;
 
-    histogram->_maxValueHistogramGlobal = histogram->_maxValueHistogramLocal;
+    const float invTotalTime = 1.0f / ( endTime - startTime );
+    const unsigned int bins = histogram.size( );
 
-    if( filter )
+    if( !filter )
     {
-      for( auto bin : globalHistogram )
+      // Resample the precomputed activity summary, no spike is read. Bin
+      // edges are looked up in its cumulative counts, interpolated inside
+      // each summary bin, so histograms finer than the summary are spread
+      // evenly instead of leaving empty bins in between.
+      const auto& summary = stream->activitySummary( );
+      if( summary.empty( ))
+        return;
+
+      const unsigned int lastSummaryBin = summary.size( ) - 1;
+
+      std::vector< double > cumulative( summary.size( ) + 1, 0.0 );
+      for( unsigned int i = 0; i < summary.size( ); ++i )
+        cumulative[ i + 1 ] = cumulative[ i ] + summary[ i ];
+
+      const double summaryStart = stream->startTime( );
+      const double summaryScale =
+          summary.size( ) / double( stream->endTime( ) - summaryStart );
+
+      auto countBefore = [ & ]( double time )
       {
-        if( bin > histogram->_maxValueHistogramGlobal )
-        {
-          histogram->_maxValueHistogramGlobal = bin;
-        }
+        const double position = std::max( 0.0, std::min( double( summary.size( )),
+            ( time - summaryStart ) * summaryScale ));
+        const unsigned int index = std::min( static_cast< unsigned int >( position ),
+                                             lastSummaryBin );
+
+        return std::llround( cumulative[ index ] +
+                             ( position - index ) * summary[ index ]);
+      };
+
+      const double binTime = double( endTime - startTime ) / histogram.size( );
+      long long previous = countBefore( startTime );
+      for( unsigned int bin = 0; bin < histogram.size( ); ++bin )
+      {
+        const long long next = countBefore( startTime + ( bin + 1 ) * binTime );
+        histogram[ bin ] += next - previous;
+        globalHistogram[ bin ] += next - previous;
+        previous = next;
       }
+      return;
     }
+
+    stream->forEachChunk(
+        [ & ]( const float* times, const uint32_t* spikeGids, uint64_t count )
+        {
+          for( uint64_t i = 0; i < count; ++i )
+          {
+            const unsigned int bin =
+                _binIndex( times[ i ], startTime, invTotalTime, bins );
+
+            if( gids.find( spikeGids[ i ]) != gids.end( ))
+              histogram[ bin ]++;
+
+            globalHistogram[ bin ]++;
+          }
+          return true;
+        });
   }
 
   constexpr float base = 1.0001f;
@@ -313,42 +496,83 @@ namespace visimpl
 
   void HistogramWidget::CalculateColors( THistogram histogramNumber )
   {
-    Histogram* histogram = &_mainHistogram;
+    // Colors are computed along with the pending bins.
+    if( _dataPending )
+      return;
 
-    if( histogramNumber == T_HIST_FOCUS )
-      histogram = &_focusHistogram;
+    _calculateColors( histogramNumber == T_HIST_FOCUS ? _focusHistogram :
+                                                        _mainHistogram );
 
-    if( _repMode == T_REP_DENSE )
+    updateCachedRep( );
+  }
+
+  void HistogramWidget::_calculateColors( Histogram& histogram )
+  {
+    _calculateColors( histogram, colorConfig( ));
+  }
+
+  void HistogramWidget::_calculateColors( Histogram& histogram,
+                                          const ColorConfig& config )
+  {
+    if( config.repMode == T_REP_DENSE )
     {
-      QGradientStops stops;
+      float maxValue = config.normRule == T_NORM_GLOBAL ?
+                        histogram._maxValueHistogramGlobal :
+                        histogram._maxValueHistogramLocal;
 
-      float maxValue = 0.0f;
-      float relativeTime = 0.0f;
-      float delta = 1.0f / histogram->size( );
-      float percentage;
+      maxValue = maxValueFunc( maxValue, config.normRule == T_NORM_GLOBAL ?
+                                          config.colorScaleGlobal :
+                                          config.colorScaleLocal );
 
-      maxValue = _normRule == T_NORM_GLOBAL ?
-                  histogram->_maxValueHistogramGlobal :
-                  histogram->_maxValueHistogramLocal;
+      const unsigned int binsNumber = histogram.size( );
 
-      maxValue = maxValueFunc( maxValue, _normRule == T_NORM_GLOBAL ?
-                                          _colorScaleGlobal :
-                                          _colorScaleLocal );
+      // Scale the whole bin array first, in loops simple enough for the
+      // compiler to vectorize, then look the colors up in a table.
+      std::vector< float > percentages( binsNumber );
+      switch( config.colorScaleLocal )
+      {
+        case T_COLOR_LINEAR:
+          for( unsigned int i = 0; i < binsNumber; ++i )
+            percentages[ i ] = histogram[ i ] * maxValue;
+          break;
+        case T_COLOR_LOGARITHMIC:
+          for( unsigned int i = 0; i < binsNumber; ++i )
+            percentages[ i ] = log10f( float( histogram[ i ])) * maxValue;
+          break;
+        default:
+          for( unsigned int i = 0; i < binsNumber; ++i )
+            percentages[ i ] = config.scaleFuncLocal( float( histogram[ i ]), maxValue );
+          break;
+      }
 
-      for( auto bin: *histogram )
+      constexpr unsigned int lutSize = 256;
+      QRgb lut[ lutSize ];
+      for( unsigned int i = 0; i < lutSize; ++i )
       {
-        percentage = _scaleFuncLocal( float( bin ), maxValue );
-        percentage = std::max< float >( std::min< float > (1.0f, percentage ), 0.0f);
+        const glm::vec4 color = config.colorMapper.GetValue( i / float( lutSize - 1 ));
+        lut[ i ] = QColor( color.r, color.g, color.b, color.a ).rgba( );
+      }
 
-        glm::vec4 color = _colorMapper.GetValue( percentage );
-        stops << qMakePair( relativeTime, QColor( color.r, color.g, color.b, color.a ));
+      QImage image( std::max( 1u, binsNumber ), 1, QImage::Format_ARGB32 );
+      image.fill( Qt::transparent );
 
-        relativeTime += delta;
+      QRgb* pixels = reinterpret_cast< QRgb* >( image.scanLine( 0 ));
+      for( unsigned int i = 0; i < binsNumber; ++i )
+      {
+        // The negated comparison also sends NaN, from empty rows, to 0.
+        float percentage = percentages[ i ];
+        if( !( percentage > 0.0f ))
+          percentage = 0.0f;
+        else if( percentage > 1.0f )
+          percentage = 1.0f;
+
+        pixels[ i ] = lut[ static_cast< unsigned int >(
+            percentage * ( lutSize - 1 ) + 0.5f )];
       }
 
-      histogram->_gradientStops = stops;
+      histogram._denseImage = image;
     }
-    else if( _repMode == T_REP_CURVE )
+    else if( config.repMode == T_REP_CURVE )
     {
       float invMaxValueLocal;
       float invMaxValueGlobal;
@@ -356,22 +580,22 @@ namespace visimpl
       QPolygonF auxLocal;
       QPolygonF auxGlobal;
 
-      auxLocal.reserve( histogram->size( ));
-      auxGlobal.reserve( histogram->size( ));
+      auxLocal.reserve( histogram.size( ));
+      auxGlobal.reserve( histogram.size( ));
 
-      invMaxValueLocal = maxValueFunc( histogram->_maxValueHistogramLocal,
-                                       _colorScaleLocal );
+      invMaxValueLocal = maxValueFunc( histogram._maxValueHistogramLocal,
+                                       config.colorScaleLocal );
 
-      invMaxValueGlobal = maxValueFunc( histogram->_maxValueHistogramGlobal,
-                                        _colorScaleGlobal );
+      invMaxValueGlobal = maxValueFunc( histogram._maxValueHistogramGlobal,
+                                        config.colorScaleGlobal );
 
       float currentX;
       float globalY;
       float localY;
       unsigned int counter = 0;
-      const float invBins = 1.0f / float( histogram->size( ) - 1);
+      const float invBins = 1.0f / float( histogram.size( ) - 1);
 
-      for( auto bin: *histogram )
+      for( auto bin: histogram )
       {
         currentX = counter * invBins;
 
@@ -380,8 +604,8 @@ namespace visimpl
 
         if( bin > 0)
         {
-          globalY = _scaleFuncGlobal( float( bin ), invMaxValueGlobal );
-          localY = _scaleFuncLocal( float( bin ), invMaxValueLocal );
+          globalY = config.scaleFuncGlobal( float( bin ), invMaxValueGlobal );
+          localY = config.scaleFuncLocal( float( bin ), invMaxValueLocal );
         }
 
         auxGlobal.push_back( QPointF( currentX, 1.0f - globalY ));
@@ -390,16 +614,51 @@ namespace visimpl
         counter++;
       }
 
-      histogram->_curveStopsGlobal = auxGlobal;
-      histogram->_curveStopsLocal = auxLocal;
+      histogram._curveStopsGlobal = auxGlobal;
+      histogram._curveStopsLocal = auxLocal;
     }
+  }
+
+  void HistogramWidget::_computeData( const DataSource& source,
+                                      const ColorConfig& config,
+                                      unsigned int binsNumber, float zoom,
+                                      Histogram& main, Histogram& focus )
+  {
+    main.resize( binsNumber, 0 );
+    _buildHistogram( source, main );
+    _calculateColors( main, config );
+
+    focus.resize( binsNumber * zoom, 0 );
+    _buildHistogram( source, focus );
+    _calculateColors( focus, config );
+  }
+
+  void HistogramWidget::_publishData( Histogram&& main, Histogram&& focus )
+  {
+    main._gridLines = std::move( _mainHistogram._gridLines );
+
+    _mainHistogram = std::move( main );
+    _focusHistogram = std::move( focus );
+
+    // Released or invalidated while building, the data is current now.
+    _dataPending = false;
+    _building = false;
 
     updateCachedRep( );
+    update( );
+  }
+
+  void HistogramWidget::_resolution( unsigned int binsNumber, float zoom )
+  {
+    // The data stays pending until the rebuilt rows are published.
+    _bins = binsNumber;
+    _zoomFactor = zoom;
+    _building = true;
   }
 
   unsigned int HistogramWidget::gidsSize( void )
   {
-    return _player->data( )->gids( ).size( ) - _filteredGIDs.size( );
+    return _player->data( )->gids( ).size( ) - _filteredGIDs->size( );
   }
 
   void HistogramWidget::name( const std::string& name_ )
@@ -419,6 +678,12 @@ namespace visimpl
 
     _bins = binsNumber;
 
+    if( _lazy )
+    {
+      _dataPending = true;
+      return;
+    }
+
     _mainHistogram.clear( );
     _mainHistogram.resize( _bins, 0 );
     _mainHistogram._maxValueHistogramLocal = 0;
@@ -453,6 +718,12 @@ namespace visimpl
   {
     _zoomFactor = factor;
 
+    if( _lazy )
+    {
+      _dataPending = true;
+      return;
+    }
+
     unsigned int focusBins = _bins * _zoomFactor;
 
     _focusHistogram.clear( );
@@ -470,12 +741,22 @@ namespace visimpl
 
   void HistogramWidget::filteredGIDs( const GIDUSet& gids )
   {
-    _filteredGIDs = gids;
+    _filteredGIDs = std::make_shared< const GIDUSet >( gids );
+  }
+
+  void HistogramWidget::filteredGIDs( GIDUSet&& gids )
+  {
+    _filteredGIDs = std::make_shared< const GIDUSet >( std::move( gids ));
+  }
+
+  void HistogramWidget::filteredGIDs( std::shared_ptr< const GIDUSet > gids )
+  {
+    _filteredGIDs = std::move( gids );
   }
 
   const GIDUSet& HistogramWidget::filteredGIDs( void ) const
   {
-    return _filteredGIDs;
+    return *_filteredGIDs;
   }
 
   void HistogramWidget::colorScaleLocal( TColorScale scale )
@@ -567,6 +848,8 @@ namespace visimpl
     }
 
     _mainHistogram._gridLines = gridLines;
+
+    _backgroundDirty = true;
   }
 
   unsigned int HistogramWidget::gridLinesNumber( void ) const
@@ -578,6 +861,7 @@ namespace visimpl
       TRepresentation_Mode repMode )
   {
     _repMode = repMode;
+    _backgroundDirty = true;
   }
 
   TRepresentation_Mode
@@ -636,6 +920,7 @@ namespace visimpl
   void HistogramWidget::colorLocal( const QColor& color )
   {
     _colorLocal = color;
+    _backgroundDirty = true;
   }
 
   QColor HistogramWidget::colorGlobal( void ) const
@@ -646,15 +931,20 @@ namespace visimpl
   void HistogramWidget::colorGlobal( const QColor& color )
   {
     _colorGlobal = color;
+    _backgroundDirty = true;
   }
 
-  const QGradientStops& HistogramWidget::gradientStops( void )
+  const QImage& HistogramWidget::denseImage( void ) const
   {
-    return _mainHistogram._gradientStops;
+    return _mainHistogram._denseImage;
   }
 
   unsigned int HistogramWidget::valueAt( float percentage )
   {
+    // Lazy rows have no bins until built.
+    if( _mainHistogram.empty( ))
+      return 0;
+
     unsigned int position =
         std::max( 0.0f, std::min( 1.0f, percentage)) * _mainHistogram.size( );
 
@@ -666,7 +956,11 @@ namespace visimpl
 
   unsigned int HistogramWidget::focusValueAt( float percentage )
   {
-    unsigned int position = percentage * _focusHistogram.size( );
+    if( _focusHistogram.empty( ))
+      return 0;
+
+    unsigned int position =
+        std::max( 0.0f, std::min( 1.0f, percentage )) * _focusHistogram.size( );
 
     if( position >= _focusHistogram.size( ))
       position = _focusHistogram.size( ) - 1;
@@ -681,33 +975,200 @@ namespace visimpl
 
   bool HistogramWidget::isInitialized( void )
   {
-    return _mainHistogram._gradientStops.size( ) > 0 ||
+    return !_mainHistogram._denseImage.isNull( ) ||
            _mainHistogram._curveStopsGlobal.size( ) > 0;
   }
 
-  QPolygonF HistogramWidget::localFunction( void ) const
+  void HistogramWidget::lazy( bool lazy_ )
+  {
+    _lazy = lazy_;
+  }
+
+  bool HistogramWidget::lazy( void ) const
+  {
+    return _lazy;
+  }
+
+  void HistogramWidget::buildPendingData( void )
+  {
+    if( !_dataPending )
+      return;
+
+    _dataPending = false;
+
+    _mainHistogram.resize( _bins, 0 );
+    _focusHistogram.resize( _bins * _zoomFactor, 0 );
+
+    BuildHistogram( T_HIST_MAIN );
+    CalculateColors( T_HIST_MAIN );
+
+    BuildHistogram( T_HIST_FOCUS );
+    CalculateColors( T_HIST_FOCUS );
+
+    updateCachedRep( );
+  }
+
+  void HistogramWidget::releaseData( void )
+  {
+    // Rows being rebuilt keep their data until the new one is published.
+    if( !_lazy || _dataPending || _building )
+      return;
+
+    // Grid lines only depend on the widget configuration, they are kept.
+    auto gridLines = std::move( _mainHistogram._gridLines );
+
+    _mainHistogram = Histogram( );
+    _focusHistogram = Histogram( );
+
+    _mainHistogram._gridLines = std::move( gridLines );
+
+    _dataPending = true;
+
+    _cachedBackground = QPixmap( );
+  }
+
+  const QPolygonF& HistogramWidget::localFunction( void ) const
   {
     return _mainHistogram._curveStopsLocal;
   }
 
-  QPolygonF HistogramWidget::globalFunction( void ) const
+  const QPolygonF& HistogramWidget::globalFunction( void ) const
   {
     return _mainHistogram._curveStopsGlobal;
   }
 
-  QPolygonF HistogramWidget::focusLocalFunction( void ) const
+  const QPolygonF& HistogramWidget::focusLocalFunction( void ) const
   {
     return _focusHistogram._curveStopsLocal;
   }
 
-  QPolygonF HistogramWidget::focusGlobalFunction( void ) const
+  const QPolygonF& HistogramWidget::focusGlobalFunction( void ) const
   {
     return _focusHistogram._curveStopsGlobal;
   }
 
+  void HistogramWidget::focusWindow( float start, float end,
+                                     unsigned int samples,
+                                     QPolygonF& local, QPolygonF& global ) const
+  {
+    local.clear( );
+    global.clear( );
+
+    const unsigned int binsNumber = _focusHistogram.size( );
+    if( binsNumber == 0 || samples < 2 || end <= start )
+      return;
+
+    const float firstBin = start * binsNumber;
+    const float windowBins = ( end - start ) * binsNumber;
+
+    std::vector< float > values( samples, 0.0f );
+
+    // Streamed reports keep no spikes around to count finer bins from.
+    if( windowBins >= samples || !_spikes || _spikeStream )
+    {
+      // Several bins per sample, keep the highest one so peaks are not lost.
+      for( unsigned int i = 0; i < samples; ++i )
+      {
+        const unsigned int first = std::min( binsNumber - 1,
+            static_cast< unsigned int >( firstBin + windowBins * i / samples ));
+        const unsigned int last = std::min( binsNumber, std::max( first + 1,
+            static_cast< unsigned int >( firstBin + windowBins * ( i + 1 ) / samples )));
+
+        for( unsigned int bin = first; bin < last; ++bin )
+          values[ i ] = std::max( values[ i ], float( _focusHistogram[ bin ]));
+      }
+    }
+    else
+    {
+      // Zoomed beyond the focus bins, one bin per sample scaled back to
+      // focus bin units. Bins are counted for a window width on each side,
+      // so dragging the mouse reads them back instead of scanning spikes.
+      const float totalTime = _endTime - _startTime;
+      const double windowStart = _startTime + start * totalTime;
+      const double binTime = ( end - start ) * totalTime / samples;
+      const float binScale = samples / windowBins;
+
+      FocusCounts& cache = _focusCounts;
+
+      const bool sameGrid =
+          cache.spikes == _spikes && cache.gids == _filteredGIDs &&
+          cache.startTime == _startTime && cache.endTime == _endTime &&
+          std::abs( cache.binTime - binTime ) <= binTime * 1e-3;
+
+      const double gridTime = sameGrid ? cache.binTime : binTime;
+      const long long windowFirst =
+          std::floor(( windowStart - _startTime ) / gridTime );
+
+      if( !sameGrid || windowFirst < cache.firstBin ||
+          windowFirst + samples > cache.firstBin + ( long long ) cache.counts.size( ))
+      {
+        cache.spikes = _spikes;
+        cache.gids = _filteredGIDs;
+        cache.startTime = _startTime;
+        cache.endTime = _endTime;
+        cache.binTime = gridTime;
+        cache.firstBin = windowFirst - samples;
+        cache.counts.assign( 3 * samples, 0 );
+
+        const GIDUSet& gids = *_filteredGIDs;
+        const bool filter = !gids.empty( );
+
+        const double countStart = _startTime + cache.firstBin * gridTime;
+        const double countEnd = countStart + cache.counts.size( ) * gridTime;
+
+        auto spike = std::lower_bound( _spikes->begin( ), _spikes->end( ),
+                                       countStart,
+                                       []( const simil::Spike& spike_, double time )
+                                       { return spike_.first < time; });
+
+        for( ; spike != _spikes->end( ) && spike->first < countEnd; ++spike )
+        {
+          if( filter && gids.find( spike->second ) == gids.end( ))
+            continue;
+
+          const unsigned int bin = std::min(
+              static_cast< unsigned int >( cache.counts.size( ) - 1 ),
+              static_cast< unsigned int >(( spike->first - countStart ) / gridTime ));
+          ++cache.counts[ bin ];
+        }
+      }
+
+      const unsigned int offset = windowFirst - cache.firstBin;
+      for( unsigned int i = 0; i < samples; ++i )
+        values[ i ] = cache.counts[ offset + i ] * binScale;
+    }
+
+    const float invMaxValueLocal =
+        maxValueFunc( _focusHistogram._maxValueHistogramLocal, _colorScaleLocal );
+    const float invMaxValueGlobal =
+        maxValueFunc( _focusHistogram._maxValueHistogramGlobal, _colorScaleGlobal );
+
+    local.reserve( samples );
+    global.reserve( samples );
+
+    const float invSamples = 1.0f / float( samples - 1 );
+    for( unsigned int i = 0; i < samples; ++i )
+    {
+      float localY = 0.0f;
+      float globalY = 0.0f;
+
+      if( values[ i ] > 0.0f )
+      {
+        localY = std::max( 0.0f, std::min( 1.0f,
+            _scaleFuncLocal( values[ i ], invMaxValueLocal )));
+        globalY = std::max( 0.0f, std::min( 1.0f,
+            _scaleFuncGlobal( values[ i ], invMaxValueGlobal )));
+      }
+
+      local.push_back( QPointF( i * invSamples, 1.0f - localY ));
+      global.push_back( QPointF( i * invSamples, 1.0f - globalY ));
+    }
+  }
+
   void HistogramWidget::fillPlots( bool fillPlots_ )
   {
     _fillPlots = fillPlots_;
+    _backgroundDirty = true;
   }
 
   void HistogramWidget::mousePressEvent( QMouseEvent* event_ )
@@ -763,6 +1224,16 @@ namespace visimpl
     _player = player;
   }
 
+  void HistogramWidget::spikeStream( SpikeStream* stream )
+  {
+    _spikeStream = stream;
+  }
+
+  void HistogramWidget::analysisCache( AnalysisCache* cache )
+  {
+    _analysisCache = cache;
+  }
+
   void HistogramWidget::regionWidth( float region_ )
   {
     _regionWidth = region_;
@@ -781,29 +1252,84 @@ namespace visimpl
   void HistogramWidget::firstHistogram( bool first )
   {
     _paintTimeline = first;
+    _backgroundDirty = true;
   }
 
-  void HistogramWidget::updateCachedRep( void )
+  // Builds the filled path of a normalized curve keeping, for every pixel
+  // column, only its first, minimum, maximum and last points, so the path
+  // size is bounded by the widget width instead of the number of bins.
+  static QPainterPath decimatedPath( const QPolygonF& curve,
+                                     int width_, int height_ )
   {
-    _mainHistogram._cachedLocalRep = QPainterPath( );
-    _mainHistogram._cachedGlobalRep = QPainterPath( );
+    QPainterPath path;
+    path.moveTo( 0, height_ );
+
+    int column = -1;
+    QPointF first, minPoint, maxPoint, last;
+    bool minBeforeMax = true;
 
-    _mainHistogram._cachedLocalRep.moveTo( 0, height( ) );
-    for( auto point : _mainHistogram._curveStopsLocal )
+    auto flushColumn = [ & ]( )
     {
-      _mainHistogram._cachedLocalRep.lineTo( QPoint( point.x( ) * width( ),
-                                                     point.y( ) * height( )));
-    }
-    _mainHistogram._cachedLocalRep.lineTo( width( ), height( ) );
+      if( column < 0 )
+        return;
+
+      path.lineTo( first );
+
+      const QPointF& lower = minBeforeMax ? minPoint : maxPoint;
+      const QPointF& upper = minBeforeMax ? maxPoint : minPoint;
+
+      if( lower != first )
+        path.lineTo( lower );
+      if( upper != lower && upper != last )
+        path.lineTo( upper );
+      if( last != first )
+        path.lineTo( last );
+    };
 
-    _mainHistogram._cachedGlobalRep.moveTo( 0, height( ) );
-    for( auto point : _mainHistogram._curveStopsGlobal )
+    for( const auto& point : curve )
     {
-      _mainHistogram._cachedGlobalRep.lineTo( QPoint( point.x( ) * width( ),
-                                                      point.y( ) * height( )));
+      const QPointF scaled( point.x( ) * width_, point.y( ) * height_ );
+      const int pointColumn = static_cast< int >( scaled.x( ));
+
+      if( pointColumn != column )
+      {
+        flushColumn( );
+
+        column = pointColumn;
+        first = minPoint = maxPoint = last = scaled;
+        minBeforeMax = true;
+        continue;
+      }
+
+      if( scaled.y( ) < minPoint.y( ))
+      {
+        minPoint = scaled;
+        minBeforeMax = false;
+      }
+      else if( scaled.y( ) > maxPoint.y( ))
+      {
+        maxPoint = scaled;
+        minBeforeMax = true;
+      }
+
+      last = scaled;
     }
-    _mainHistogram._cachedGlobalRep.lineTo( width( ), height( ) );
+    flushColumn( );
 
+    path.lineTo( width_, height_ );
+
+    return path;
+  }
+
+  void HistogramWidget::updateCachedRep( void )
+  {
+    _mainHistogram._cachedLocalRep =
+        decimatedPath( _mainHistogram._curveStopsLocal, width( ), height( ));
+
+    _mainHistogram._cachedGlobalRep =
+        decimatedPath( _mainHistogram._curveStopsGlobal, width( ), height( ));
+
+    _backgroundDirty = true;
   }
 
   void HistogramWidget::resizeEvent( QResizeEvent* /*event*/ )
@@ -811,28 +1337,26 @@ namespace visimpl
     updateCachedRep( );
   }
 
-  void HistogramWidget::paintEvent( QPaintEvent* /*e*/)
+  void HistogramWidget::_paintBackground( QPainter& painter )
   {
-    QPainter painter( this );
     unsigned int currentHeight = height( );
 
-    QColor penColor;
+    QColor penColor = _penColor( );
 
-    if( _repMode == T_REP_DENSE )
+    if( _mainHistogram.empty( ))
     {
-      QLinearGradient gradient( 0, 0, width( ), 0 );
-
-      QRect area = rect();
-
-      gradient.setStops( _mainHistogram._gradientStops );
-      QBrush brush( gradient );
-
-      painter.fillRect( area, brush );
+      // Placeholder until the requested data is published.
+      painter.fillRect( rect( ), QBrush( QColor( 240, 240, 240, 255 ),
+                                         Qt::SolidPattern ));
+    }
+    else if( _repMode == T_REP_DENSE )
+    {
+      // One pixel per bin, stretched and interpolated to the widget.
+      painter.setRenderHint( QPainter::SmoothPixmapTransform );
+      painter.drawImage( rect( ), _mainHistogram._denseImage );
 
       QLine line( QPoint( 0, currentHeight), QPoint( width( ), currentHeight ));
       painter.drawLine( line );
-
-      penColor = QColor( 255, 255, 255 );
     }
     else if( _repMode == T_REP_CURVE )
     {
@@ -875,8 +1399,6 @@ namespace visimpl
         painter.setPen( QPen( localColor, Qt::SolidLine ));
         painter.drawPath( _mainHistogram._cachedLocalRep );
       }
-
-      penColor = QColor( 0, 0, 0 );
     }
 
     if( _mainHistogram._gridLines.size( ) > 0 )
@@ -919,6 +1441,139 @@ namespace visimpl
       }
     }
 
+    if( _events && _repMode == T_REP_CURVE )
+    {
+      for( const auto& timeFrame : *_events )
+      {
+        if( !timeFrame.visible )
+          continue;
+
+        QColor color = timeFrame.color;
+
+        color.setAlpha( 50 );
+        for( const auto& span : timeFrame.spans( width( )))
+          painter.fillRect( span.first, 0, span.second - span.first,
+                            height( ), color );
+      }
+    }
+  }
+
+  size_t HistogramWidget::_eventsSignature( void ) const
+  {
+    if( !_events || _repMode != T_REP_CURVE )
+      return 0;
+
+    // Events are shared with the event widgets, any change in their
+    // number, visibility or color has to redraw the cached background.
+    size_t signature = _events->size( );
+    for( const auto& timeFrame : *_events )
+    {
+      signature = signature * 31 + timeFrame.percentages( ).size( );
+      signature = signature * 31 + timeFrame.color.rgba( );
+      signature = signature * 2 + ( timeFrame.visible ? 1 : 0 );
+    }
+
+    return signature;
+  }
+
+  QColor HistogramWidget::_penColor( void ) const
+  {
+    return _repMode == T_REP_DENSE ? QColor( 255, 255, 255 ) : QColor( 0, 0, 0 );
+  }
+
+  // Horizontal extent reserved around markers for their labels.
+  constexpr int overlayTextWidth = 120;
+
+  QRect HistogramWidget::_overlayBounds( void ) const
+  {
+    QRect bounds;
+
+    if( _lastMousePosition )
+    {
+      const int positionX = std::min( width( ),
+          std::max( 0, mapFromGlobal( *_lastMousePosition ).x( )));
+
+      bounds |= QRect( positionX - overlayTextWidth, 0,
+                       2 * overlayTextWidth + 1, height( ));
+
+      if( _regionPercentage && _paintRegion )
+      {
+        const int regionPosX = width( ) * ( *_regionPercentage );
+        const int regionW = _regionWidth * width( );
+
+        bounds |= QRect( regionPosX - 2 * regionW - 1, 0,
+                         4 * regionW + 3, height( ));
+      }
+    }
+
+    if( _player )
+    {
+      const int lineX = _player->GetRelativeTime( ) * width( );
+
+      bounds |= QRect( lineX - overlayTextWidth, 0,
+                       2 * overlayTextWidth + 1, height( ));
+    }
+
+    return bounds & rect( );
+  }
+
+  void HistogramWidget::updateOverlay( void )
+  {
+    const QRect bounds = _overlayRect | _overlayBounds( );
+
+    if( !bounds.isEmpty( ))
+      update( bounds );
+  }
+
+  void HistogramWidget::invalidateBackground( void )
+  {
+    _backgroundDirty = true;
+    update( );
+  }
+
+  void HistogramWidget::paintEvent( QPaintEvent* e )
+  {
+    // Only painted while visible in the viewport. Lazy rows ask for their
+    // data to be built elsewhere, unless nobody listens.
+    if( _dataPending && !_building )
+    {
+      if( _lazy && receivers( SIGNAL( dataRequested( ))) > 0 )
+        emit dataRequested( );
+      else
+        buildPendingData( );
+    }
+
+    const qreal pixelRatio = devicePixelRatioF( );
+    const size_t eventsSignature = _eventsSignature( );
+
+    if( _backgroundDirty || eventsSignature != _eventsStamp ||
+        _cachedBackground.size( ) != size( ) * pixelRatio )
+    {
+      _cachedBackground = QPixmap( size( ) * pixelRatio );
+      _cachedBackground.setDevicePixelRatio( pixelRatio );
+      _cachedBackground.fill( Qt::transparent );
+
+      QPainter backgroundPainter( &_cachedBackground );
+      _paintBackground( backgroundPainter );
+
+      _backgroundDirty = false;
+      _eventsStamp = eventsSignature;
+
+      // A partial overlay update found stale contents, refresh them all.
+      if( e->rect( ) != rect( ))
+        update( );
+    }
+
+    QPainter painter( this );
+    painter.drawPixmap( 0, 0, _cachedBackground );
+
+    if( _repMode == T_REP_CURVE )
+      painter.setRenderHint( QPainter::Antialiasing );
+
+    const QColor penColor = _penColor( );
+
+    _overlayRect = _overlayBounds( );
+
     if( _lastMousePosition )
     {
       QPoint localPosition = mapFromGlobal( *_lastMousePosition );
@@ -975,23 +1630,6 @@ namespace visimpl
       painter.drawLine( marker );
     }
 
-    if( _events && _repMode == T_REP_CURVE )
-    {
-      for( const auto& timeFrame : *_events )
-      {
-        if( !timeFrame.visible )
-          continue;
-
-        QColor color = timeFrame.color;
-
-        color.setAlpha( 50 );
-        painter.setBrush( QBrush( color, Qt::SolidPattern));
-        painter.setPen( Qt::NoPen );
-        for( const auto& p : timeFrame._cachedCommonRep )
-          painter.drawPath( p );
-      }
-    }
-
     if( _player )
     {
       int lineX = _player->GetRelativeTime( ) * width( );
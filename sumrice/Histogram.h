@@ -27,11 +27,16 @@
 #include <simil/simil.h>
 #include <sumrice/api.h>
 
+#include <memory>
 #include <unordered_set>
 
 #include <QFrame>
+#include <QImage>
+#include <QPixmap>
 
 #include "types.h"
+#include "SpikeStream.h"
+#include "AnalysisCache.h"
 
 namespace visimpl
 {
@@ -39,6 +44,7 @@ namespace visimpl
   class SUMRICE_API HistogramWidget : public QFrame
   {
     friend class Summary;
+    friend class BatchAnalysis;
 
     Q_OBJECT;
 
@@ -56,7 +62,7 @@ namespace visimpl
 
       unsigned int _maxValueHistogramLocal;
       unsigned int _maxValueHistogramGlobal;
-      QGradientStops _gradientStops;
+      QImage _denseImage;
       QPolygonF _curveStopsLocal;
       QPolygonF _curveStopsGlobal;
 
@@ -66,6 +72,29 @@ namespace visimpl
       std::vector< float > _gridLines;
     };
 
+    //! What the bins are counted from, copied into rebuild jobs.
+    struct DataSource
+    {
+      std::shared_ptr< const GIDUSet > gids;
+      const simil::Spikes* spikes = nullptr;
+      float startTime = 0.0f;
+      float endTime = 0.0f;
+      SpikeStream* stream = nullptr;
+      AnalysisCache* cache = nullptr;
+    };
+
+    //! How the bins are turned into curves or dense images.
+    struct ColorConfig
+    {
+      TRepresentation_Mode repMode;
+      TNormalize_Rule normRule;
+      TColorScale colorScaleLocal;
+      TColorScale colorScaleGlobal;
+      float (*scaleFuncLocal)( float value, float maxValue );
+      float (*scaleFuncGlobal)( float value, float maxValue );
+      utils::InterpolationSet< glm::vec4 > colorMapper;
+    };
+
   public:
 
     typedef enum
@@ -106,6 +135,9 @@ namespace visimpl
     float zoomFactor( void ) const;
 
     void filteredGIDs( const GIDUSet& gids );
+    void filteredGIDs( GIDUSet&& gids );
+    //! Shares the subset with its owner, e.g. a Summary row.
+    void filteredGIDs( std::shared_ptr< const GIDUSet > gids );
     const GIDUSet& filteredGIDs( void ) const;
 
     void colorScaleLocal( TColorScale scale );
@@ -140,7 +172,8 @@ namespace visimpl
     const utils::InterpolationSet< glm::vec4 >& colorMapper( void );
     void colorMapper(const utils::InterpolationSet< glm::vec4 >& colors );
 
-    const QGradientStops& gradientStops( void );
+    //! Dense representation, one pixel per bin.
+    const QImage& denseImage( void ) const;
 
     virtual void mousePressEvent( QMouseEvent* event_ );
     virtual void mouseReleaseEvent( QMouseEvent* event_ );
@@ -151,6 +184,11 @@ namespace visimpl
 
     void simPlayer( simil::SimulationPlayer* player );
 
+    void spikeStream( SpikeStream* stream );
+
+    //! Optional cache of bin counts, not owned.
+    void analysisCache( AnalysisCache* cache );
+
     void regionWidth( float region_ );
     float regionWidth( void );
     void paintRegion( bool region = false );
@@ -162,14 +200,42 @@ namespace visimpl
 
     bool isInitialized( void );
 
-    QPolygonF localFunction( void ) const;
-    QPolygonF globalFunction( void ) const;
+    /*! \brief Defers building the bins and curves until the widget is
+     * painted, or buildPendingData is called. If dataRequested is connected
+     * painting emits it instead and shows a placeholder until the data is
+     * published.
+     */
+    void lazy( bool lazy_ );
+    bool lazy( void ) const;
+
+    void buildPendingData( void );
+
+    //! Frees the bins and curves of a lazy histogram until painted again.
+    void releaseData( void );
 
-    QPolygonF focusLocalFunction( void ) const;
-    QPolygonF focusGlobalFunction( void ) const;
+    const QPolygonF& localFunction( void ) const;
+    const QPolygonF& globalFunction( void ) const;
+
+    const QPolygonF& focusLocalFunction( void ) const;
+    const QPolygonF& focusGlobalFunction( void ) const;
+
+    /*! \brief Samples the focus curves between two simulation percentages
+     * with the given number of points, normalized like the curve stops.
+     * Windows with fewer focus bins than samples are counted again from
+     * the spikes at the requested resolution, around the window so the
+     * counts are reused while it moves at the same width.
+     */
+    void focusWindow( float start, float end, unsigned int samples,
+                      QPolygonF& local, QPolygonF& global ) const;
 
     void fillPlots( bool fillPlots_ );
 
+    //! Repaints only the area of the mouse marker, focus region and playhead.
+    void updateOverlay( void );
+
+    //! Redraws the cached curves, grid and events on the next paint.
+    void invalidateBackground( void );
+
 signals:
 
     void mousePositionChanged( QPoint point );
@@ -177,10 +243,62 @@ signals:
     void mouseReleased( QPoint coordinates, float position );
     void mouseModifierPressed( float position,  Qt::KeyboardModifiers modifiers );
 
+    //! A lazy histogram without data was painted.
+    void dataRequested( void );
+
   protected:
 
     void updateCachedRep( void );
 
+    DataSource dataSource( void ) const;
+    ColorConfig colorConfig( void ) const;
+
+    void _buildHistogram( Histogram& histogram );
+    static void _buildHistogram( const DataSource& source,
+                                 Histogram& histogram );
+    static void _updateMaxima( Histogram& histogram,
+                               const std::vector< unsigned int >& globalHistogram,
+                               bool filter );
+    void _calculateColors( Histogram& histogram );
+    static void _calculateColors( Histogram& histogram,
+                                  const ColorConfig& config );
+
+    /*! \brief Counts and curves at the given resolution. Only reads the
+     * given snapshots, so it can run off the GUI thread.
+     */
+    static void _computeData( const DataSource& source,
+                              const ColorConfig& config,
+                              unsigned int bins, float zoom,
+                              Histogram& main, Histogram& focus );
+
+    //! Adopts data from _computeData, on the GUI thread.
+    void _publishData( Histogram&& main, Histogram&& focus );
+
+    //! Sets bins and zoom factor without rebuilding, data is published later.
+    void _resolution( unsigned int bins, float zoom );
+
+    /*! \brief Bin of a spike time, shared by every counting path so the
+     * widget, the summary batches and the batch analysis agree on edges.
+     * Times outside the range fall in the first or last bin.
+     */
+    static unsigned int _binIndex( float time, float startTime,
+                                   float invTotalTime, unsigned int bins );
+
+    static void _countSpikes( const DataSource& source,
+                              Histogram& histogram,
+                              std::vector< unsigned int >& globalHistogram,
+                              bool filter );
+
+    static void _buildFromStream( const DataSource& source,
+                                  Histogram& histogram,
+                                  std::vector< unsigned int >& globalHistogram,
+                                  bool filter );
+
+    void _paintBackground( QPainter& painter );
+    QColor _penColor( void ) const;
+    size_t _eventsSignature( void ) const;
+    QRect _overlayBounds( void ) const;
+
     virtual void resizeEvent( QResizeEvent* event );
     virtual void paintEvent( QPaintEvent* event );
 
@@ -197,6 +315,10 @@ signals:
 
     simil::SimulationPlayer* _player;
 
+    SpikeStream* _spikeStream;
+
+    AnalysisCache* _analysisCache;
+
     float (*_scaleFuncLocal)( float value, float maxValue);
     float (*_scaleFuncGlobal)( float value, float maxValue);
 
@@ -216,7 +338,7 @@ signals:
 
     utils::InterpolationSet< glm::vec4 > _colorMapper;
 
-    GIDUSet _filteredGIDs;
+    std::shared_ptr< const GIDUSet > _filteredGIDs;
 
     QPoint* _lastMousePosition;
     float* _regionPercentage;
@@ -234,6 +356,32 @@ signals:
 
     bool _autoBuildHistogram;
     bool _autoCalculateColors;
+
+    bool _lazy;
+    bool _dataPending;
+
+    // Queued in a Summary rebuild, its data is published later.
+    bool _building;
+
+    QPixmap _cachedBackground;
+    bool _backgroundDirty;
+    size_t _eventsStamp;
+    QRect _overlayRect;
+
+    // Spike counts on a grid of window samples starting at _startTime,
+    // valid for the spikes, filter and time range they were counted from.
+    struct FocusCounts
+    {
+      const simil::Spikes* spikes = nullptr;
+      std::shared_ptr< const GIDUSet > gids;
+      float startTime = 0.0f;
+      float endTime = 0.0f;
+      double binTime = 0.0;
+      long long firstBin = 0;
+      std::vector< unsigned int > counts;
+    };
+
+    mutable FocusCounts _focusCounts;
   };
 }
 
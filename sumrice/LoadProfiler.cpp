@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2015-2020 VG-Lab/URJC.
+ *
+ * Authors: Sergio E. Galindo <sergio.galindo@urjc.es>
+ *
+ * This file is part of ViSimpl <https://github.com/vg-lab/visimpl>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "LoadProfiler.h"
+
+#include <atomic>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#ifndef _WIN32
+  #include <sys/resource.h>
+#endif
+
+namespace visimpl
+{
+  namespace
+  {
+    struct Phase
+    {
+      std::string name;
+      double milliseconds;
+      uint64_t peakRSS;
+    };
+
+    struct Profile
+    {
+      std::mutex mutex;
+      std::vector< Phase > phases;
+      std::vector< std::pair< std::string, uint64_t >> counters;
+    };
+
+    std::atomic< bool > profileEnabled( false );
+
+    Profile& profile( void )
+    {
+      static Profile instance;
+      return instance;
+    }
+
+    double toMegabytes( uint64_t bytes )
+    {
+      return bytes / ( 1024.0 * 1024.0 );
+    }
+  }
+
+  LoadProfiler::Scope::Scope( const std::string& phase_ )
+  : _phase( phase_ )
+  , _start( std::chrono::steady_clock::now( ))
+  { }
+
+  LoadProfiler::Scope::~Scope( )
+  {
+    const auto end = std::chrono::steady_clock::now( );
+
+    LoadProfiler::phase( _phase,
+        std::chrono::duration< double, std::milli >( end - _start ).count( ));
+  }
+
+  void LoadProfiler::enabled( bool enabled_ )
+  {
+    profileEnabled = enabled_;
+  }
+
+  bool LoadProfiler::enabled( void )
+  {
+    return profileEnabled;
+  }
+
+  void LoadProfiler::phase( const std::string& name, double milliseconds )
+  {
+    if( !enabled( ))
+      return;
+
+    const uint64_t rss = peakRSS( );
+
+    auto& current = profile( );
+    std::lock_guard< std::mutex > lock( current.mutex );
+    current.phases.push_back( Phase{ name, milliseconds, rss });
+  }
+
+  void LoadProfiler::counter( const std::string& name, uint64_t value )
+  {
+    if( !enabled( ))
+      return;
+
+    auto& current = profile( );
+    std::lock_guard< std::mutex > lock( current.mutex );
+
+    for( auto& entry : current.counters )
+    {
+      if( entry.first == name )
+      {
+        entry.second = value;
+        return;
+      }
+    }
+
+    current.counters.emplace_back( name, value );
+  }
+
+  void LoadProfiler::report( void )
+  {
+    if( !enabled( ))
+      return;
+
+    auto& current = profile( );
+    std::lock_guard< std::mutex > lock( current.mutex );
+
+    double total = 0.0;
+
+    std::cout << "--------------------------------------" << std::endl;
+    std::cout << "Load profile" << std::endl;
+    std::cout << "--------------------------------------" << std::endl;
+    std::cout << std::fixed << std::setprecision( 2 );
+
+    for( const auto& entry : current.phases )
+    {
+      std::cout << "  " << std::left << std::setw( 32 ) << entry.name
+                << std::right << std::setw( 12 ) << entry.milliseconds << " ms"
+                << std::setw( 12 ) << toMegabytes( entry.peakRSS ) << " MB peak"
+                << std::endl;
+
+      total += entry.milliseconds;
+    }
+
+    std::cout << "  " << std::left << std::setw( 32 ) << "Total"
+              << std::right << std::setw( 12 ) << total << " ms" << std::endl;
+
+    for( const auto& entry : current.counters )
+      std::cout << "  " << entry.first << ": " << entry.second << std::endl;
+
+    std::cout << "  Peak RSS: " << toMegabytes( peakRSS( )) << " MB" << std::endl;
+    std::cout << std::defaultfloat << std::setprecision( 6 );
+    std::cout << "--------------------------------------" << std::endl;
+
+    current.phases.clear( );
+    current.counters.clear( );
+  }
+
+  uint64_t LoadProfiler::peakRSS( void )
+  {
+#ifdef _WIN32
+    return 0;
+#else
+    struct rusage usage;
+    if( getrusage( RUSAGE_SELF, &usage ) != 0 )
+      return 0;
+
+  #ifdef __APPLE__
+    return static_cast< uint64_t >( usage.ru_maxrss );
+  #else
+    // Linux reports kilobytes.
+    return static_cast< uint64_t >( usage.ru_maxrss ) * 1024;
+  #endif
+#endif
+  }
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2015-2020 VG-Lab/URJC.
+ *
+ * Authors: Sergio E. Galindo <sergio.galindo@urjc.es>
+ *
+ * This file is part of ViSimpl <https://github.com/vg-lab/visimpl>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef __VISIMPL_LOADPROFILER__
+#define __VISIMPL_LOADPROFILER__
+
+#include <sumrice/api.h>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace visimpl
+{
+  /*! \brief Timing and memory report of opening a dataset.
+   *
+   * Phases record their wall time and the peak resident set size of the
+   * process when they finish, counters record dataset sizes such as GIDs and
+   * spikes. Nothing is recorded unless enabled, which is what the
+   * --profile-load command line flag does. report( ) writes the collected
+   * table to the log and starts a new profile. Phases may be recorded from
+   * any thread.
+   */
+  class SUMRICE_API LoadProfiler
+  {
+  public:
+
+    //! Records the phase from construction to destruction.
+    class SUMRICE_API Scope
+    {
+    public:
+      Scope( const std::string& phase );
+      ~Scope( );
+
+    protected:
+      std::string _phase;
+      std::chrono::steady_clock::time_point _start;
+    };
+
+    static void enabled( bool enabled_ );
+    static bool enabled( void );
+
+    static void phase( const std::string& name, double milliseconds );
+    static void counter( const std::string& name, uint64_t value );
+
+    static void report( void );
+
+    //! Peak resident set size of the process in bytes, 0 when unknown.
+    static uint64_t peakRSS( void );
+  };
+}
+
+#endif /* __VISIMPL_LOADPROFILER__ */
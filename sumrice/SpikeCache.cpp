@@ -0,0 +1,636 @@
+/*
+ * Copyright (c) 2015-2020 VG-Lab/URJC.
+ *
+ * Authors: Sergio E. Galindo <sergio.galindo@urjc.es>
+ *
+ * This file is part of ViSimpl <https://github.com/vg-lab/visimpl>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "SpikeCache.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QStringList>
+
+#ifdef SIMIL_USE_BRION
+#include <brion/brion.h>
+#endif
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <vector>
+
+namespace visimpl
+{
+  static const char SPIKE_CACHE_MAGIC[ 8 ] = { 'V', 'S', 'P', 'K', 'C', 'A', 'C', 'H' };
+
+  // Increase whenever the layout written by SpikeCache::write changes.
+  static const uint32_t SPIKE_CACHE_VERSION = 2;
+
+  static const uint64_t SPIKE_CACHE_CHUNK_SIZE = 1 << 20;
+  static const uint32_t SPIKE_CACHE_SUMMARY_BINS = 16384;
+
+  // Default size limit of the cache directory, overridden in gigabytes by
+  // VISIMPL_SPIKE_CACHE_LIMIT_GB.
+  static const uint64_t SPIKE_CACHE_LIMIT_GB = 20;
+
+  namespace
+  {
+    template< typename T >
+    void writeValue( QSaveFile& file, const T& value )
+    {
+      file.write( reinterpret_cast< const char* >( &value ), sizeof( T ));
+    }
+
+    template< typename T >
+    void writeArray( QSaveFile& file, const T* values, uint64_t count )
+    {
+      file.write( reinterpret_cast< const char* >( values ), sizeof( T ) * count );
+    }
+
+    void writeString( QSaveFile& file, const std::string& value )
+    {
+      writeValue( file, static_cast< uint32_t >( value.size( )));
+      file.write( value.data( ), value.size( ));
+    }
+
+    //! Bounds checked reader over the mapped file.
+    class MappedReader
+    {
+    public:
+      MappedReader( const uchar* data, qint64 size )
+      : _begin( data ), _cursor( data ), _end( data + size )
+      { }
+
+      template< typename T >
+      bool value( T& value_ )
+      {
+        return array( &value_, 1 );
+      }
+
+      template< typename T >
+      bool array( T* values, uint64_t count )
+      {
+        const uint64_t bytes = sizeof( T ) * count;
+        if( bytes > static_cast< uint64_t >( _end - _cursor ))
+          return false;
+
+        std::memcpy( values, _cursor, bytes );
+        _cursor += bytes;
+        return true;
+      }
+
+      uint64_t offset( void ) const
+      {
+        return _cursor - _begin;
+      }
+
+      bool string( std::string& value_ )
+      {
+        uint32_t length = 0;
+        if( !value( length ) || length > static_cast< uint64_t >( _end - _cursor ))
+          return false;
+
+        value_.assign( reinterpret_cast< const char* >( _cursor ), length );
+        _cursor += length;
+        return true;
+      }
+
+    protected:
+      const uchar* _begin;
+      const uchar* _cursor;
+      const uchar* _end;
+    };
+
+    /*! Identifies a file by name, size, modification time and a hash of
+     * its first and last megabyte, not by its location. The time catches
+     * rewrites that keep the size and leave both ends alone; copies that
+     * preserve it, e.g. with cp -p or rsync -t, still share the cache.
+     */
+    std::string fileStamp( const std::string& path )
+    {
+      QFile file( QString::fromStdString( path ));
+      if( !file.open( QIODevice::ReadOnly ))
+        return path;
+
+      const qint64 size = file.size( );
+      const qint64 sample = 1 << 20;
+
+      QCryptographicHash hash( QCryptographicHash::Sha1 );
+      hash.addData( file.read( sample ));
+      if( size > sample && file.seek( std::max( sample, size - sample )))
+        hash.addData( file.read( sample ));
+
+      const QFileInfo info( file );
+
+      return info.fileName( ).toStdString( ) + ":" + std::to_string( size ) +
+             ":" + std::to_string( info.lastModified( ).toMSecsSinceEpoch( )) +
+             ":" + hash.result( ).toHex( ).toStdString( );
+    }
+
+#ifndef SIMIL_USE_BRION
+    /*! Spike and circuit files referenced by a BlueConfig, found by the
+     * same keys and defaults Brion uses.
+     */
+    std::vector< std::string > configSources( const std::string& fileName )
+    {
+      QFile file( QString::fromStdString( fileName ));
+      if( !file.open( QIODevice::ReadOnly | QIODevice::Text ))
+        return { };
+
+      std::map< std::string, std::string > values;
+      while( !file.atEnd( ))
+      {
+        const QStringList fields =
+            QString::fromUtf8( file.readLine( )).simplified( ).split( ' ' );
+
+        if( fields.size( ) >= 2 && !fields.front( ).startsWith( '#' ))
+          values.emplace( fields[ 0 ].toStdString( ), fields[ 1 ].toStdString( ));
+      }
+
+      auto value = [ &values ]( const std::string& key )
+      {
+        const auto it = values.find( key );
+        return it == values.end( ) ? std::string( ) : it->second;
+      };
+
+      std::vector< std::string > sources;
+
+      if( !value( "SpikesPath" ).empty( ))
+        sources.push_back( value( "SpikesPath" ));
+      else if( !value( "OutputRoot" ).empty( ))
+        sources.push_back( value( "OutputRoot" ) + "/out.dat" );
+
+      if( !value( "CellLibraryFile" ).empty( ))
+        sources.push_back( value( "CellLibraryFile" ));
+      else if( !value( "CircuitPath" ).empty( ))
+        sources.push_back( value( "CircuitPath" ) + "/circuit.mvd2" );
+
+      return sources;
+    }
+#endif
+
+    bool readHeader( MappedReader& reader, const std::string& key,
+                     SpikeCache::Layout& layout, uint64_t& numGids,
+                     uint64_t& numSubsets, uint64_t& numEvents )
+    {
+      char magic[ 8 ];
+      uint32_t version = 0;
+      std::string storedKey;
+
+      return reader.array( magic, 8 ) &&
+             std::memcmp( magic, SPIKE_CACHE_MAGIC, 8 ) == 0 &&
+             reader.value( version ) && version == SPIKE_CACHE_VERSION &&
+             reader.string( storedKey ) && storedKey == key &&
+             reader.value( layout.startTime ) &&
+             reader.value( layout.endTime ) &&
+             reader.value( numGids ) &&
+             reader.value( layout.numSpikes ) &&
+             reader.value( numSubsets ) && reader.value( numEvents ) &&
+             reader.value( layout.chunkSize ) &&
+             reader.value( layout.summaryBins ) &&
+             layout.chunkSize > 0;
+    }
+
+    //! Stamps the files the dataset is actually read from.
+    std::string sourceStamp( const std::string& fileName,
+                             simil::TDataType dataType,
+                             const std::string& report )
+    {
+      std::string stamp = fileStamp( fileName );
+
+      if( dataType != simil::TBlueConfig )
+        return stamp + "|" + fileStamp( report );
+
+      // The report is a target name, the spikes and circuit are referenced
+      // by the BlueConfig itself.
+      stamp += "|" + report;
+#ifdef SIMIL_USE_BRION
+      try
+      {
+        const brion::BlueConfig config( fileName );
+        stamp += "|" + fileStamp( config.getSpikeSource( ).getPath( )) +
+                 "|" + fileStamp( config.getCircuitSource( ).getPath( ));
+      }
+      catch( const std::exception& error )
+      {
+        std::cerr << "Unable to resolve BlueConfig sources: " << error.what( )
+                  << " " << __FILE__ << ":" << __LINE__ << std::endl;
+      }
+#else
+      for( const auto& source : configSources( fileName ))
+        stamp += "|" + fileStamp( source );
+#endif
+      return stamp;
+    }
+
+    uint64_t cacheLimit( void )
+    {
+      const char* value = std::getenv( "VISIMPL_SPIKE_CACHE_LIMIT_GB" );
+      const uint64_t limit = value ? std::strtoull( value, nullptr, 10 ) : 0;
+
+      return ( limit > 0 ? limit : SPIKE_CACHE_LIMIT_GB ) << 30;
+    }
+
+    //! Removes the least recently used cache files until they fit the limit.
+    void evict( const QString& directory, const QString& keep )
+    {
+      QFileInfoList files =
+          QDir( directory ).entryInfoList( QStringList( "*.spk" ), QDir::Files,
+                                           QDir::Time | QDir::Reversed );
+
+      uint64_t total = 0;
+      for( const auto& info : files )
+        total += info.size( );
+
+      const uint64_t limit = cacheLimit( );
+      for( const auto& info : files )
+      {
+        if( total <= limit )
+          break;
+
+        if( info.absoluteFilePath( ) == keep ||
+            !QFile::remove( info.absoluteFilePath( )))
+          continue;
+
+        total -= info.size( );
+      }
+    }
+  }
+
+  bool SpikeCache::enabled( void )
+  {
+    return std::getenv( "VISIMPL_DISABLE_SPIKE_CACHE" ) == nullptr;
+  }
+
+  std::string SpikeCache::_key( const std::string& fileName,
+                                simil::TDataType dataType,
+                                const std::string& report )
+  {
+    return std::to_string( SPIKE_CACHE_VERSION ) + "|" +
+           std::to_string( static_cast< int >( dataType )) + "|" +
+           sourceStamp( fileName, dataType, report );
+  }
+
+  std::string SpikeCache::_cacheFile( const std::string& key )
+  {
+    // A shared directory lets several users, or machines, reuse a single
+    // conversion of the same dataset.
+    const char* sharedDir = std::getenv( "VISIMPL_SPIKE_CACHE_DIR" );
+    const QString dir = sharedDir ? QString::fromLocal8Bit( sharedDir ) :
+        QStandardPaths::writableLocation( QStandardPaths::CacheLocation ) +
+        "/spikes";
+
+    const QByteArray hash =
+        QCryptographicHash::hash( QByteArray::fromStdString( key ),
+                                  QCryptographicHash::Sha1 ).toHex( );
+
+    return ( dir + "/" + QString::fromLatin1( hash ) + ".spk" ).toStdString( );
+  }
+
+  simil::SpikeData* SpikeCache::load( const std::string& fileName,
+                                      simil::TDataType dataType,
+                                      const std::string& report,
+                                      bool* fromCache )
+  {
+    simil::SpikeData* data = enabled( ) ?
+        read( fileName, dataType, report ) : nullptr;
+
+    if( fromCache )
+      *fromCache = data != nullptr;
+
+    if( data )
+      return data;
+
+    data = new simil::SpikeData( fileName, dataType, report );
+
+    if( enabled( ))
+      write( data, fileName, dataType, report );
+
+    return data;
+  }
+
+  bool SpikeCache::header( const std::string& fileName,
+                           simil::TDataType dataType,
+                           const std::string& report,
+                           Layout& layout )
+  {
+    const std::string key = _key( fileName, dataType, report );
+
+    QFile file( QString::fromStdString( _cacheFile( key )));
+    if( !file.open( QIODevice::ReadOnly ))
+      return false;
+
+    // Magic, version, key and the fixed size fields before the network.
+    const QByteArray bytes = file.read( 8 + 2 * sizeof( uint32_t ) + key.size( ) +
+                                        2 * sizeof( float ) + 5 * sizeof( uint64_t ) +
+                                        sizeof( uint32_t ));
+
+    MappedReader reader( reinterpret_cast< const uchar* >( bytes.constData( )),
+                         bytes.size( ));
+
+    uint64_t numGids = 0;
+    uint64_t numSubsets = 0;
+    uint64_t numEvents = 0;
+
+    return readHeader( reader, key, layout, numGids, numSubsets, numEvents );
+  }
+
+  std::string SpikeCache::cacheFile( const std::string& fileName,
+                                     simil::TDataType dataType,
+                                     const std::string& report )
+  {
+    return _cacheFile( _key( fileName, dataType, report ));
+  }
+
+  simil::SpikeData* SpikeCache::read( const std::string& fileName,
+                                      simil::TDataType dataType,
+                                      const std::string& report,
+                                      bool withSpikes,
+                                      Layout* layout )
+  {
+    const std::string key = _key( fileName, dataType, report );
+
+    QFile file( QString::fromStdString( _cacheFile( key )));
+    if( !file.exists( ) || !file.open( QIODevice::ReadOnly ))
+      return nullptr;
+
+    const qint64 size = file.size( );
+    const uchar* mapped = file.map( 0, size );
+    if( !mapped )
+      return nullptr;
+
+    MappedReader reader( mapped, size );
+
+    Layout fileLayout;
+    uint64_t numGids = 0;
+    uint64_t numSubsets = 0;
+    uint64_t numEvents = 0;
+
+    if( !readHeader( reader, key, fileLayout, numGids, numSubsets, numEvents ))
+    {
+      file.unmap( const_cast< uchar* >( mapped ));
+      return nullptr;
+    }
+
+    std::vector< uint32_t > gids( numGids );
+    std::vector< float > positions( numGids * 3 );
+
+    bool valid = reader.array( gids.data( ), numGids ) &&
+                 reader.array( positions.data( ), numGids * 3 );
+
+    std::vector< std::pair< std::string, GIDVec >> subsets;
+    for( uint64_t i = 0; valid && i < numSubsets; ++i )
+    {
+      std::string name;
+      uint64_t count = 0;
+      valid = reader.string( name ) && reader.value( count );
+
+      GIDVec subset( valid ? count : 0 );
+      valid = valid && reader.array( subset.data( ), count );
+
+      subsets.emplace_back( name, std::move( subset ));
+    }
+
+    std::vector< std::pair< std::string, EventVec >> events;
+    for( uint64_t i = 0; valid && i < numEvents; ++i )
+    {
+      std::string name;
+      uint64_t count = 0;
+      valid = reader.string( name ) && reader.value( count );
+
+      std::vector< float > bounds( valid ? count * 2 : 0 );
+      valid = valid && reader.array( bounds.data( ), count * 2 );
+
+      EventVec event;
+      event.reserve( bounds.size( ) / 2 );
+      for( uint64_t j = 0; j < bounds.size( ); j += 2 )
+        event.push_back( std::make_pair( bounds[ j ], bounds[ j + 1 ]));
+
+      events.emplace_back( name, std::move( event ));
+    }
+
+    const uint64_t numChunks =
+        ( fileLayout.numSpikes + fileLayout.chunkSize - 1 ) / fileLayout.chunkSize;
+
+    fileLayout.chunkTableOffset = reader.offset( );
+    fileLayout.summaryOffset = fileLayout.chunkTableOffset + sizeof( float ) * numChunks;
+    fileLayout.timesOffset = fileLayout.summaryOffset +
+                             sizeof( uint32_t ) * fileLayout.summaryBins;
+    fileLayout.gidsOffset = fileLayout.timesOffset +
+                            sizeof( float ) * fileLayout.numSpikes;
+
+    valid = valid && fileLayout.gidsOffset +
+            sizeof( uint32_t ) * fileLayout.numSpikes == static_cast< uint64_t >( size );
+
+    if( !valid )
+    {
+      file.unmap( const_cast< uchar* >( mapped ));
+      std::cerr << "Discarding corrupt spike cache " << file.fileName( ).toStdString( )
+                << " " << __FILE__ << ":" << __LINE__ << std::endl;
+      return nullptr;
+    }
+
+    if( layout )
+      *layout = fileLayout;
+
+    auto data = new simil::SpikeData( );
+
+    data->setGids( TGIDSet( gids.begin( ), gids.end( )));
+
+    TPosVect positionVect;
+    positionVect.reserve( numGids );
+    for( uint64_t i = 0; i < numGids; ++i )
+      positionVect.emplace_back( positions[ i * 3 ], positions[ i * 3 + 1 ],
+                                 positions[ i * 3 + 2 ]);
+    data->setPositions( positionVect );
+
+    if( withSpikes )
+    {
+      // Built straight from the mapping, the arrays may be unaligned.
+      const uchar* timePtr = mapped + fileLayout.timesOffset;
+      const uchar* gidPtr = mapped + fileLayout.gidsOffset;
+
+      TSpikes spikes;
+      spikes.reserve( fileLayout.numSpikes );
+      for( uint64_t i = 0; i < fileLayout.numSpikes; ++i )
+      {
+        float time;
+        uint32_t gid;
+        std::memcpy( &time, timePtr + i * sizeof( float ), sizeof( float ));
+        std::memcpy( &gid, gidPtr + i * sizeof( uint32_t ), sizeof( uint32_t ));
+        spikes.emplace_back( time, gid );
+      }
+      data->addSpikes( spikes );
+    }
+
+    file.unmap( const_cast< uchar* >( mapped ));
+
+    // Keeps recently used files out of the eviction.
+    file.setFileTime( QDateTime::currentDateTime( ),
+                      QFileDevice::FileModificationTime );
+
+    data->setStartTime( fileLayout.startTime );
+    data->setEndTime( fileLayout.endTime );
+
+    auto subsetEvents = data->subsetsEvents( );
+    for( const auto& subset : subsets )
+      subsetEvents->addSubset( subset.first, subset.second );
+    for( const auto& event : events )
+      subsetEvents->addEvent( event.first, event.second );
+
+    return data;
+  }
+
+  bool SpikeCache::write( simil::SpikeData* data,
+                          const std::string& fileName,
+                          simil::TDataType dataType,
+                          const std::string& report )
+  {
+    const std::string key = _key( fileName, dataType, report );
+    const QString path = QString::fromStdString( _cacheFile( key ));
+
+    QDir( ).mkpath( QFileInfo( path ).path( ));
+
+    // Written to a temporary file and renamed, so concurrent readers never
+    // map a partial cache.
+    QSaveFile file( path );
+    if( !file.open( QIODevice::WriteOnly ))
+    {
+      std::cerr << "Unable to write spike cache " << path.toStdString( )
+                << " " << __FILE__ << ":" << __LINE__ << std::endl;
+      return false;
+    }
+
+    const auto& gids = data->gids( );
+    const auto& positions = data->positions( );
+    const auto& spikes = data->spikes( );
+    auto subsetEvents = data->subsetsEvents( );
+
+    const auto subsets = subsetEvents->subsets( );
+    const auto events = subsetEvents->events( );
+
+    const float startTime = data->startTime( );
+    const float endTime = data->endTime( );
+
+    file.write( SPIKE_CACHE_MAGIC, 8 );
+    writeValue( file, SPIKE_CACHE_VERSION );
+    writeString( file, key );
+
+    writeValue( file, startTime );
+    writeValue( file, endTime );
+    writeValue( file, static_cast< uint64_t >( gids.size( )));
+    writeValue( file, static_cast< uint64_t >( spikes.size( )));
+    writeValue( file, static_cast< uint64_t >(
+        std::distance( subsets.first, subsets.second )));
+    writeValue( file, static_cast< uint64_t >(
+        std::distance( events.first, events.second )));
+    writeValue( file, SPIKE_CACHE_CHUNK_SIZE );
+    writeValue( file, SPIKE_CACHE_SUMMARY_BINS );
+
+    const std::vector< uint32_t > gidVect( gids.begin( ), gids.end( ));
+    writeArray( file, gidVect.data( ), gidVect.size( ));
+
+    std::vector< float > positionVect;
+    positionVect.reserve( positions.size( ) * 3 );
+    for( const auto& position : positions )
+    {
+      positionVect.push_back( position.x( ));
+      positionVect.push_back( position.y( ));
+      positionVect.push_back( position.z( ));
+    }
+    // Keep the array length in sync with the gid count.
+    positionVect.resize( gids.size( ) * 3, 0.0f );
+    writeArray( file, positionVect.data( ), positionVect.size( ));
+
+    for( auto it = subsets.first; it != subsets.second; ++it )
+    {
+      writeString( file, it->first );
+      writeValue( file, static_cast< uint64_t >( it->second.size( )));
+      writeArray( file, it->second.data( ), it->second.size( ));
+    }
+
+    for( auto it = events.first; it != events.second; ++it )
+    {
+      writeString( file, it->first );
+      writeValue( file, static_cast< uint64_t >( it->second.size( )));
+      for( const auto& event : it->second )
+      {
+        writeValue( file, event.first );
+        writeValue( file, event.second );
+      }
+    }
+
+    // Small tables first, so streaming readers only map the spike arrays.
+    std::vector< float > chunkFirstTimes;
+    for( uint64_t i = 0; i < spikes.size( ); i += SPIKE_CACHE_CHUNK_SIZE )
+      chunkFirstTimes.push_back( spikes[ i ].first );
+    writeArray( file, chunkFirstTimes.data( ), chunkFirstTimes.size( ));
+
+    std::vector< uint32_t > summary( SPIKE_CACHE_SUMMARY_BINS, 0 );
+    const float invTotal = endTime > startTime ? 1.0f / ( endTime - startTime ) : 0.0f;
+    for( const auto& spike : spikes )
+    {
+      const float percentage =
+          std::max( 0.0f, std::min( 1.0f, ( spike.first - startTime ) * invTotal ));
+      const uint32_t bin = std::min( SPIKE_CACHE_SUMMARY_BINS - 1,
+          static_cast< uint32_t >( percentage * SPIKE_CACHE_SUMMARY_BINS ));
+      ++summary[ bin ];
+    }
+    writeArray( file, summary.data( ), summary.size( ));
+
+    // Split in blocks to avoid a full copy of the spikes.
+    std::vector< float > times;
+    for( uint64_t i = 0; i < spikes.size( ); i += SPIKE_CACHE_CHUNK_SIZE )
+    {
+      const uint64_t end = std::min< uint64_t >( spikes.size( ), i + SPIKE_CACHE_CHUNK_SIZE );
+      times.clear( );
+      for( uint64_t j = i; j < end; ++j )
+        times.push_back( spikes[ j ].first );
+      writeArray( file, times.data( ), times.size( ));
+    }
+
+    std::vector< uint32_t > spikeGids;
+    for( uint64_t i = 0; i < spikes.size( ); i += SPIKE_CACHE_CHUNK_SIZE )
+    {
+      const uint64_t end = std::min< uint64_t >( spikes.size( ), i + SPIKE_CACHE_CHUNK_SIZE );
+      spikeGids.clear( );
+      for( uint64_t j = i; j < end; ++j )
+        spikeGids.push_back( spikes[ j ].second );
+      writeArray( file, spikeGids.data( ), spikeGids.size( ));
+    }
+
+    if( !file.commit( ))
+    {
+      std::cerr << "Unable to write spike cache " << path.toStdString( )
+                << " " << __FILE__ << ":" << __LINE__ << std::endl;
+      return false;
+    }
+
+    evict( QFileInfo( path ).path( ), QFileInfo( path ).absoluteFilePath( ));
+
+    return true;
+  }
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2015-2020 VG-Lab/URJC.
+ *
+ * Authors: Sergio E. Galindo <sergio.galindo@urjc.es>
+ *
+ * This file is part of ViSimpl <https://github.com/vg-lab/visimpl>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef __VISIMPL_SPIKECACHE__
+#define __VISIMPL_SPIKECACHE__
+
+#include "types.h"
+
+#include <simil/simil.h>
+#include <sumrice/api.h>
+
+#include <string>
+
+namespace visimpl
+{
+  /*! \brief On-disk binary cache of parsed spike data.
+   *
+   * After a dataset is parsed once, its gids, positions, time sorted spikes
+   * and subset/event tables are written to a versioned binary file in the
+   * user cache directory, or VISIMPL_SPIKE_CACHE_DIR when set. The file is
+   * keyed by the names, sizes, modification times and sampled contents of
+   * the files the data is read from, not by their paths, so copies of a
+   * dataset that keep their times share it; for BlueConfig datasets those
+   * are the spike and circuit files it references.
+   * Later opens read that file instead of parsing the source again. simil
+   * containers own their storage, so read( ) copies the arrays out of the
+   * mapping into a new SpikeData; the saving is the parsing and sorting,
+   * not the copy or the memory. The least recently used files are evicted
+   * once the directory exceeds VISIMPL_SPIKE_CACHE_LIMIT_GB (20 GB by
+   * default).
+   *
+   * The spike arrays are stored last, preceded by a per-chunk time table and
+   * a fixed resolution activity summary, so they can also be streamed.
+   * SpikeStream reads them in place from the mapping, which is the only
+   * path whose pages are shared between processes.
+   *
+   * Setting VISIMPL_DISABLE_SPIKE_CACHE in the environment bypasses it.
+   */
+  class SUMRICE_API SpikeCache
+  {
+  public:
+
+    //! Location of the spike arrays and tables inside a cache file.
+    struct Layout
+    {
+      float startTime = 0.0f;
+      float endTime = 0.0f;
+      uint64_t numSpikes = 0;
+      uint64_t chunkSize = 0;
+      uint32_t summaryBins = 0;
+      uint64_t chunkTableOffset = 0;
+      uint64_t summaryOffset = 0;
+      uint64_t timesOffset = 0;
+      uint64_t gidsOffset = 0;
+    };
+
+    /*! \brief Loads the spike data from the cache if present and up to date,
+     * otherwise parses the source and stores the result.
+     * \param fromCache optionally returns whether the cache was used.
+     */
+    static simil::SpikeData* load( const std::string& fileName,
+                                   simil::TDataType dataType,
+                                   const std::string& report,
+                                   bool* fromCache = nullptr );
+
+    /*! \brief Returns the cached data or nullptr when missing or stale.
+     * \param withSpikes when false only the network, subsets and events are
+     * read, the spikes are left for SpikeStream.
+     * \param layout optionally returns the file layout.
+     */
+    static simil::SpikeData* read( const std::string& fileName,
+                                   simil::TDataType dataType,
+                                   const std::string& report,
+                                   bool withSpikes = true,
+                                   Layout* layout = nullptr );
+
+    //! Reads only the fixed size header of an up to date cache file.
+    static bool header( const std::string& fileName,
+                        simil::TDataType dataType,
+                        const std::string& report,
+                        Layout& layout );
+
+    static bool write( simil::SpikeData* data,
+                       const std::string& fileName,
+                       simil::TDataType dataType,
+                       const std::string& report );
+
+    static bool enabled( void );
+
+    static std::string cacheFile( const std::string& fileName,
+                                  simil::TDataType dataType,
+                                  const std::string& report );
+
+  protected:
+
+    static std::string _key( const std::string& fileName,
+                             simil::TDataType dataType,
+                             const std::string& report );
+
+    static std::string _cacheFile( const std::string& key );
+  };
+}
+
+#endif /* __VISIMPL_SPIKECACHE__ */
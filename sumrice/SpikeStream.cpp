@@ -0,0 +1,350 @@
+/*
+ * Copyright (c) 2015-2020 VG-Lab/URJC.
+ *
+ * Authors: Sergio E. Galindo <sergio.galindo@urjc.es>
+ *
+ * This file is part of ViSimpl <https://github.com/vg-lab/visimpl>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "SpikeStream.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+namespace visimpl
+{
+  // Reports below this many spikes are loaded in memory, unless streaming is
+  // forced through VISIMPL_STREAM_SPIKES.
+  static const uint64_t SPIKE_STREAM_THRESHOLD = 1ull << 29;
+
+  SpikeStream* SpikeStream::open( const std::string& fileName,
+                                  simil::TDataType dataType,
+                                  const std::string& report,
+                                  simil::SpikeData** network )
+  {
+    if( !SpikeCache::enabled( ))
+      return nullptr;
+
+    const char* streamEnv = std::getenv( "VISIMPL_STREAM_SPIKES" );
+    if( streamEnv && std::string( streamEnv ) == "0" )
+      return nullptr;
+
+    // Small reports are left to SpikeCache::load, without reading their
+    // network here first.
+    SpikeCache::Layout layout;
+    if( !SpikeCache::header( fileName, dataType, report, layout ) ||
+        ( !streamEnv && layout.numSpikes < SPIKE_STREAM_THRESHOLD ))
+      return nullptr;
+
+    simil::SpikeData* data =
+        SpikeCache::read( fileName, dataType, report, false, &layout );
+
+    if( !data )
+      return nullptr;
+
+    auto stream = new SpikeStream(
+        QString::fromStdString( SpikeCache::cacheFile( fileName, dataType, report )),
+        layout );
+
+    if( !stream->_open( ))
+    {
+      delete stream;
+      delete data;
+      return nullptr;
+    }
+
+    *network = data;
+    return stream;
+  }
+
+  SpikeStream::SpikeStream( const QString& path,
+                            const SpikeCache::Layout& layout )
+  : _file( path )
+  , _layout( layout )
+  , _useCounter( 0 )
+  , _maxResidentChunks( 8 )
+  , _prefetchWindow( 1.0f )
+  , _prefetchTime( 0.0f )
+  , _prefetchRequested( false )
+  , _stop( false )
+  { }
+
+  SpikeStream::~SpikeStream( void )
+  {
+    {
+      std::lock_guard< std::mutex > lock( _mutex );
+      _stop = true;
+    }
+    _prefetchCondition.notify_all( );
+
+    if( _prefetchThread.joinable( ))
+      _prefetchThread.join( );
+
+    for( auto& chunk : _resident )
+    {
+      _file.unmap( chunk.second.times );
+      _file.unmap( chunk.second.gids );
+    }
+  }
+
+  bool SpikeStream::_open( void )
+  {
+    if( !_file.open( QIODevice::ReadOnly ))
+      return false;
+
+    const uint64_t numChunks =
+        ( _layout.numSpikes + _layout.chunkSize - 1 ) / _layout.chunkSize;
+
+    _chunkFirstTimes.resize( numChunks );
+    _summary.resize( _layout.summaryBins );
+
+    if( !_file.seek( _layout.chunkTableOffset ) ||
+        _file.read( reinterpret_cast< char* >( _chunkFirstTimes.data( )),
+                    sizeof( float ) * numChunks ) !=
+            static_cast< qint64 >( sizeof( float ) * numChunks ) ||
+        _file.read( reinterpret_cast< char* >( _summary.data( )),
+                    sizeof( uint32_t ) * _summary.size( )) !=
+            static_cast< qint64 >( sizeof( uint32_t ) * _summary.size( )))
+    {
+      std::cerr << "Unable to read spike stream tables "
+                << __FILE__ << ":" << __LINE__ << std::endl;
+      return false;
+    }
+
+    _prefetchThread = std::thread( &SpikeStream::_prefetchLoop, this );
+
+    return true;
+  }
+
+  SpikeStream::Chunk& SpikeStream::_map( uint64_t index )
+  {
+    auto resident = _resident.find( index );
+    if( resident == _resident.end( ))
+    {
+      _evict( );
+
+      const uint64_t first = index * _layout.chunkSize;
+      const uint64_t count = std::min( _layout.chunkSize,
+                                       _layout.numSpikes - first );
+
+      Chunk chunk;
+      chunk.times = _file.map( _layout.timesOffset + sizeof( float ) * first,
+                               sizeof( float ) * count );
+      chunk.gids = _file.map( _layout.gidsOffset + sizeof( uint32_t ) * first,
+                              sizeof( uint32_t ) * count );
+      chunk.count = ( chunk.times && chunk.gids ) ? count : 0;
+      chunk.pins = 0;
+
+      if( !chunk.count )
+        std::cerr << "Unable to map spike chunk " << index << " "
+                  << __FILE__ << ":" << __LINE__ << std::endl;
+
+      resident = _resident.insert( std::make_pair( index, chunk )).first;
+    }
+
+    resident->second.lastUse = ++_useCounter;
+    return resident->second;
+  }
+
+  void SpikeStream::_evict( void )
+  {
+    while( _resident.size( ) >= _maxResidentChunks )
+    {
+      auto oldest = _resident.end( );
+      for( auto it = _resident.begin( ); it != _resident.end( ); ++it )
+      {
+        if( it->second.pins == 0 &&
+            ( oldest == _resident.end( ) ||
+              it->second.lastUse < oldest->second.lastUse ))
+          oldest = it;
+      }
+
+      if( oldest == _resident.end( ))
+        return;
+
+      if( oldest->second.times )
+        _file.unmap( oldest->second.times );
+      if( oldest->second.gids )
+        _file.unmap( oldest->second.gids );
+
+      _resident.erase( oldest );
+    }
+  }
+
+  uint64_t SpikeStream::_chunkAt( float time ) const
+  {
+    // Equal timestamps may span a chunk boundary, so the scan starts at the
+    // last chunk beginning strictly before time, not at one beginning on it.
+    auto it = std::lower_bound( _chunkFirstTimes.begin( ),
+                                _chunkFirstTimes.end( ), time );
+
+    return it == _chunkFirstTimes.begin( ) ?
+        0 : std::distance( _chunkFirstTimes.begin( ), it ) - 1;
+  }
+
+  simil::SpikesCRange SpikeStream::spikesBetween( float begin, float end,
+                                                  TSpikes& buffer )
+  {
+    buffer.clear( );
+
+    std::lock_guard< std::mutex > lock( _mutex );
+
+    for( uint64_t index = _chunkAt( begin ); index < _chunkFirstTimes.size( ) &&
+         _chunkFirstTimes[ index ] < end; ++index )
+    {
+      const Chunk& chunk = _map( index );
+
+      const float* times = reinterpret_cast< const float* >( chunk.times );
+      const uint32_t* gids = reinterpret_cast< const uint32_t* >( chunk.gids );
+
+      const float* first = std::lower_bound( times, times + chunk.count, begin );
+      const float* last = std::lower_bound( first, times + chunk.count, end );
+
+      for( const float* time = first; time != last; ++time )
+        buffer.emplace_back( *time, gids[ time - times ]);
+    }
+
+    return std::make_pair( buffer.cbegin( ), buffer.cend( ));
+  }
+
+  void SpikeStream::prefetch( float time )
+  {
+    {
+      std::lock_guard< std::mutex > lock( _mutex );
+      _prefetchTime = time;
+      _prefetchRequested = true;
+    }
+    _prefetchCondition.notify_one( );
+  }
+
+  void SpikeStream::_prefetchLoop( void )
+  {
+    const long pageSize = 4096;
+
+    std::unique_lock< std::mutex > lock( _mutex );
+
+    while( !_stop )
+    {
+      _prefetchCondition.wait( lock, [ this ]
+                               { return _stop || _prefetchRequested; });
+      if( _stop )
+        break;
+
+      _prefetchRequested = false;
+
+      const float begin = _prefetchTime;
+      const float end = begin + _prefetchWindow;
+
+      // Never claim more than half the resident budget for read ahead.
+      const uint64_t maxChunks = std::max( 1u, _maxResidentChunks / 2 );
+
+      uint64_t index = _chunkAt( begin );
+      for( uint64_t loaded = 0; index < _chunkFirstTimes.size( ) &&
+           _chunkFirstTimes[ index ] < end && loaded < maxChunks;
+           ++index, ++loaded )
+      {
+        Chunk& chunk = _map( index );
+        ++chunk.pins;
+
+        const uchar* times = chunk.times;
+        const uchar* gids = chunk.gids;
+        const uint64_t bytes = chunk.count * sizeof( float );
+
+        // Fault the pages in without holding the lock.
+        lock.unlock( );
+
+        volatile uchar sink = 0;
+        for( uint64_t offset = 0; offset < bytes; offset += pageSize )
+          sink ^= times[ offset ] ^ gids[ offset ];
+        ( void ) sink;
+
+        lock.lock( );
+        --_resident[ index ].pins;
+
+        if( _stop || _prefetchRequested )
+          break;
+      }
+    }
+  }
+
+  void SpikeStream::forEachChunk(
+      const std::function< bool( const float*, const uint32_t*, uint64_t )>& visitor )
+  {
+    bool proceed = true;
+    for( uint64_t index = 0; proceed && index < _chunkFirstTimes.size( ); ++index )
+    {
+      std::unique_lock< std::mutex > lock( _mutex );
+
+      Chunk& chunk = _map( index );
+      ++chunk.pins;
+
+      const float* times = reinterpret_cast< const float* >( chunk.times );
+      const uint32_t* gids = reinterpret_cast< const uint32_t* >( chunk.gids );
+      const uint64_t count = chunk.count;
+
+      lock.unlock( );
+      proceed = visitor( times, gids, count );
+      lock.lock( );
+
+      --_resident[ index ].pins;
+    }
+  }
+
+  void SpikeStream::prefetchWindow( float window )
+  {
+    std::lock_guard< std::mutex > lock( _mutex );
+    _prefetchWindow = std::max( 0.0f, window );
+  }
+
+  float SpikeStream::prefetchWindow( void ) const
+  {
+    return _prefetchWindow;
+  }
+
+  void SpikeStream::maxResidentChunks( unsigned int chunks )
+  {
+    std::lock_guard< std::mutex > lock( _mutex );
+    _maxResidentChunks = std::max( 2u, chunks );
+    _evict( );
+  }
+
+  unsigned int SpikeStream::maxResidentChunks( void ) const
+  {
+    return _maxResidentChunks;
+  }
+
+  const std::vector< uint32_t >& SpikeStream::activitySummary( void ) const
+  {
+    return _summary;
+  }
+
+  float SpikeStream::startTime( void ) const
+  {
+    return _layout.startTime;
+  }
+
+  float SpikeStream::endTime( void ) const
+  {
+    return _layout.endTime;
+  }
+
+  uint64_t SpikeStream::size( void ) const
+  {
+    return _layout.numSpikes;
+  }
+}
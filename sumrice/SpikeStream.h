@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2015-2020 VG-Lab/URJC.
+ *
+ * Authors: Sergio E. Galindo <sergio.galindo@urjc.es>
+ *
+ * This file is part of ViSimpl <https://github.com/vg-lab/visimpl>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef __VISIMPL_SPIKESTREAM__
+#define __VISIMPL_SPIKESTREAM__
+
+#include "types.h"
+#include "SpikeCache.h"
+
+#include <simil/simil.h>
+#include <sumrice/api.h>
+
+#include <QFile>
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace visimpl
+{
+  /*! \brief Out-of-core access to the spikes of a SpikeCache file.
+   *
+   * Spikes are mapped in fixed size, time ordered chunks. Only a bounded
+   * number of chunks stays mapped, the least recently used ones are unmapped
+   * first, and a worker thread faults in the chunks ahead of the playhead.
+   * Whole range statistics come from the precomputed activity summary.
+   */
+  class SUMRICE_API SpikeStream
+  {
+  public:
+
+    /*! \brief Opens the cache of a source for streaming.
+     * Returns nullptr when there is no valid cache or the report is small
+     * enough to be loaded in memory. Otherwise network returns the data
+     * without spikes.
+     */
+    static SpikeStream* open( const std::string& fileName,
+                              simil::TDataType dataType,
+                              const std::string& report,
+                              simil::SpikeData** network );
+
+    ~SpikeStream( void );
+
+    /*! \brief Copies the spikes in [begin, end) into buffer.
+     * The returned range points into buffer.
+     */
+    simil::SpikesCRange spikesBetween( float begin, float end,
+                                       TSpikes& buffer );
+
+    //! Requests the chunks in [time, time + prefetchWindow) to be loaded.
+    void prefetch( float time );
+
+    void prefetchWindow( float window );
+    float prefetchWindow( void ) const;
+
+    void maxResidentChunks( unsigned int chunks );
+    unsigned int maxResidentChunks( void ) const;
+
+    //! Sequentially visits every spike, chunk by chunk, until the visitor
+    //! returns false.
+    void forEachChunk( const std::function< bool( const float* times,
+                                                  const uint32_t* gids,
+                                                  uint64_t count )>& visitor );
+
+    const std::vector< uint32_t >& activitySummary( void ) const;
+
+    float startTime( void ) const;
+    float endTime( void ) const;
+    uint64_t size( void ) const;
+
+  protected:
+
+    struct Chunk
+    {
+      uchar* times;
+      uchar* gids;
+      uint64_t count;
+      uint64_t lastUse;
+      unsigned int pins;
+    };
+
+    SpikeStream( const QString& path, const SpikeCache::Layout& layout );
+
+    bool _open( void );
+
+    Chunk& _map( uint64_t index );
+    void _evict( void );
+    uint64_t _chunkAt( float time ) const;
+
+    void _prefetchLoop( void );
+
+    QFile _file;
+    SpikeCache::Layout _layout;
+
+    std::vector< float > _chunkFirstTimes;
+    std::vector< uint32_t > _summary;
+
+    std::unordered_map< uint64_t, Chunk > _resident;
+    uint64_t _useCounter;
+    unsigned int _maxResidentChunks;
+
+    float _prefetchWindow;
+    float _prefetchTime;
+    bool _prefetchRequested;
+    bool _stop;
+
+    std::mutex _mutex;
+    std::condition_variable _prefetchCondition;
+    std::thread _prefetchThread;
+  };
+}
+
+#endif /* __VISIMPL_SPIKESTREAM__ */
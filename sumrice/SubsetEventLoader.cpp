@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2015-2020 VG-Lab/URJC.
+ *
+ * Authors: Sergio E. Galindo <sergio.galindo@urjc.es>
+ *
+ * This file is part of ViSimpl <https://github.com/vg-lab/visimpl>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+#include "SubsetEventLoader.h"
+
+#include <QFileInfo>
+
+#include <algorithm>
+#include <iterator>
+#include <thread>
+
+namespace visimpl
+{
+  // Subsets converted before handing a batch to the GUI thread.
+  static const size_t SUBSET_BATCH_SIZE = 64;
+
+  SubsetEventLoader::SubsetEventLoader( QObject* parent_ )
+  : QObject( parent_ )
+  { }
+
+  SubsetEventLoader::~SubsetEventLoader( )
+  {
+    cancel( );
+  }
+
+  bool SubsetEventLoader::supported( const std::string& filePath_ )
+  {
+    const QString suffix =
+        QFileInfo( QString::fromStdString( filePath_ )).suffix( ).toLower( );
+
+    return suffix == "json" || suffix == "h5";
+  }
+
+  bool SubsetEventLoader::load( const std::string& filePath_, bool buildSubsets )
+  {
+    cancel( );
+
+    if( !supported( filePath_ ))
+      return false;
+
+    _filePath = filePath_;
+
+    _job = std::make_shared< Job >( );
+    _job->filePath = filePath_;
+    _job->buildSubsets = buildSubsets;
+    _job->manager.reset( new simil::SubsetEventManager( ));
+
+    std::thread( &SubsetEventLoader::_run, _job, this ).detach( );
+
+    return true;
+  }
+
+  bool SubsetEventLoader::loading( void ) const
+  {
+    return _job && _job->loading;
+  }
+
+  const std::string& SubsetEventLoader::filePath( void ) const
+  {
+    return _filePath;
+  }
+
+  std::vector< SubsetEventLoader::TSubset > SubsetEventLoader::takeSubsets( void )
+  {
+    std::vector< TSubset > result;
+    if( !_job )
+      return result;
+
+    std::lock_guard< std::mutex > lock( _job->readyMutex );
+    result.swap( _job->ready );
+
+    return result;
+  }
+
+  void SubsetEventLoader::merge( simil::SubsetEventManager* manager )
+  {
+    if( !manager || !_job || _job->loading || !_job->manager )
+      return;
+
+    auto& parsed = *_job->manager;
+
+    const auto targetSubsets = manager->subsets( );
+    const auto targetEvents = manager->events( );
+
+    if( targetSubsets.first == targetSubsets.second &&
+        targetEvents.first == targetEvents.second )
+    {
+      *manager = std::move( parsed );
+    }
+    else
+    {
+      const auto subsets = parsed.subsets( );
+      for( auto it = subsets.first; it != subsets.second; ++it )
+        manager->addSubset( it->first, it->second );
+
+      const auto events = parsed.events( );
+      for( auto it = events.first; it != events.second; ++it )
+        manager->addEvent( it->first, it->second );
+    }
+
+    // The worker is done with it, nothing else reads the parsed file.
+    _job->manager.reset( );
+  }
+
+  void SubsetEventLoader::cancel( void )
+  {
+    if( !_job )
+      return;
+
+    {
+      // Waits at most for a signal being emitted, never for the parsing.
+      std::lock_guard< std::mutex > lock( _job->signalMutex );
+      _job->cancelled = true;
+    }
+
+    _job.reset( );
+  }
+
+  void SubsetEventLoader::_run( std::shared_ptr< Job > job,
+                                SubsetEventLoader* loader )
+  {
+    QString errorText;
+
+    try
+    {
+      const QString suffix =
+          QFileInfo( QString::fromStdString( job->filePath )).suffix( ).toLower( );
+
+      if( suffix == "json" )
+        job->manager->loadJSON( job->filePath );
+      else
+        job->manager->loadH5( job->filePath );
+
+      if( job->buildSubsets )
+        _convertSubsets( *job, loader );
+    }
+    catch( const std::exception& e )
+    {
+      job->manager->clear( );
+      errorText = QString::fromLocal8Bit( e.what( ));
+    }
+
+    job->loading = false;
+
+    std::lock_guard< std::mutex > lock( job->signalMutex );
+    if( !job->cancelled )
+      emit loader->finished( errorText );
+  }
+
+  void SubsetEventLoader::_convertSubsets( Job& job, SubsetEventLoader* loader )
+  {
+    const auto subsets = job.manager->subsets( );
+
+    std::vector< decltype( subsets.first ) > iterators;
+    for( auto it = subsets.first; it != subsets.second; ++it )
+      iterators.push_back( it );
+
+    for( size_t first = 0; first < iterators.size( ) && !job.cancelled;
+         first += SUBSET_BATCH_SIZE )
+    {
+      const int count = static_cast< int >(
+          std::min( SUBSET_BATCH_SIZE, iterators.size( ) - first ));
+
+      std::vector< TSubset > batch( count );
+
+      // Subsets are independent, each one is hashed by its own thread.
+#ifdef VISIMPL_USE_OPENMP
+      #pragma omp parallel for schedule( dynamic )
+#endif
+      for( int i = 0; i < count; ++i )
+      {
+        const auto& subset = *iterators[ first + i ];
+
+        batch[ i ].first = subset.first;
+        batch[ i ].second = GIDUSet( subset.second.begin( ), subset.second.end( ));
+      }
+
+      {
+        std::lock_guard< std::mutex > lock( job.readyMutex );
+        std::move( batch.begin( ), batch.end( ), std::back_inserter( job.ready ));
+      }
+
+      std::lock_guard< std::mutex > lock( job.signalMutex );
+      if( !job.cancelled )
+        emit loader->subsetsReady( );
+    }
+  }
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2015-2020 VG-Lab/URJC.
+ *
+ * Authors: Sergio E. Galindo <sergio.galindo@urjc.es>
+ *
+ * This file is part of ViSimpl <https://github.com/vg-lab/visimpl>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef __VISIMPL_SUBSETEVENTLOADER__
+#define __VISIMPL_SUBSETEVENTLOADER__
+
+#include "types.h"
+
+#include <simil/simil.h>
+#include <sumrice/api.h>
+
+#include <QObject>
+#include <QString>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace visimpl
+{
+  /*! \brief Reads a subset/event file on a worker thread.
+   *
+   * The file is parsed into a private SubsetEventManager, then its subsets
+   * are converted to GID sets in parallel. Converted subsets are queued in
+   * batches that can be taken, without copying, as soon as subsetsReady is
+   * emitted, so views are populated incrementally. Once finished is emitted
+   * the parsed subsets and events can be merged into the application's
+   * manager.
+   *
+   * Cancelling never waits for the worker, it is left to finish on its own
+   * and its results and signals are dropped.
+   */
+  class SUMRICE_API SubsetEventLoader : public QObject
+  {
+    Q_OBJECT;
+
+  public:
+
+    typedef std::pair< std::string, GIDUSet > TSubset;
+
+    SubsetEventLoader( QObject* parent = nullptr );
+    virtual ~SubsetEventLoader( );
+
+    static bool supported( const std::string& filePath );
+
+    /*! \brief Starts loading the file, cancelling any previous load.
+     * \param buildSubsets whether to convert the subsets for takeSubsets.
+     * \return false if the file type is not supported.
+     */
+    bool load( const std::string& filePath, bool buildSubsets = true );
+
+    //! Abandons the current load and drops its pending subsets.
+    void cancel( void );
+
+    bool loading( void ) const;
+
+    const std::string& filePath( void ) const;
+
+    //! Moves out the subsets converted since the previous call.
+    std::vector< TSubset > takeSubsets( void );
+
+    /*! \brief Hands the parsed subsets and events to manager, once
+     * finished. They are moved if manager is empty and copied otherwise,
+     * the loader does not keep them.
+     */
+    void merge( simil::SubsetEventManager* manager );
+
+  signals:
+
+    void subsetsReady( void );
+    void finished( const QString& errorText );
+
+  protected:
+
+    //! A single load, shared with its worker, which may outlive the loader.
+    struct Job
+    {
+      std::string filePath;
+      bool buildSubsets = true;
+
+      std::unique_ptr< simil::SubsetEventManager > manager;
+
+      std::atomic< bool > loading{ true };
+      std::atomic< bool > cancelled{ false };
+
+      // Held while emitting, cancelling takes it so the worker never
+      // signals a loader that moved on or was destroyed.
+      std::mutex signalMutex;
+
+      std::mutex readyMutex;
+      std::vector< TSubset > ready;
+    };
+
+    static void _run( std::shared_ptr< Job > job, SubsetEventLoader* loader );
+    static void _convertSubsets( Job& job, SubsetEventLoader* loader );
+
+    std::string _filePath;
+
+    std::shared_ptr< Job > _job;
+  };
+}
+
+#endif /* __VISIMPL_SUBSETEVENTLOADER__ */
@@ -32,11 +32,18 @@
 #include <QApplication>
 #include <QGroupBox>
 
+#include <algorithm>
+#include <iterator>
+#include <unordered_map>
+
 unsigned int visimpl::Selection::_counter = 0;
 
 constexpr unsigned int DEFAULT_BINS = 2500;
 constexpr float DEFAULT_ZOOM_FACTOR = 1.5f;
 
+// Widgets of rows scrolled away kept for the rows scrolling into view.
+constexpr unsigned int ROW_POOL_SIZE = 32;
+
 constexpr float DEFAULT_SCALE = 1.0f;
 constexpr float DEFAULT_SCALE_STEP = 0.3f;
 
@@ -74,6 +81,8 @@ namespace visimpl
   , _simData( nullptr )
   , _spikeReport( nullptr )
   , _player( nullptr )
+  , _spikeStream( nullptr )
+  , _analysisCache( nullptr )
   , _mainHistogram( nullptr )
   , _focusedHistogram( nullptr )
   , _mousePressed( false )
@@ -82,6 +91,7 @@ namespace visimpl
   , _colorScaleGlobal( visimpl::T_COLOR_LOGARITHMIC )
   , _colorLocal( 0, 0, 128, 50 )
   , _colorGlobal( 255, 0, 0, 100 )
+  , _nextGridRow( 0 )
   , _focusWidget( nullptr )
   , _spinBoxScaleHorizontal( nullptr )
   , _spinBoxScaleVertical( nullptr )
@@ -98,6 +108,7 @@ namespace visimpl
   , _splitHorizEvents( nullptr )
   , _splitHorizHisto( nullptr )
   , _maxNumEvents( 8 )
+  , _nextRowId( 0 )
   , _syncScrollsHorizontally( true )
   , _syncScrollsVertically( true )
   , _heightPerRow( 50 )
@@ -119,6 +130,9 @@ namespace visimpl
   , _autoNameSelection( false )
   , _fillPlots( true )
   , _defaultCorrelationDeltaTime( 0.125f )
+  , _rebuildStop( false )
+  , _rebuildGeneration( 0 )
+  , _rebuildTotal( 0 )
   {
     setMouseTracking( true );
 
@@ -136,6 +150,30 @@ namespace visimpl
       _layoutMain->addWidget(_splitVertEventsHisto );
     }
 
+    _releaseTimer.setSingleShot( true );
+    _releaseTimer.setInterval( 250 );
+    connect( &_releaseTimer, SIGNAL( timeout()),
+             this, SLOT( _releaseHiddenRows()));
+
+    _viewportTimer.setSingleShot( true );
+    _viewportTimer.setInterval( 0 );
+    connect( &_viewportTimer, SIGNAL( timeout()),
+             this, SLOT( _showViewportRows()));
+
+    _requestTimer.setSingleShot( true );
+    _requestTimer.setInterval( 0 );
+    connect( &_requestTimer, SIGNAL( timeout()),
+             this, SLOT( _buildRequestedRows()));
+
+    _parametersTimer.setSingleShot( true );
+    _parametersTimer.setInterval( 300 );
+    connect( &_parametersTimer, SIGNAL( timeout()),
+             this, SLOT( _applyParameters()));
+
+    // Rows are computed by the rebuild worker, published on the GUI thread.
+    connect( this, SIGNAL( _rowsRebuilt()),
+             this, SLOT( _publishRebuiltRows()), Qt::QueuedConnection );
+
   #ifdef VISIMPL_USE_ZEROEQ
 
     _insertionTimer.setSingleShot( false );
@@ -152,6 +190,20 @@ namespace visimpl
         scoop::ColorPalette::ColorBrewerQualitative::Set1, 9 );
   }
 
+  Summary::~Summary( )
+  {
+    {
+      std::lock_guard< std::mutex > lock( _rebuildMutex );
+      _rebuildStop = true;
+    }
+    ++_rebuildGeneration;
+    _rebuildCondition.notify_one();
+
+    // Only waits for the check in progress of a running job.
+    if( _rebuildThread.joinable() )
+      _rebuildThread.join();
+  }
+
   void Summary::Init( simil::SimulationData* data_ )
   {
     _simData = data_;
@@ -269,6 +321,17 @@ namespace visimpl
       connect( _scrollHistoLabels->verticalScrollBar(), SIGNAL( actionTriggered( int )),
                this, SLOT( moveVertScrollSync( int )));
 
+      connect( _scrollHistogram->verticalScrollBar(), SIGNAL( valueChanged( int )),
+               &_releaseTimer, SLOT( start( )));
+
+      // Scrolling, resizing the viewport or adding rows brings new rows
+      // into view.
+      connect( _scrollHistogram->verticalScrollBar(), SIGNAL( valueChanged( int )),
+               this, SLOT( _showViewportRows( )));
+
+      connect( _scrollHistogram->verticalScrollBar(), SIGNAL( rangeChanged( int, int )),
+               this, SLOT( _showViewportRows( )));
+
       _splitHorizEvents = new QSplitter( Qt::Horizontal );
       _splitHorizHisto = new QSplitter( Qt::Horizontal );
 
@@ -482,6 +545,14 @@ namespace visimpl
     connect( _spinBoxZoomFactor, SIGNAL( editingFinished( void )),
              this,  SLOT( zoomFactorChanged( void )));
 
+    // Spinning the controls only restarts the timer, the rows are rebuilt
+    // once the values settle.
+    connect( _spinBoxBins, SIGNAL( valueChanged( int )),
+             &_parametersTimer, SLOT( start( void )));
+
+    connect( _spinBoxZoomFactor, SIGNAL( valueChanged( double )),
+             &_parametersTimer, SLOT( start( void )));
+
     connect( gridSpinBox, SIGNAL( valueChanged( int )),
              this, SLOT( gridLinesNumber( int )));
 
@@ -511,6 +582,8 @@ namespace visimpl
     _mainHistogram->firstHistogram( true );
     _mainHistogram->setMinimumWidth( _sizeChartHorizontal );
     _mainHistogram->simPlayer( _player );
+    _mainHistogram->spikeStream( _spikeStream );
+    _mainHistogram->analysisCache( _analysisCache );
 
     TColorMapper colorMapper;
     colorMapper.Insert( 0.0f, glm::vec4( 157, 206, 111, 255 ));
@@ -544,6 +617,11 @@ namespace visimpl
 
       HistogramRow mainRow;
 
+      mainRow.id = _nextRowId++;
+      mainRow.name = text.toStdString();
+      mainRow.gids = std::make_shared< const GIDUSet >( );
+      mainRow.size = _gids.size();
+      mainRow.gridRow = _nextGridRow++;
       mainRow.histogram = _mainHistogram;
       mainRow.histogram->_events = &_events;
       mainRow.histogram->name( text.toStdString() );
@@ -554,9 +632,9 @@ namespace visimpl
       mainRow.label->setMinimumHeight( _heightPerRow );
       mainRow.label->setMaximumHeight( _heightPerRow );
 
-      const unsigned int row = _histogramWidgets.size();
-      _layoutHistoLabels->addWidget( mainRow.label, row , 0, 1, 1 );
-      _layoutHistograms->addWidget( _mainHistogram, row, 1, 1, _summaryColumns );
+      _reserveRow( mainRow );
+      _layoutHistoLabels->addWidget( mainRow.label, mainRow.gridRow, 0, 1, 1 );
+      _layoutHistograms->addWidget( _mainHistogram, mainRow.gridRow, 1, 1, _summaryColumns );
 
       _histogramRows.push_back( mainRow );
       _histogramWidgets.push_back( _mainHistogram );
@@ -598,6 +676,7 @@ namespace visimpl
         timeFrame.name = it->first;
         timeFrame.visible = true;
 
+        std::vector< std::pair< float, float >> chunks;
         for( auto time : it->second )
         {
 
@@ -609,9 +688,9 @@ namespace visimpl
               std::min( 1.0f,
                         ( time.second - _spikeReport->startTime()) * invTotal);
 
-          timeFrame.percentages.push_back(
-              std::make_pair( startPercentage, endPercentage ));
+          chunks.push_back( std::make_pair( startPercentage, endPercentage ));
         }
+        timeFrame.percentages( std::move( chunks ));
 
         timeFrame.color = _eventsPalette.colors()[
           counter /* %  _eventsPalette.size() */ ];
@@ -637,6 +716,7 @@ namespace visimpl
         eventWidget->index( counter );
 
         EventRow eventrow;
+        eventrow.id = _nextRowId++;
         eventrow.widget = eventWidget;
         eventrow.label = label;
 
@@ -656,11 +736,15 @@ namespace visimpl
 
     for( auto it = subsets.first; it != subsets.second; ++it )
     {
-      GIDUSet subset( it->second.begin(), it->second.end());
-      insertSubset( it->first, subset );
+      insertSubset( it->first, GIDUSet( it->second.begin(), it->second.end()));
     }
   }
 
+  void Summary::importSubset( const std::string& name, GIDUSet&& subset )
+  {
+    insertSubset( name, std::move( subset ));
+  }
+
   void Summary::AddNewHistogram( const visimpl::Selection& selection
   #ifdef VISIMPL_USE_ZEROEQ
                          , bool deferred
@@ -694,13 +778,18 @@ namespace visimpl
   #ifdef VISIMPL_USE_ZEROEQ
   void Summary::deferredInsertion( void )
   {
-    if( _pendingSelections.size() > 0 )
-    {
-      auto selection = _pendingSelections.front();
-      _pendingSelections.pop_front();
+    if( _pendingSelections.empty() )
+      return;
+
+    // Every pending selection is handled in this tick, bursts from other
+    // applications do not queue up one timer interval each.
+    std::list< visimpl::Selection > batch;
+    batch.swap( _pendingSelections );
 
+    for( auto it = batch.begin(); it != batch.end(); )
+    {
       QString labelText =
-          QString( "Selection-").append( QString::number( selection.id ));
+          QString( "Selection-").append( QString::number( it->id ));
 
       bool ok = true;
       if ( !_autoNameSelection )
@@ -711,19 +800,27 @@ namespace visimpl
                                            labelText,
                                            &ok );
       if( !ok )
-        return;
-
-      selection.name = labelText.toStdString();
+      {
+        it = batch.erase( it );
+        continue;
+      }
 
-      insertSubset( selection );
+      it->name = labelText.toStdString();
+      ++it;
     }
 
+    // The rows in view are created once for the whole batch, and the data
+    // they request when painted is counted in a single pass.
+    for( auto& selection : batch )
+      insertSubset( selection.name, std::move( selection.gids ));
   }
 
   #endif
 
   void Summary::UpdateHistograms( void )
   {
+      _cancelRebuild( );
+
       for( auto histogram : _histogramWidgets )
       {
         histogram->Spikes(*_spikeReport);
@@ -738,12 +835,55 @@ namespace visimpl
 
   void Summary::insertSubset( const std::string& name, const GIDUSet& subset )
   {
+    insertSubset( name, GIDUSet( subset ));
+  }
+
+  void Summary::insertSubset( const std::string& name, GIDUSet&& subset )
+  {
+    if( subset.empty( ))
+      return;
+
     HistogramRow currentRow;
 
-    auto histogram = new visimpl::HistogramWidget( *_spikeReport );
+    currentRow.id = _nextRowId++;
+    currentRow.name = name;
+    currentRow.size = subset.size();
+    currentRow.gids = std::make_shared< const GIDUSet >( std::move( subset ));
+    currentRow.gridRow = _nextGridRow++;
+
+    // Widgets are only created for the rows near the viewport, the grid
+    // keeps the space of the rest.
+    _reserveRow( currentRow );
+
+    _histogramRows.push_back( currentRow );
+
+    _viewportTimer.start();
+  }
+
+  void Summary::_materializeRow( HistogramRow& row )
+  {
+    visimpl::HistogramWidget* histogram = nullptr;
+    QLabel* label = nullptr;
+
+    const bool recycled = !_rowPool.empty();
+    if( recycled )
+    {
+      histogram = _rowPool.back().first;
+      label = _rowPool.back().second;
+      _rowPool.pop_back();
+    }
+    else
+    {
+      histogram = new visimpl::HistogramWidget( *_spikeReport );
+      label = new QLabel( );
+    }
 
-    histogram->filteredGIDs( subset );
-    histogram->name( name );
+    // Settings may have changed while the widget was pooled, all of them
+    // are applied again.
+    histogram->spikeStream( _spikeStream );
+    histogram->analysisCache( _analysisCache );
+    histogram->filteredGIDs( row.gids );
+    histogram->name( row.name );
     histogram->colorMapper( _mainHistogram->colorMapper());
     histogram->colorScaleLocal( _colorScaleLocal );
     histogram->colorScaleGlobal( _colorScaleGlobal );
@@ -753,36 +893,45 @@ namespace visimpl
     histogram->representationMode( visimpl::T_REP_CURVE );
     histogram->regionWidth( _regionWidth );
     histogram->gridLinesNumber( _gridLinesNumber );
+    histogram->fillPlots( _fillPlots );
 
+    // Bins are counted by the rebuild worker once the row is painted.
+    histogram->lazy( true );
     histogram->init( _bins, _zoomFactor );
 
-    if( histogram->empty())
-    {
-      delete histogram;
-      return;
-    }
-
     histogram->setMinimumHeight( _heightPerRow );
     histogram->setMaximumHeight( _heightPerRow );
     histogram->setMinimumWidth( _sizeChartHorizontal );
 
     histogram->simPlayer( _player );
 
-    histogram->_events = &_events;
+    const auto firstVisible =
+        std::find_if( _histogramRows.begin(), _histogramRows.end(),
+                      []( const HistogramRow& r ){ return r.visible; });
+    histogram->firstHistogram( &( *firstVisible ) == &row );
 
-    currentRow.histogram = histogram;
-    currentRow.label = new QLabel( name.c_str());
-    currentRow.label->setMinimumWidth( _maxLabelWidth );
-    currentRow.label->setMaximumWidth( _maxLabelWidth );
-    currentRow.label->setMinimumHeight( _heightPerRow );
-    currentRow.label->setMaximumHeight( _heightPerRow );
-    currentRow.label->setToolTip( name.c_str());
+    row.histogram = histogram;
+    row.label = label;
+    row.label->setText( row.name.c_str());
+    row.label->setMinimumWidth( _maxLabelWidth );
+    row.label->setMaximumWidth( _maxLabelWidth );
+    row.label->setMinimumHeight( _heightPerRow );
+    row.label->setMaximumHeight( _heightPerRow );
+    row.label->setToolTip( row.name.c_str());
 
-    const unsigned int row = _histogramWidgets.size();
-    _layoutHistoLabels->addWidget( currentRow.label, row , 0, 1, 1 );
-    _layoutHistograms->addWidget( histogram, row, 1, 1, _summaryColumns );
+    _layoutHistoLabels->addWidget( row.label, row.gridRow, 0, 1, 1 );
+    _layoutHistograms->addWidget( histogram, row.gridRow, 1, 1, _summaryColumns );
 
-    _histogramRows.push_back( currentRow );
+    _histogramWidgets.push_back( histogram );
+
+    if( recycled )
+    {
+      row.label->show();
+      histogram->show();
+      return;
+    }
+
+    histogram->_events = &_events;
 
     histogram->mousePosition( &_lastMousePosition );
     histogram->regionPosition( &_regionPercentage );
@@ -799,9 +948,54 @@ namespace visimpl
     connect( histogram, SIGNAL( mouseModifierPressed( float, Qt::KeyboardModifiers )),
              this, SLOT( childHistogramClicked( float, Qt::KeyboardModifiers )));
 
-    _histogramWidgets.push_back( histogram );
+    connect( histogram, SIGNAL( dataRequested( )),
+             this, SLOT( _requestRowData( )));
+  }
 
-    update();
+  void Summary::_releaseRow( HistogramRow& row )
+  {
+    _layoutHistoLabels->removeWidget( row.label );
+    _layoutHistograms->removeWidget( row.histogram );
+
+    _histogramWidgets.erase( std::remove( _histogramWidgets.begin(),
+                                          _histogramWidgets.end(), row.histogram ),
+                             _histogramWidgets.end());
+
+    _requestedRows.erase( std::remove( _requestedRows.begin(),
+                                       _requestedRows.end(), row.histogram ),
+                          _requestedRows.end());
+
+    if( _rowPool.size() < ROW_POOL_SIZE )
+    {
+      // Pooled widgets keep no data of their row, a recycled one is built
+      // again for its new subset.
+      row.histogram->_dataPending = false;
+      row.histogram->releaseData();
+
+      row.label->hide();
+      row.histogram->hide();
+
+      _rowPool.emplace_back( row.histogram, row.label );
+    }
+    else
+    {
+      delete row.label;
+      delete row.histogram;
+    }
+
+    row.label = nullptr;
+    row.histogram = nullptr;
+  }
+
+  void Summary::_reserveRow( const HistogramRow& row )
+  {
+    if( !_layoutHistoLabels )
+      return;
+
+    const int height = row.visible ? _heightPerRow : 0;
+
+    _layoutHistoLabels->setRowMinimumHeight( row.gridRow, height );
+    _layoutHistograms->setRowMinimumHeight( row.gridRow, height );
   }
 
   void Summary::childHistogramPressed( const QPoint& position, float /*percentage*/ )
@@ -857,7 +1051,7 @@ namespace visimpl
     auto setPaintRegion = [&focusedHistogram](HistogramWidget *w)
     {
       w->paintRegion(w == focusedHistogram);
-      w->update();
+      w->updateOverlay();
     };
     std::for_each(_histogramWidgets.begin(), _histogramWidgets.end(), setPaintRegion);
   }
@@ -948,7 +1142,7 @@ namespace visimpl
 
     if( _stackType != T_STACK_EXPANDABLE )
     {
-      _mainHistogram->update();
+      _mainHistogram->updateOverlay();
       return;
     }
 
@@ -974,6 +1168,7 @@ namespace visimpl
 
           calculateRegionBounds();
 
+          _focusedHistogram->buildPendingData( );
           _focusWidget->viewRegion( *_focusedHistogram, _regionPercentage, _regionWidth );
           _focusWidget->update();
 
@@ -994,6 +1189,7 @@ namespace visimpl
 
           calculateRegionBounds();
 
+          _focusedHistogram->buildPendingData( );
           _focusWidget->viewRegion( *_focusedHistogram, _regionPercentage,
                                     _regionWidth );
           _focusWidget->update();
@@ -1045,7 +1241,7 @@ namespace visimpl
       auto setPaintRegion = [&focusedHistogram](HistogramWidget *w)
       {
         w->paintRegion(w == focusedHistogram);
-        w->update();
+        w->updateOverlay();
       };
       std::for_each(_histogramWidgets.begin(), _histogramWidgets.end(), setPaintRegion);
     }
@@ -1073,63 +1269,51 @@ namespace visimpl
 
   unsigned int Summary::histogramsNumber( void )
   {
+    // Rows far from the viewport have no widget.
+    if( _stackType == T_STACK_EXPANDABLE )
+      return _histogramRows.size();
+
     return _histogramWidgets.size();
   }
 
   void Summary::binsChanged( void )
   {
+    _applyParameters( );
+  }
+
+  void Summary::_applyParameters( void )
+  {
+    _parametersTimer.stop();
+
     const unsigned int binsNumber = _spinBoxBins->value();
-    bins( binsNumber );
+    const float zoom = _spinBoxZoomFactor->value();
+
+    if( binsNumber == _bins && zoom == _zoomFactor )
+      return;
+
+    _bins = binsNumber;
+    _zoomFactor = zoom;
+
+    _rebuildHistograms( );
   }
 
   void Summary::bins( int bins_ )
   {
     _bins = bins_;
 
-#ifdef VISIMPL_USE_OPENMP
-    #pragma omp parallel for
-    for( int i = 0; i < ( int )_histogramWidgets.size(); ++i )
-    {
-      auto histogram = _histogramWidgets[ i ];
-#else
-    for( auto histogram : _histogramWidgets )
-    {
-#endif
-      histogram->bins( _bins );
-      histogram->update();
-    }
-
-    if(_focusedHistogram)
-    {
-      _focusWidget->viewRegion( *_focusedHistogram, _regionPercentage, _regionWidth );
-      _focusWidget->update();
-    }
+    _rebuildHistograms( );
   }
 
   void Summary::zoomFactorChanged( void )
   {
-    double value = _spinBoxZoomFactor->value();
-
-    zoomFactor( value );
+    _applyParameters( );
   }
 
   void Summary::zoomFactor( double zoom )
   {
     _zoomFactor = zoom;
 
-#ifdef VISIMPL_USE_OPENMP
-    #pragma omp parallel for
-    for( int i = 0; i < static_cast<int>(_histogramWidgets.size()); ++i )
-    {
-      auto histogram = _histogramWidgets[ i ];
-#else
-    for( auto histogram : _histogramWidgets )
-    {
-#endif
-
-      histogram->zoomFactor( _zoomFactor );
-      histogram->update();
-    }
+    _rebuildHistograms( );
   }
 
   void Summary::fillPlots( bool fillPlots_ )
@@ -1173,6 +1357,9 @@ namespace visimpl
       w->update();
     };
     std::for_each(_histogramWidgets.begin(), _histogramWidgets.end(), updateHeight);
+
+    for( const auto& row : _histogramRows )
+      _reserveRow( row );
   }
 
   unsigned int Summary::heightPerRow( void )
@@ -1190,32 +1377,63 @@ namespace visimpl
     return &_eventWidgets;
   }
 
-  const std::vector< HistogramWidget* >* Summary::histogramWidgets( void ) const
+  const std::vector< Summary::EventRow >* Summary::eventRows( void ) const
+  {
+    return &_eventRows;
+  }
+
+  const std::vector< Summary::HistogramRow >* Summary::histogramRows( void ) const
   {
-    return &_histogramWidgets;
+    return &_histogramRows;
   }
 
-  void Summary::hideRemoveEvent( unsigned int i, bool hideDelete )
+  int Summary::_eventRowIndex( unsigned int id ) const
   {
+    for( unsigned int i = 0; i < _eventRows.size(); ++i )
+      if( _eventRows[ i ].id == id )
+        return i;
+
+    return -1;
+  }
+
+  int Summary::_histogramRowIndex( unsigned int id ) const
+  {
+    for( unsigned int i = 0; i < _histogramRows.size(); ++i )
+      if( _histogramRows[ i ].id == id )
+        return i;
+
+    return -1;
+  }
+
+  void Summary::hideRemoveEvent( unsigned int id, bool hideDelete )
+  {
+    const int i = _eventRowIndex( id );
+    if( i < 0 )
+      return;
+
     if( hideDelete )
     {
-      eventVisibility( i, !_eventWidgets[ i ]->isVisible());
+      eventVisibility( id, !_eventWidgets[ i ]->isVisible());
     }
     else
     {
-      removeEvent( i );
+      removeEvent( id );
     }
   }
 
-  void Summary::hideRemoveSubset( unsigned int i, bool hideDelete )
+  void Summary::hideRemoveSubset( unsigned int id, bool hideDelete )
   {
+    const int i = _histogramRowIndex( id );
+    if( i < 0 )
+      return;
+
     if( hideDelete )
     {
-      subsetVisibility( i, !_histogramWidgets[ i ]->isVisible());
+      subsetVisibility( id, !_histogramRows[ i ].visible );
     }
     else
     {
-      removeSubset( i );
+      removeSubset( id );
     }
   }
 
@@ -1240,21 +1458,27 @@ namespace visimpl
   {
     unsigned int counter = 0;
 
-    auto updateHistogram = [&counter](HistogramWidget *w)
+    for( const auto& row : _histogramRows )
     {
-      if( !w->isVisible())
-        return;
+      if( !row.visible )
+        continue;
 
-      w->firstHistogram( counter == 0 );
-      ++counter;
+      if( row.histogram )
+      {
+        row.histogram->firstHistogram( counter == 0 );
+        row.histogram->update();
+      }
 
-      w->update();
-    };
-    std::for_each(_histogramWidgets.begin(), _histogramWidgets.end(), updateHistogram);
+      ++counter;
+    }
   }
 
-  void Summary::eventVisibility( unsigned int i, bool show )
+  void Summary::eventVisibility( unsigned int id, bool show )
   {
+    const int i = _eventRowIndex( id );
+    if( i < 0 )
+      return;
+
     EventRow& row = _eventRows[ i ];
 
     row.widget->setVisible( show );
@@ -1264,17 +1488,35 @@ namespace visimpl
 
     updateEventWidgets();
 
-    repaintHistograms();
+    auto invalidateHistogram = [](HistogramWidget *w)
+    {
+      w->invalidateBackground();
+    };
+    std::for_each(_histogramWidgets.begin(), _histogramWidgets.end(), invalidateHistogram);
   }
 
-  void Summary::subsetVisibility( unsigned int i, bool show )
+  void Summary::subsetVisibility( unsigned int id, bool show )
   {
+    const int i = _histogramRowIndex( id );
+    if( i < 0 )
+      return;
+
     HistogramRow& row = _histogramRows[ i ];
 
-    row.histogram->setVisible( show );
-    row.label->setVisible( show );
+    row.visible = show;
+    _reserveRow( row );
+
+    // Hidden rows give their widgets back once the release timer fires.
+    if( row.histogram )
+    {
+      row.histogram->setVisible( show );
+      row.label->setVisible( show );
+    }
 
     updateHistogramWidgets();
+
+    _showViewportRows();
+    _releaseTimer.start();
   }
 
   void Summary::clearEvents( void )
@@ -1301,8 +1543,12 @@ namespace visimpl
     update();
   }
 
-  void Summary::removeEvent( unsigned int i )
+  void Summary::removeEvent( unsigned int id )
   {
+    const int i = _eventRowIndex( id );
+    if( i < 0 )
+      return;
+
     auto& timeFrameRow = _eventRows[ i ];
 
     _layoutEventLabels->removeWidget( timeFrameRow.label );
@@ -1325,33 +1571,44 @@ namespace visimpl
     }
   }
 
-  void Summary::removeSubset( unsigned int i )
+  void Summary::removeSubset( unsigned int id )
   {
+    const int i = _histogramRowIndex( id );
+    if( i < 0 )
+      return;
+
     auto& summaryRow = _histogramRows[ i ];
 
     // Avoid deleting last histogram
     if( _mainHistogram == summaryRow.histogram && _histogramRows.size() <= 1 )
         return;
 
-    if( _focusedHistogram == summaryRow.histogram )
+    // The row may be read by the workers, restart them without it.
+    const bool rebuilding = _cancelRebuild( );
+
+    if( summaryRow.histogram && _focusedHistogram == summaryRow.histogram )
     {
       _focusedHistogram = nullptr;
       _focusWidget->clear();
       _focusWidget->update();
     }
 
-    _layoutHistoLabels->removeWidget( summaryRow.label );
-    _layoutHistograms->removeWidget( summaryRow.histogram );
+    summaryRow.visible = false;
+    _reserveRow( summaryRow );
 
-    delete summaryRow.label;
-    delete summaryRow.histogram;
-    delete summaryRow.checkBox;
+    if( summaryRow.histogram )
+      _releaseRow( summaryRow );
 
-    _histogramWidgets.erase( _histogramWidgets.begin() + i );
+    delete summaryRow.checkBox;
 
     _histogramRows.erase( _histogramRows.begin() + i );
 
     updateHistogramWidgets();
+
+    _showViewportRows();
+
+    if( rebuilding )
+      _rebuildHistograms( );
   }
 
   void Summary::colorScaleLocal( int value )
@@ -1372,6 +1629,9 @@ namespace visimpl
 
   void Summary::colorScaleLocal( visimpl::TColorScale colorScale )
   {
+    // Workers would publish curves with the previous scale.
+    const bool rebuilding = _cancelRebuild( );
+
     _colorScaleLocal = colorScale;
 
     auto setScaleLocal = [&colorScale](HistogramWidget *w)
@@ -1385,9 +1645,13 @@ namespace visimpl
 
     if(_focusedHistogram)
     {
+      _focusedHistogram->buildPendingData( );
       _focusWidget->viewRegion( *_focusedHistogram, _regionPercentage, _regionWidth );
     }
     _focusWidget->update();
+
+    if( rebuilding )
+      _rebuildHistograms( );
   }
 
   visimpl::TColorScale Summary::colorScaleLocal( void )
@@ -1397,6 +1661,9 @@ namespace visimpl
 
   void Summary::colorScaleGlobal( visimpl::TColorScale colorScale )
   {
+    // Workers would publish curves with the previous scale.
+    const bool rebuilding = _cancelRebuild( );
+
     _colorScaleGlobal = colorScale;
 
     auto setScaleGlobal = [&colorScale](HistogramWidget *w)
@@ -1410,9 +1677,13 @@ namespace visimpl
 
     if(_focusedHistogram)
     {
+      _focusedHistogram->buildPendingData( );
       _focusWidget->viewRegion( *_focusedHistogram, _regionPercentage, _regionWidth );
     }
     _focusWidget->update();
+
+    if( rebuilding )
+      _rebuildHistograms( );
   }
 
   visimpl::TColorScale Summary::colorScaleGlobal( void )
@@ -1463,19 +1734,519 @@ namespace visimpl
     std::for_each(_histogramWidgets.begin(), _histogramWidgets.end(), assignPlayer);
   }
 
+  void Summary::spikeStream( SpikeStream* stream )
+  {
+    _spikeStream = stream;
+  }
+
+  void Summary::analysisCache( AnalysisCache* cache )
+  {
+    _analysisCache = cache;
+  }
+
+  void Summary::_showViewportRows( void )
+  {
+    if( !_scrollHistogram )
+      return;
+
+    // Rows within a viewport of the visible area get their widgets, they
+    // request their data when first painted.
+    const int viewHeight = _scrollHistogram->viewport()->height();
+    const int top = _scrollHistogram->verticalScrollBar()->value() - viewHeight;
+    const int bottom = top + 3 * viewHeight;
+
+    int rowTop = _layoutHistograms->contentsMargins().top();
+    for( auto& row : _histogramRows )
+    {
+      if( rowTop > bottom )
+        break;
+
+      if( !row.visible )
+        continue;
+
+      const int rowBottom = rowTop + _heightPerRow;
+      if( !row.histogram && rowBottom >= top )
+        _materializeRow( row );
+
+      rowTop = rowBottom;
+    }
+  }
+
+  void Summary::_releaseHiddenRows( void )
+  {
+    if( !_scrollHistogram )
+      return;
+
+    // Rows further than a viewport away from the visible area give their
+    // widgets back, they are created again when scrolled into view.
+    const int viewHeight = _scrollHistogram->viewport()->height();
+    const int top = _scrollHistogram->verticalScrollBar()->value() - viewHeight;
+    const int bottom = top + 3 * viewHeight;
+
+    int rowTop = _layoutHistograms->contentsMargins().top();
+    for( auto& row : _histogramRows )
+    {
+      const int rowBottom = row.visible ? rowTop + _heightPerRow : rowTop;
+      const bool inView = row.visible && rowBottom >= top && rowTop <= bottom;
+      rowTop = rowBottom;
+
+      if( !row.histogram || inView || row.histogram == _focusedHistogram )
+        continue;
+
+      // The main row keeps its widget, only its data is released. Rows
+      // being rebuilt are released once their data is published.
+      if( row.histogram == _mainHistogram )
+        row.histogram->releaseData();
+      else if( !row.histogram->_building )
+        _releaseRow( row );
+    }
+  }
+
+  void Summary::_requestRowData( void )
+  {
+    auto histogram = qobject_cast< HistogramWidget* >( sender());
+    if( !histogram || histogram->_building )
+      return;
+
+    if( std::find( _requestedRows.begin(), _requestedRows.end(), histogram ) ==
+        _requestedRows.end())
+      _requestedRows.push_back( histogram );
+
+    _requestTimer.start();
+  }
+
+  void Summary::_buildRequestedRows( void )
+  {
+    // Rows painted in the same tick are counted in a single pass, by the
+    // rebuild worker instead of the paint event.
+    std::vector< HistogramWidget* > rows;
+    for( auto histogram : _requestedRows )
+    {
+      if( histogram->_dataPending && !histogram->_building )
+        rows.push_back( histogram );
+    }
+    _requestedRows.clear();
+
+    _buildBatch( std::move( rows ));
+  }
+
+  void Summary::_rebuildHistograms( void )
+  {
+    // The running job stops at its next check and its results are dropped,
+    // there is no need to wait for it here.
+    ++_rebuildGeneration;
+    _rebuildTotal = 0;
+
+    {
+      std::lock_guard< std::mutex > lock( _rebuildMutex );
+      _rebuildJobs.clear();
+      _rebuiltRows.clear();
+    }
+
+    // Hidden lazy rows are rebuilt when painted, the rest by the worker.
+    std::vector< RebuildRow > rows;
+    for( auto histogram : _histogramWidgets )
+    {
+      if( histogram->lazy() && histogram != _focusedHistogram &&
+          histogram->visibleRegion().isEmpty() )
+      {
+        // Queued by the previous rebuild, which is dropped.
+        if( histogram->_building )
+        {
+          histogram->_building = false;
+          histogram->_dataPending = true;
+        }
+
+        histogram->bins( _bins );
+        histogram->zoomFactor( _zoomFactor );
+        continue;
+      }
+
+      rows.push_back( _rebuildRow( histogram ));
+    }
+
+    // A single pass over a streamed report fills every row, instead of one
+    // pass from disk per row.
+    _queueRebuild( std::move( rows ), _spikeStream != nullptr );
+  }
+
+  void Summary::_queueRebuild( std::vector< RebuildRow > rows, bool batch )
+  {
+    if( rows.empty() )
+      return;
+
+    RebuildJob job;
+    job.generation = _rebuildGeneration;
+    job.batch = batch;
+    job.bins = _bins;
+    job.zoom = _zoomFactor;
+    job.rows = std::move( rows );
+
+    // Rows of one generation are published together, whichever job they
+    // were queued in.
+    _rebuildTotal += job.rows.size();
+
+    {
+      std::lock_guard< std::mutex > lock( _rebuildMutex );
+
+      if( !_rebuildThread.joinable() )
+        _rebuildThread = std::thread( &Summary::_rebuildLoop, this );
+
+      _rebuildJobs.push_back( std::move( job ));
+    }
+    _rebuildCondition.notify_one();
+
+    emit rebuildProgress( 0, _rebuildTotal );
+  }
+
+  void Summary::_rebuildLoop( void )
+  {
+    std::unique_lock< std::mutex > lock( _rebuildMutex );
+
+    while( true )
+    {
+      _rebuildCondition.wait( lock, [ this ]
+                              { return _rebuildStop || !_rebuildJobs.empty(); });
+      if( _rebuildStop )
+        return;
+
+      RebuildJob job = std::move( _rebuildJobs.front() );
+      _rebuildJobs.pop_front();
+
+      lock.unlock();
+
+      if( job.generation == _rebuildGeneration )
+      {
+        if( job.batch )
+          _countBatch( job );
+        else
+          _rebuildRows( job );
+      }
+
+      lock.lock();
+    }
+  }
+
+  Summary::RebuildRow Summary::_rebuildRow( HistogramWidget* histogram )
+  {
+    histogram->_resolution( _bins, _zoomFactor );
+
+    RebuildRow row;
+    row.histogram = histogram;
+    row.source = histogram->dataSource();
+    row.config = histogram->colorConfig();
+
+    return row;
+  }
+
+  void Summary::_rebuildRows( const RebuildJob& job )
+  {
+    const unsigned int generation = job.generation;
+    const auto& rows = job.rows;
+
+#ifdef VISIMPL_USE_OPENMP
+    #pragma omp parallel for schedule( dynamic )
+#endif
+    for( int i = 0; i < static_cast<int>(rows.size()); ++i )
+    {
+      if( generation != _rebuildGeneration )
+        continue;
+
+      RebuiltRow row;
+      row.generation = generation;
+      row.histogram = rows[ i ].histogram;
+      HistogramWidget::_computeData( rows[ i ].source, rows[ i ].config,
+                                     job.bins, job.zoom, row.main, row.focus );
+
+      {
+        std::lock_guard< std::mutex > lock( _rebuildMutex );
+        _rebuiltRows.push_back( std::move( row ));
+      }
+
+      if( generation == _rebuildGeneration )
+        emit _rowsRebuilt();
+    }
+  }
+
+  void Summary::_buildBatch( std::vector< HistogramWidget* > rows )
+  {
+    if( rows.empty() )
+      return;
+
+    // A running rebuild keeps its generation, the batch is published along
+    // with its rows.
+    if( _rebuildTotal == 0 )
+    {
+      ++_rebuildGeneration;
+
+      std::lock_guard< std::mutex > lock( _rebuildMutex );
+      _rebuiltRows.clear();
+    }
+
+    std::vector< RebuildRow > batch;
+    batch.reserve( rows.size() );
+    for( auto histogram : rows )
+      batch.push_back( _rebuildRow( histogram ));
+
+    _queueRebuild( std::move( batch ), true );
+  }
+
+  void Summary::_countBatch( const RebuildJob& job )
+  {
+    const unsigned int generation = job.generation;
+    const unsigned int bins_ = job.bins;
+    const auto& rows = job.rows;
+
+    const unsigned int focusBins = bins_ * job.zoom;
+
+    std::vector< RebuiltRow > results( rows.size() );
+    for( unsigned int i = 0; i < rows.size(); ++i )
+    {
+      results[ i ].generation = generation;
+      results[ i ].histogram = rows[ i ].histogram;
+      results[ i ].main.resize( bins_, 0 );
+      results[ i ].focus.resize( focusBins, 0 );
+    }
+
+    std::vector< unsigned int > globalMain( bins_, 0 );
+    std::vector< unsigned int > globalFocus( focusBins, 0 );
+
+    // Every row of a batch shares the report, cache and stream.
+    const HistogramWidget::DataSource& source = rows.front().source;
+
+    const float startTime = source.startTime;
+    const float endTime = source.endTime;
+    const float invTotalTime = 1.0f / ( endTime - startTime );
+
+    // Rows counted before at this or a finer resolution are read back from
+    // the cache.
+    // The rest are mapped from their subset gids, so a single pass over the
+    // spikes fills the bins of all of them.
+    std::vector< bool > counted( rows.size(), true );
+    std::unordered_map< uint32_t, std::vector< unsigned int >> gidRows;
+    bool pending = false;
+
+    for( unsigned int i = 0; i < rows.size(); ++i )
+    {
+      const auto& gids = *rows[ i ].source.gids;
+      auto& result = results[ i ];
+
+      if( source.cache )
+      {
+        std::vector< unsigned int > cachedMain( bins_, 0 );
+        std::vector< unsigned int > cachedFocus( focusBins, 0 );
+        const std::string key =
+            AnalysisCache::histogramKey( gids, startTime, endTime );
+
+        if( source.cache->readHistogram( key, result.main, cachedMain ) &&
+            source.cache->readHistogram( key, result.focus, cachedFocus ))
+        {
+          HistogramWidget::_updateMaxima( result.main, cachedMain, true );
+          HistogramWidget::_updateMaxima( result.focus, cachedFocus, true );
+
+          HistogramWidget::_calculateColors( result.main, rows[ i ].config );
+          HistogramWidget::_calculateColors( result.focus, rows[ i ].config );
+
+          counted[ i ] = false;
+          continue;
+        }
+
+        // The main bins may have been read before the focus ones missed.
+        std::fill( result.main.begin(), result.main.end(), 0 );
+      }
+
+      for( auto gid : gids )
+        gidRows[ gid ].push_back( i );
+
+      pending = true;
+    }
+
+    auto countSpike = [&]( float time, uint32_t gid )
+    {
+      const unsigned int mainBin = HistogramWidget::_binIndex(
+          time, startTime, invTotalTime, bins_ );
+      const unsigned int focusBin = HistogramWidget::_binIndex(
+          time, startTime, invTotalTime, focusBins );
+
+      ++globalMain[ mainBin ];
+      ++globalFocus[ focusBin ];
+
+      const auto gidIt = gidRows.find( gid );
+      if( gidIt == gidRows.end() )
+        return;
+
+      for( auto i : gidIt->second )
+      {
+        ++results[ i ].main[ mainBin ];
+        ++results[ i ].focus[ focusBin ];
+      }
+    };
+
+    // Streamed reports are read once for the whole batch, not once per row.
+    if( pending && source.stream )
+    {
+      source.stream->forEachChunk(
+          [&]( const float* times, const uint32_t* gids, uint64_t count )
+          {
+            for( uint64_t i = 0; i < count; ++i )
+              countSpike( times[ i ], gids[ i ] );
+
+            return generation == _rebuildGeneration;
+          });
+    }
+    else if( pending )
+    {
+      unsigned int counter = 0;
+      for( const auto& spike : *source.spikes )
+      {
+        if( ( ++counter & 0xFFFF ) == 0 && generation != _rebuildGeneration )
+          break;
+
+        countSpike( spike.first, spike.second );
+      }
+    }
+
+    if( generation == _rebuildGeneration )
+    {
+      for( unsigned int i = 0; i < results.size(); ++i )
+      {
+        if( !counted[ i ] )
+          continue;
+
+        auto& result = results[ i ];
+        const auto& row = rows[ i ];
+
+        // Rows without a subset, as "All", show every spike.
+        if( row.source.gids->empty() )
+        {
+          std::copy( globalMain.begin(), globalMain.end(), result.main.begin() );
+          std::copy( globalFocus.begin(), globalFocus.end(), result.focus.begin() );
+        }
+
+        HistogramWidget::_updateMaxima( result.main, globalMain, true );
+        HistogramWidget::_updateMaxima( result.focus, globalFocus, true );
+
+        if( source.cache )
+        {
+          const std::string key = AnalysisCache::histogramKey(
+              *row.source.gids, startTime, endTime );
+          source.cache->writeHistogram( key, result.main, globalMain );
+          source.cache->writeHistogram( key, result.focus, globalFocus );
+        }
+
+        HistogramWidget::_calculateColors( result.main, row.config );
+        HistogramWidget::_calculateColors( result.focus, row.config );
+      }
+
+      {
+        std::lock_guard< std::mutex > lock( _rebuildMutex );
+        std::move( results.begin(), results.end(),
+                   std::back_inserter( _rebuiltRows ));
+      }
+
+      emit _rowsRebuilt();
+    }
+  }
+
+  void Summary::_publishRebuiltRows( void )
+  {
+    std::vector< RebuiltRow > rows;
+    unsigned int ready = 0;
+    {
+      std::lock_guard< std::mutex > lock( _rebuildMutex );
+
+      const unsigned int generation = _rebuildGeneration;
+      _rebuiltRows.erase(
+          std::remove_if( _rebuiltRows.begin(), _rebuiltRows.end(),
+                          [generation]( const RebuiltRow& row )
+                          { return row.generation != generation; }),
+          _rebuiltRows.end());
+
+      ready = _rebuiltRows.size();
+
+      // Rows are swapped in all at once, never mixing two resolutions.
+      if( ready == _rebuildTotal )
+        rows.swap( _rebuiltRows );
+    }
+
+    emit rebuildProgress( ready, _rebuildTotal );
+
+    if( rows.empty() )
+      return;
+
+    _rebuildTotal = 0;
+
+    bool focusRebuilt = false;
+    for( auto& row : rows )
+    {
+      row.histogram->_publishData( std::move( row.main ), std::move( row.focus ));
+      focusRebuilt |= row.histogram == _focusedHistogram;
+    }
+
+    if( focusRebuilt )
+    {
+      _focusWidget->viewRegion( *_focusedHistogram, _regionPercentage, _regionWidth );
+      _focusWidget->update();
+    }
+  }
+
+  bool Summary::_cancelRebuild( void )
+  {
+    // The worker drops the running job at its next check, nothing waits
+    // for it. Jobs only read their snapshots, never the rows.
+    const bool running = _rebuildTotal > 0;
+
+    ++_rebuildGeneration;
+    _rebuildTotal = 0;
+
+    {
+      std::lock_guard< std::mutex > lock( _rebuildMutex );
+      _rebuildJobs.clear();
+      _rebuiltRows.clear();
+    }
+
+    _dropRebuildingRows( );
+
+    return running;
+  }
+
+  void Summary::_dropRebuildingRows( void )
+  {
+    // Rows left without their new data request it again when painted.
+    for( auto histogram : _histogramWidgets )
+    {
+      if( !histogram->_building )
+        continue;
+
+      histogram->_building = false;
+      histogram->_dataPending = true;
+      histogram->update();
+    }
+  }
+
   void Summary::repaintHistograms( void )
   {
     auto updateHistograms = [](HistogramWidget *w)
     {
-      w->update();
+      w->updateOverlay();
     };
     std::for_each(_histogramWidgets.begin(), _histogramWidgets.end(), updateHistograms);
   }
 
   void Summary::_resizeCharts( unsigned int newMinSize, Qt::Orientation orientation )
   {
-    auto resizeHistogramRow = [&newMinSize, &orientation](visimpl::Summary::HistogramRow &h)
+    // Rows created later take the new height.
+    if( orientation != Qt::Horizontal )
+      _heightPerRow = newMinSize;
+
+    auto resizeHistogramRow = [this, &newMinSize, &orientation](visimpl::Summary::HistogramRow &h)
     {
+      if( orientation != Qt::Horizontal )
+        _reserveRow( h );
+
+      if( !h.histogram )
+        return;
+
       if( orientation == Qt::Horizontal )
         h.histogram->setMinimumWidth( newMinSize );
       else
@@ -1490,7 +2261,10 @@ namespace visimpl
     std::for_each(_histogramRows.begin(), _histogramRows.end(), resizeHistogramRow);
 
     if(orientation != Qt::Horizontal)
+    {
       _scrollHistogram->setMinimumHeight( newMinSize );
+      _showViewportRows();
+    }
   }
 
   void Summary::_resizeEvents( unsigned int newMinSize )
@@ -1502,15 +2276,6 @@ namespace visimpl
     std::for_each(_eventWidgets.begin(), _eventWidgets.end(), updateEventWidth);
   }
 
-  void Summary::_updateEventRepSizes( unsigned int newSize )
-  {
-    auto updateEventSize = [&newSize](EventWidget *w)
-    {
-      w->updateCommonRepSizeVert(newSize);
-    };
-    std::for_each(_eventWidgets.begin(), _eventWidgets.end(), updateEventSize);
-  }
-
   void Summary::_updateScaleHorizontal( void )
   {
     _scaleCurrentHorizontal = std::max( 1.0, _spinBoxScaleHorizontal->value());
@@ -1536,8 +2301,6 @@ namespace visimpl
 
     _sizeChartVertical = _sizeChartVerticalDefault * _scaleCurrentVertical;
 
-    _updateEventRepSizes( _sizeChartVertical );
-
     _resizeCharts( _sizeChartVertical, Qt::Vertical );
   }
 
@@ -1716,13 +2479,13 @@ namespace visimpl
 
       updateRegionBounds();
 
+      _focusedHistogram->buildPendingData( );
       _focusWidget->viewRegion( *_focusedHistogram, _regionPercentage, _regionWidth );
       _focusWidget->update();
 
       _focusedHistogram->regionWidth( _regionWidth );
       _focusedHistogram->paintRegion(true);
       _focusedHistogram->focusValueAt(perc);
-      _focusedHistogram->update();
 
       auto setPaintRegion = [&](HistogramWidget *w)
       {
@@ -1732,7 +2495,7 @@ namespace visimpl
           w->focusValueAt(perc);
         }
         w->paintRegion(w == _focusedHistogram);
-        w->update();
+        w->updateOverlay();
       };
       std::for_each(_histogramWidgets.begin(), _histogramWidgets.end(), setPaintRegion);
     }
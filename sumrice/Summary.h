@@ -40,6 +40,12 @@
 
 #include <QGroupBox>
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
 #include "EventWidget.h"
 #include "FocusFrame.h"
 #include "Histogram.h"
@@ -79,8 +85,64 @@ namespace visimpl
 
   public:
 
+    struct HistogramRow
+    {
+    public:
+
+      HistogramRow( )
+      : id( 0 )
+      , size( 0 )
+      , visible( true )
+      , gridRow( 0 )
+      , histogram( nullptr )
+      , label( nullptr )
+      , checkBox( nullptr )
+      { }
+
+      ~HistogramRow( )
+      { }
+
+      //! Stable while the row exists, never reused for another row.
+      unsigned int id;
+      std::string name;
+      //! Subset of the row, empty for the one showing every neuron.
+      std::shared_ptr< const GIDUSet > gids;
+      unsigned int size;
+      bool visible;
+      //! Row of the label and histogram grid layouts.
+      unsigned int gridRow;
+
+      // Only rows near the viewport have widgets, null otherwise.
+      visimpl::HistogramWidget* histogram;
+      QLabel* label;
+      QCheckBox* checkBox;
+
+    };
+
+    struct EventRow
+    {
+    public:
+
+      EventRow( )
+      : id( 0 )
+      , widget( nullptr )
+      , label( nullptr )
+      , checkBox( nullptr )
+      { }
+
+      ~EventRow( )
+      { }
+
+      //! Taken from the same counter as HistogramRow::id.
+      unsigned int id;
+      visimpl::EventWidget* widget;
+      QLabel* label;
+      QCheckBox* checkBox;
+
+    };
+
     Summary( QWidget* parent = nullptr, TStackType stackType = T_STACK_FIXED);
-    virtual ~Summary( ){};
+    virtual ~Summary( );
 
     void Init( simil::SimulationData* data_ );
 
@@ -101,7 +163,9 @@ namespace visimpl
     unsigned int heightPerRow( void );
 
     const std::vector< EventWidget* >* eventWidgets( void ) const;
-    const std::vector< HistogramWidget* >* histogramWidgets( void ) const;
+
+    const std::vector< EventRow >* eventRows( void ) const;
+    const std::vector< HistogramRow >* histogramRows( void ) const;
 
     void showMarker( bool show_ );
 
@@ -120,6 +184,15 @@ namespace visimpl
 
     void simulationPlayer( simil::SimulationPlayer* player );
 
+    //! Source of out-of-core spikes, must be set before Init.
+    void spikeStream( SpikeStream* stream );
+
+    //! Cache of the histogram bin counts, must be set before Init.
+    void analysisCache( AnalysisCache* cache );
+
+    //! Adds a subset row taking ownership of its gids.
+    void importSubset( const std::string& name, GIDUSet&& subset );
+
     void repaintHistograms( void );
 
   signals:
@@ -127,6 +200,11 @@ namespace visimpl
     void histogramClicked( float );
     void histogramClicked( visimpl::HistogramWidget* );
 
+    //! Rows recomputed after a bins or zoom factor change.
+    void rebuildProgress( unsigned int done, unsigned int total );
+
+    void _rowsRebuilt( void );
+
   public slots:
 
     void UpdateHistograms( void );
@@ -146,10 +224,11 @@ namespace visimpl
 
     void adjustSplittersSize( void );
 
-    void eventVisibility( unsigned int i, bool show );
-    void subsetVisibility( unsigned int i, bool show );
-    void removeEvent( unsigned int i );
-    void removeSubset( unsigned int i );
+    // Rows are addressed by their id, indices shift as rows are removed.
+    void eventVisibility( unsigned int id, bool show );
+    void subsetVisibility( unsigned int id, bool show );
+    void removeEvent( unsigned int id );
+    void removeSubset( unsigned int id );
 
     void focusPlayback( void );
     void setFocusAt( float perc );
@@ -171,8 +250,8 @@ namespace visimpl
     void moveHoriScrollSync( int newPos );
     void syncSplitters( );
 
-    void hideRemoveEvent( unsigned int i, bool hideDelete );
-    void hideRemoveSubset( unsigned int i, bool hideDelete );
+    void hideRemoveEvent( unsigned int id, bool hideDelete );
+    void hideRemoveSubset( unsigned int id, bool hideDelete );
 
     void updateEventWidgets( void );
     void updateHistogramWidgets( void );
@@ -180,44 +259,42 @@ namespace visimpl
     void _updateScaleHorizontal( void );
     void _updateScaleVertical( void );
 
-  protected:
-
-    struct HistogramRow
-    {
-    public:
+    //! Creates the widgets of the rows near the viewport.
+    void _showViewportRows( void );
+    void _releaseHiddenRows( void );
 
-      HistogramRow( )
-      : histogram( nullptr )
-      , label( nullptr )
-      , checkBox( nullptr )
-      { }
+    void _requestRowData( void );
+    void _buildRequestedRows( void );
 
-      ~HistogramRow( )
-      { }
+    void _publishRebuiltRows( void );
+    void _applyParameters( void );
 
-      visimpl::HistogramWidget* histogram;
-      QLabel* label;
-      QCheckBox* checkBox;
+  protected:
 
+    //! A row to rebuild, workers only read the snapshots.
+    struct RebuildRow
+    {
+      HistogramWidget* histogram;
+      HistogramWidget::DataSource source;
+      HistogramWidget::ColorConfig config;
     };
 
-    struct EventRow
+    struct RebuildJob
     {
-    public:
-
-      EventRow( )
-      : widget( nullptr )
-      , label( nullptr )
-      , checkBox( nullptr )
-      { }
-
-      ~EventRow( )
-      { }
-
-      visimpl::EventWidget* widget;
-      QLabel* label;
-      QCheckBox* checkBox;
+      unsigned int generation;
+      //! Counts all rows in a single pass over the spikes.
+      bool batch;
+      unsigned int bins;
+      float zoom;
+      std::vector< RebuildRow > rows;
+    };
 
+    struct RebuiltRow
+    {
+      unsigned int generation;
+      HistogramWidget* histogram;
+      HistogramWidget::Histogram main;
+      HistogramWidget::Histogram focus;
     };
 
   #ifdef VISIMPL_USE_ZEROEQ
@@ -242,6 +319,13 @@ namespace visimpl
 
     void insertSubset( const Selection& selection );
     void insertSubset( const std::string& name, const GIDUSet& subset );
+    void insertSubset( const std::string& name, GIDUSet&& subset );
+
+    void _materializeRow( HistogramRow& row );
+    void _releaseRow( HistogramRow& row );
+
+    //! Reserves the grid space of a row, whether it has widgets or not.
+    void _reserveRow( const HistogramRow& row );
 
     void CreateSummarySpikes( );
     void InsertSummarySpikes( const GIDUSet& gids );
@@ -252,7 +336,31 @@ namespace visimpl
     void calculateRegionBounds( void );
     void SetFocusRegionPosition( const QPoint& localPosition );
 
-    void _updateEventRepSizes( unsigned int newSize );
+    void _rebuildHistograms( void );
+
+    //! Hands the rows to the rebuild worker, started on first use.
+    void _queueRebuild( std::vector< RebuildRow > rows, bool batch );
+    void _rebuildLoop( void );
+    void _rebuildRows( const RebuildJob& job );
+
+    /*! \brief Builds rows off the GUI thread, from the analysis cache or
+     * with a single pass over the spikes for all of them.
+     */
+    void _buildBatch( std::vector< HistogramWidget* > rows );
+    void _countBatch( const RebuildJob& job );
+
+    //! Snapshots a row for the workers and marks it as being rebuilt.
+    RebuildRow _rebuildRow( HistogramWidget* histogram );
+
+    //! Stops the workers, returns whether a rebuild was in progress.
+    bool _cancelRebuild( void );
+
+    //! Marks the rows of a superseded rebuild as pending again.
+    void _dropRebuildingRows( void );
+
+    //! Position of the row with the given id, or -1 if it was removed.
+    int _eventRowIndex( unsigned int id ) const;
+    int _histogramRowIndex( unsigned int id ) const;
 
     void _resizeCharts( unsigned int newMinSize, Qt::Orientation orientation );
     void _resizeEvents( unsigned int newMinSize );
@@ -282,6 +390,8 @@ namespace visimpl
     simil::SpikeData* _spikeReport;
 
     simil::SimulationPlayer* _player;
+    SpikeStream* _spikeStream;
+    AnalysisCache* _analysisCache;
 
     GIDUSet _gids;
 
@@ -299,8 +409,23 @@ namespace visimpl
     QColor _colorLocal;
     QColor _colorGlobal;
 
+    // Widgets of the rows near the viewport, the main one always first.
     std::vector< visimpl::HistogramWidget* > _histogramWidgets;
     std::vector< HistogramRow > _histogramRows;
+    unsigned int _nextGridRow;
+
+    // Restarted while scrolling, releases the widgets of far away rows.
+    QTimer _releaseTimer;
+
+    // Released row widgets and labels, rebound to rows scrolled into view.
+    std::vector< std::pair< visimpl::HistogramWidget*, QLabel* >> _rowPool;
+
+    // Coalesces row insertions before creating the widgets in view.
+    QTimer _viewportTimer;
+
+    // Rows painted without data, built together on the next tick.
+    std::vector< visimpl::HistogramWidget* > _requestedRows;
+    QTimer _requestTimer;
 
     FocusFrame* _focusWidget;
 
@@ -344,6 +469,9 @@ namespace visimpl
     std::vector< EventWidget* > _eventWidgets;
     std::vector< EventRow > _eventRows;
 
+    // Next row id, shared by event and subset rows.
+    unsigned int _nextRowId;
+
     bool _syncScrollsHorizontally;
     bool _syncScrollsVertically;
 
@@ -383,6 +511,23 @@ namespace visimpl
     scoop::ColorPalette _eventsPalette;
 //    std::vector< QColor > _subsetEventColorPalette;
 
+    // Restarted while the bins or zoom spin boxes change.
+    QTimer _parametersTimer;
+
+    // A single worker runs the queued jobs one after another, so a single
+    // OpenMP team counts at a time. Every rebuild request bumps the
+    // generation, jobs and results of older generations are discarded.
+    std::thread _rebuildThread;
+    std::deque< RebuildJob > _rebuildJobs;
+    std::condition_variable _rebuildCondition;
+    bool _rebuildStop;
+
+    std::atomic< unsigned int > _rebuildGeneration;
+    unsigned int _rebuildTotal;
+
+    std::mutex _rebuildMutex;
+    std::vector< RebuiltRow > _rebuiltRows;
+
   };
 
 }
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2015-2020 VG-Lab/URJC.
+ *
+ * Authors: Pablo Toharia Rabasco  <pablo.toharia@urjc.es>
+ *
+ * This file is part of ViSimpl <https://github.com/vg-lab/visimpl>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "types.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace visimpl
+{
+  // Widths kept by TEvent::spans, resizing a view creates a new one per step.
+  static const size_t EVENT_SPAN_WIDTHS = 8;
+
+  void TEvent::percentages( std::vector< std::pair< float, float >> chunks )
+  {
+    _percentages = std::move( chunks );
+    _cachedSpans.clear( );
+  }
+
+  const std::vector< TEventSpan >& TEvent::spans( int width ) const
+  {
+    const auto cached = _cachedSpans.find( width );
+    if( cached != _cachedSpans.end( ))
+      return cached->second;
+
+    if( _cachedSpans.size( ) >= EVENT_SPAN_WIDTHS )
+      _cachedSpans.clear( );
+
+    std::vector< TEventSpan >& spans_ = _cachedSpans[ width ];
+    spans_.reserve( _percentages.size( ));
+
+    for( const auto& chunk : _percentages )
+    {
+      const int left = static_cast< int >( chunk.first * width );
+      const int right = std::max( left + 1,
+          static_cast< int >( std::ceil( chunk.second * width )));
+
+      spans_.emplace_back( left, right );
+    }
+
+    std::sort( spans_.begin( ), spans_.end( ));
+
+    auto last = spans_.begin( );
+    for( auto it = spans_.begin( ); it != spans_.end( ); ++it )
+    {
+      if( last == it )
+        continue;
+
+      if( it->first <= last->second )
+        last->second = std::max( last->second, it->second );
+      else
+        *( ++last ) = *it;
+    }
+
+    if( !spans_.empty( ))
+      spans_.erase( last + 1, spans_.end( ));
+
+    return spans_;
+  }
+}
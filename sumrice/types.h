@@ -74,18 +74,32 @@ namespace visimpl
 
   } TStackType;
 
+  typedef std::pair< int, int > TEventSpan;
+
   struct TEvent
   {
     std::string name;
     QColor color;
     bool visible;
 
-    std::vector< std::pair< float, float >> percentages;
+    //! Event chunks as [start, end) fractions of the simulation.
+    const std::vector< std::pair< float, float >>& percentages( void ) const
+    { return _percentages; }
+
+    //! Replaces the chunks and drops the spans computed from the old ones.
+    void percentages( std::vector< std::pair< float, float >> chunks );
+
+    /*! \brief Pixel columns [first, second) covered by the event at the
+     * given width, with overlapping and adjacent chunks merged. Kept for a
+     * few widths, so views of different sizes do not recompute them.
+     */
+    const std::vector< TEventSpan >& spans( int width ) const;
 
-    std::vector< QPainterPath > _cachedCustomSolidRep;
-    std::vector< QPainterPath > _cachedCustomTransRep;
-    std::vector< QPainterPath > _cachedCustomHistoRep;
-    std::vector< QPainterPath > _cachedCommonRep;
+  protected:
+
+    std::vector< std::pair< float, float >> _percentages;
+
+    mutable std::unordered_map< int, std::vector< TEventSpan >> _cachedSpans;
   };
 
   typedef enum
@@ -144,6 +158,25 @@ namespace visimpl
     { return result > other.result; }
   };
 
+  //! Bins counted for a neuron against an event activity pattern.
+  struct Contingency
+  {
+    uint32_t firedPattern = 0;
+    uint32_t firedNotPattern = 0;
+    uint32_t notFiredPattern = 0;
+    uint32_t notFiredNotPattern = 0;
+    uint32_t totalFiring = 0;
+  };
+
+  struct ContingencyTable
+  {
+    // Analysis bins and those where the event was active.
+    uint32_t totalBins = 0;
+    uint32_t activeBins = 0;
+
+    std::unordered_map< uint32_t, Contingency > neurons;
+  };
+
   typedef std::unordered_map< uint32_t, CorrelationValues > TNeuronCorrelationUMap;
   typedef TNeuronCorrelationUMap::const_iterator TNeuronCorrelUMapCIt;
   typedef std::pair< TNeuronCorrelUMapCIt,
@@ -0,0 +1,273 @@
+/*
+ * Copyright (c) 2015-2020 VG-Lab/URJC.
+ *
+ * Authors: Sergio E. Galindo <sergio.galindo@urjc.es>
+ *
+ * This file is part of ViSimpl <https://github.com/vg-lab/visimpl>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "DataLoader.h"
+
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+namespace visimpl
+{
+  DataLoader::Run::Run( unsigned int id_ )
+  : id( id_ )
+  , owner( nullptr )
+  , cancel( false )
+  , running( true )
+  , player( nullptr )
+  , spikeStream( nullptr )
+  { }
+
+  DataLoader::Run::~Run( )
+  {
+    if( player )
+      delete player;
+
+    if( spikeStream )
+      delete spikeStream;
+  }
+
+  DataLoader::DataLoader( QObject* parent_ )
+  : QObject( parent_ )
+  , _runs( 0 )
+  { }
+
+  DataLoader::~DataLoader( )
+  {
+    _release( );
+  }
+
+  void DataLoader::start( const std::string& fileName,
+                          simil::TDataType fileType,
+                          const std::string& report, const vec3& scale )
+  {
+    _release( );
+
+    _current = std::make_shared< Run >( ++_runs );
+    _current->owner = this;
+
+    std::thread( &DataLoader::_run, _current, fileName, fileType, report,
+                 scale ).detach( );
+  }
+
+  bool DataLoader::running( void ) const
+  {
+    return _current && _current->running;
+  }
+
+  void DataLoader::cancel( void )
+  {
+    if( _current )
+      _current->cancel = true;
+  }
+
+  void DataLoader::_release( void )
+  {
+    if( !_current )
+      return;
+
+    // The worker keeps its own reference and frees the results it
+    // produces after this point.
+    _current->cancel = true;
+    {
+      std::lock_guard< std::mutex > lock( _current->mutex );
+      _current->owner = nullptr;
+    }
+
+    _current.reset( );
+  }
+
+  simil::SpikesPlayer* DataLoader::takePlayer( void )
+  {
+    if( !_current || _current->running )
+      return nullptr;
+
+    auto player = _current->player;
+    _current->player = nullptr;
+
+    return player;
+  }
+
+  tGidPosMap DataLoader::takePositions( void )
+  {
+    if( !_current || _current->running )
+      return tGidPosMap( );
+
+    return std::move( _current->positions );
+  }
+
+  SpikeStream* DataLoader::takeSpikeStream( void )
+  {
+    if( !_current || _current->running )
+      return nullptr;
+
+    auto stream = _current->spikeStream;
+    _current->spikeStream = nullptr;
+
+    return stream;
+  }
+
+  // Signals queued from previous runs may still be delivered after a new
+  // start, only those of the current run are forwarded.
+  void DataLoader::_onProgress( unsigned int run, const QString& stage,
+                                int percentage )
+  {
+    if( _current && _current->id == run )
+      emit progress( stage, percentage );
+  }
+
+  void DataLoader::_onFinished( unsigned int run )
+  {
+    if( _current && _current->id == run )
+      emit finished( );
+  }
+
+  void DataLoader::_onFailed( unsigned int run, const QString& error )
+  {
+    if( _current && _current->id == run )
+      emit failed( error );
+  }
+
+  void DataLoader::_onCanceled( unsigned int run )
+  {
+    if( _current && _current->id == run )
+      emit canceled( );
+  }
+
+  void DataLoader::_signal( Run& run, const char* method,
+                            QGenericArgument first, QGenericArgument second )
+  {
+    std::lock_guard< std::mutex > lock( run.mutex );
+
+    if( run.owner )
+      QMetaObject::invokeMethod( run.owner, method, Qt::QueuedConnection,
+                                 Q_ARG( unsigned int, run.id ), first, second );
+  }
+
+  void DataLoader::_run( std::shared_ptr< Run > run,
+                         const std::string& fileName,
+                         simil::TDataType fileType,
+                         const std::string& report, const vec3& scale )
+  {
+    auto stageStart = std::chrono::steady_clock::now( );
+
+    auto stageEnd = [ &run, &stageStart ]( const std::string& name )
+    {
+      const auto now = std::chrono::steady_clock::now( );
+      const double elapsed =
+          std::chrono::duration< double, std::milli >( now - stageStart ).count( );
+      LoadProfiler::phase( name, elapsed );
+      stageStart = now;
+
+      return !run->cancel;
+    };
+
+    auto progress = [ &run ]( const QString& stage, int percentage )
+    {
+      _signal( *run, "_onProgress", Q_ARG( QString, stage ),
+               Q_ARG( int, percentage ));
+    };
+
+    simil::SpikeData* spikeData = nullptr;
+
+    try
+    {
+      progress( tr( "Loading network and spikes" ), 0 );
+
+      std::string stage = "Spike data (streamed)";
+
+      run->spikeStream = SpikeStream::open( fileName, fileType, report, &spikeData );
+      if( !run->spikeStream )
+      {
+        bool fromCache = false;
+        spikeData = SpikeCache::load( fileName, fileType, report, &fromCache );
+        stage = fromCache ? "Spike data (cached)" : "Spike data";
+
+        // Large reports converted just now are streamed from the new cache
+        // too, instead of keeping the parsed spikes.
+        simil::SpikeData* network = nullptr;
+        if( !fromCache && ( run->spikeStream =
+              SpikeStream::open( fileName, fileType, report, &network )))
+        {
+          delete spikeData;
+          spikeData = network;
+        }
+      }
+
+      // Reduction works on in-memory spikes, streamed reports keep every gid
+      // of the network.
+      if( stageEnd( stage ) && !run->spikeStream )
+      {
+        progress( tr( "Reducing data to GIDs" ), 40 );
+        spikeData->reduceDataToGIDS( );
+      }
+
+      if( stageEnd( "GID reduction" ))
+      {
+        progress( tr( "Building player" ), 60 );
+        run->player = new simil::SpikesPlayer( );
+        run->player->LoadData( spikeData );
+        spikeData = nullptr;
+
+        LoadProfiler::counter( "GIDs", run->player->gids( ).size( ));
+        LoadProfiler::counter( "Spikes", run->spikeStream ? run->spikeStream->size( ) :
+                                         run->player->data( )->spikes( ).size( ));
+      }
+
+      if( run->player && stageEnd( "Player" ))
+      {
+        progress( tr( "Building positions" ), 80 );
+
+        buildPositions( run->positions, run->player->gids( ), run->player->positions( ),
+                        scale );
+
+        stageEnd( "Positions" );
+      }
+    }
+    catch( const std::exception& e )
+    {
+      std::cerr << "ERROR: " << e.what( ) << " " << __FILE__ << ":" << __LINE__ << std::endl;
+
+      if( spikeData )
+        delete spikeData;
+
+      run->running = false;
+      _signal( *run, "_onFailed",
+               Q_ARG( QString, QString::fromLocal8Bit( e.what( ))));
+      return;
+    }
+
+    if( spikeData )
+      delete spikeData;
+
+    run->running = false;
+
+    if( run->cancel )
+    {
+      _signal( *run, "_onCanceled" );
+      return;
+    }
+
+    progress( tr( "Creating particle system" ), 90 );
+    _signal( *run, "_onFinished" );
+  }
+}
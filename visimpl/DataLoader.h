@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2015-2020 VG-Lab/URJC.
+ *
+ * Authors: Sergio E. Galindo <sergio.galindo@urjc.es>
+ *
+ * This file is part of ViSimpl <https://github.com/vg-lab/visimpl>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef VISIMPL_DATALOADER_H_
+#define VISIMPL_DATALOADER_H_
+
+// Qt
+#include <QObject>
+#include <QString>
+
+// SimIL
+#include <simil/simil.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "types.h"
+
+namespace visimpl
+{
+  /*! \brief Loads simulation data on a worker thread.
+   *
+   * Runs the CPU side of dataset loading (spike data parsing, GID reduction,
+   * player construction and scaled positions) away from the GUI thread.
+   * Progress, completion and errors are signaled and delivered queued to the
+   * GUI thread, where the OpenGL dependent steps are performed afterwards.
+   *
+   * Cancellation is checked between stages, a running stage always
+   * completes. Canceled and replaced runs are never waited for, they finish
+   * on their own thread and their results and signals are discarded.
+   *
+   * Reports whose cache is large enough are streamed, only the network is
+   * loaded and spikes are left to a SpikeStream.
+   */
+  class DataLoader : public QObject
+  {
+    Q_OBJECT
+
+  public:
+
+    DataLoader( QObject* parent = nullptr );
+    virtual ~DataLoader( );
+
+    void start( const std::string& fileName, simil::TDataType fileType,
+                const std::string& report, const vec3& scale );
+
+    bool running( void ) const;
+
+    //! Takes ownership of the loaded player.
+    simil::SpikesPlayer* takePlayer( void );
+
+    //! Takes the scaled GID positions.
+    tGidPosMap takePositions( void );
+
+    //! Takes ownership of the spike stream, nullptr when spikes are in memory.
+    SpikeStream* takeSpikeStream( void );
+
+  signals:
+
+    void progress( const QString& stage, int percentage );
+    void finished( void );
+    void failed( const QString& error );
+    void canceled( void );
+
+  public slots:
+
+    void cancel( void );
+
+  protected slots:
+
+    void _onProgress( unsigned int run, const QString& stage, int percentage );
+    void _onFinished( unsigned int run );
+    void _onFailed( unsigned int run, const QString& error );
+    void _onCanceled( unsigned int run );
+
+  protected:
+
+    //! State of one load, shared with its worker thread.
+    struct Run
+    {
+      Run( unsigned int id_ );
+      ~Run( );
+
+      unsigned int id;
+
+      // Cleared when the run is replaced or the loader destroyed, the worker
+      // only signals the owner while holding the mutex.
+      std::mutex mutex;
+      DataLoader* owner;
+
+      std::atomic< bool > cancel;
+      std::atomic< bool > running;
+
+      simil::SpikesPlayer* player;
+      tGidPosMap positions;
+      SpikeStream* spikeStream;
+    };
+
+    static void _run( std::shared_ptr< Run > run, const std::string& fileName,
+                      simil::TDataType fileType, const std::string& report,
+                      const vec3& scale );
+
+    static void _signal( Run& run, const char* method,
+                         QGenericArgument first = QGenericArgument( ),
+                         QGenericArgument second = QGenericArgument( ));
+
+    void _release( void );
+
+    unsigned int _runs;
+    std::shared_ptr< Run > _current;
+  };
+}
+
+#endif /* VISIMPL_DATALOADER_H_ */
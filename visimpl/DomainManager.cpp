@@ -85,7 +85,10 @@ namespace visimpl
 
 #ifdef SIMIL_USE_BRION
     if( blueConfig )
+    {
+      LoadProfiler::Scope scope( "Neuron types" );
       _gidTypes = _loadNeuronTypes( *blueConfig );
+    }
 #endif
 
     _sourceSelected = new SourceMultiPosition( );
@@ -155,6 +158,37 @@ namespace visimpl
     _particleSystem->start();
   }
 
+  void DomainManager::particleSystem( prefr::ParticleSystem* particleSystem )
+  {
+    const auto baseColor = _modelBase->color;
+    const auto baseSize = _modelBase->size;
+    const auto offColor = _modelOff->color;
+    const auto offSize = _modelOff->size;
+
+    // Detaches the sources and marks the groups to be generated again.
+    clearView( );
+
+    _particleSystem = particleSystem;
+
+    _clusterSelected = new prefr::Cluster( );
+    _clusterUnselected = new prefr::Cluster( );
+    _clusterHighlighted = new prefr::Cluster( );
+
+    _particleSystem->addCluster( _clusterSelected );
+    _particleSystem->addCluster( _clusterUnselected );
+    _particleSystem->addCluster( _clusterHighlighted );
+
+    initializeParticleSystem( );
+
+    _modelBase->color = baseColor;
+    _modelBase->size = baseSize;
+    _modelOff->color = offColor;
+    _modelOff->size = offSize;
+
+    update( );
+    reloadPositions( );
+  }
+
   const tGidPosMap& DomainManager::positions( void ) const
   {
     return _gidPositions;
@@ -180,6 +214,42 @@ namespace visimpl
     std::for_each(_gidToParticle.cbegin(), _gidToParticle.cend(), expandBB);
   }
 
+  void DomainManager::rescalePositions( const tGidPosMap& positions )
+  {
+    const int positionBuckets = static_cast< int >( _gidPositions.bucket_count( ));
+
+    #pragma omp parallel for
+    for( int b = 0; b < positionBuckets; ++b )
+    {
+      for( auto it = _gidPositions.begin( b ); it != _gidPositions.end( b ); ++it )
+      {
+        const auto pos = positions.find( it->first );
+        if( pos != positions.end( ))
+          it->second = pos->second;
+      }
+    }
+
+    if(_gidToParticle.empty()) return;
+
+    const int buckets = static_cast< int >( _gidToParticle.bucket_count( ));
+
+    #pragma omp parallel for
+    for( int b = 0; b < buckets; ++b )
+    {
+      for( auto it = _gidToParticle.cbegin( b );
+           it != _gidToParticle.cend( b ); ++it )
+      {
+        auto particle = _particleSystem->particles( ).at( it->second );
+        particle.set_position( _gidPositions.at( it->first ));
+      }
+    }
+
+    _resetBoundingBox( );
+    for( const auto& gidPartId : _gidToParticle )
+      expandBoundingBox( _boundingBox.first, _boundingBox.second,
+                         _gidPositions.at( gidPartId.first ));
+  }
+
   const TGIDSet& DomainManager::gids( void ) const
   {
     return _gids;
@@ -387,6 +457,89 @@ namespace visimpl
     reloadPositions();
   }
 
+  void DomainManager::appendData(const TGIDSet& newGids,
+                                 const tGidPosMap& positions)
+  {
+    if( newGids.empty( ))
+      return;
+
+    for( const auto gid : newGids )
+      _gidPositions.emplace( gid, positions.at( gid ));
+
+    _gids.insert( newGids.begin( ), newGids.end( ));
+
+    // Groups and attributes spread the GIDs over their own sources, so those
+    // views are regenerated.
+    if( _mode != TMODE_SELECTION )
+    {
+      clearView();
+      update();
+      reloadPositions();
+      return;
+    }
+
+    auto availableParticles =
+        _particleSystem->retrieveUnused( newGids.size( ));
+
+    if( availableParticles.size( ) < newGids.size( ))
+    {
+      std::cerr << "Particle capacity exhausted, "
+                << newGids.size( ) - availableParticles.size( )
+                << " neurons will not be shown. "
+                << __FILE__ << ":" << __LINE__ << std::endl;
+    }
+
+    auto gidit = newGids.begin( );
+    for( auto particle : availableParticles )
+    {
+      const unsigned int id = particle.id( );
+      const auto& pos = _gidPositions.find( *gidit )->second;
+
+      _gidToParticle.insert( std::make_pair( *gidit, id ));
+      _particleToGID.insert( std::make_pair( id, *gidit ));
+
+      _gidSource.insert( std::make_pair( *gidit, _sourceSelected ));
+
+      particle.set_position( pos );
+
+      if( _selection.empty( ) || _selection.find( *gidit ) != _selection.end( ))
+        expandBoundingBox( _boundingBox.first, _boundingBox.second, pos );
+
+      ++gidit;
+    }
+
+    // Existing particles keep their ids, only the index ranges are rebuilt.
+    prefr::ParticleIndices indices;
+    prefr::ParticleIndices indicesSelected;
+    prefr::ParticleIndices indicesUnselected;
+
+    indices.reserve( _gidToParticle.size( ));
+    indicesSelected.reserve( _gidToParticle.size( ));
+    indicesUnselected.reserve( _gidToParticle.size( ));
+
+    for( const auto& gidPartId : _gidToParticle )
+    {
+      if( _selection.empty( ) ||
+          _selection.find( gidPartId.first ) != _selection.end( ))
+        indicesSelected.emplace_back( gidPartId.second );
+      else
+        indicesUnselected.emplace_back( gidPartId.second );
+
+      indices.emplace_back( gidPartId.second );
+    }
+
+    indicesSelected.shrink_to_fit( );
+    indicesUnselected.shrink_to_fit( );
+
+    _clusterSelected->particles( ).indices( indicesSelected );
+    _clusterUnselected->particles( ).indices( indicesUnselected );
+
+    _sourceSelected->setIdxTranslation( _particleToGID );
+
+    _particleSystem->detachSource( _sourceSelected );
+    _particleSystem->addSource( _sourceSelected, indices );
+  }
+
   void DomainManager::_resetBoundingBox( void )
   {
     _boundingBox.first = glm::vec3( std::numeric_limits< float >::max( ),
@@ -952,6 +1105,11 @@ namespace visimpl
     return _modelBase;
   }
 
+  prefr::ColorOperationModel* DomainManager::modelOff( void )
+  {
+    return _modelOff;
+  }
+
   void DomainManager::decay( float decayValue )
   {
     _decayValue = decayValue;
@@ -61,6 +61,11 @@ namespace visimpl
 
     void initializeParticleSystem( void );
 
+    /*! \brief Moves the domain to another particle system, used to grow
+     * the capacity. Transfer functions and the current view are kept.
+     */
+    void particleSystem( prefr::ParticleSystem* particleSystem );
+
     VisualGroup* addVisualGroupFromSelection( const std::string& name,
                                               bool overrideGIDs = false );
     VisualGroup* addVisualGroup( const GIDUSet& group_, const std::string& name,
@@ -80,6 +85,7 @@ namespace visimpl
     void update( void );
 
     void updateData(const TGIDSet& gids,const tGidPosMap& positions);
+    void appendData(const TGIDSet& newGids,const tGidPosMap& positions);
 
     void mode(const tVisualMode newMode );
     tVisualMode mode( void ) const;
@@ -105,6 +111,8 @@ namespace visimpl
     const tGidPosMap& positions( void ) const;
 
     void reloadPositions( void );
+    //! Takes the positions of the known GIDs from positions.
+    void rescalePositions( const tGidPosMap& positions );
 
 
     const TGIDSet& gids( void ) const;
@@ -112,6 +120,7 @@ namespace visimpl
     tBoundingBox boundingBox( void ) const;
 
     prefr::ColorOperationModel* modelSelectionBase( void );
+    prefr::ColorOperationModel* modelOff( void );
 
     const std::vector< std::pair< QColor, QColor >>& paletteColors( void ) const;
 
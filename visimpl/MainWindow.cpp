@@ -58,6 +58,7 @@
 #include <QGroupBox>
 #include <QPushButton>
 #include <QToolBox>
+#include <QProgressDialog>
 #include <QtGlobal>
 
 #include <thread>
@@ -88,6 +89,7 @@ namespace visimpl
     , _openGLWidget( nullptr )
     , _domainManager( nullptr )
     , _subsetEvents( nullptr )
+    , _subsetEventLoader( nullptr )
     , _summary( nullptr )
     , _simulationDock( nullptr )
     , _simSlider( nullptr )
@@ -136,6 +138,8 @@ namespace visimpl
     , _spinBoxClippingDist( nullptr )
     , _frameClippingColor( nullptr )
     , _buttonSelectionFromClippingPlanes( nullptr )
+    , _loadProgress( nullptr )
+    , _loadAttributes( false )
   {
     _ui->setupUi( this );
 
@@ -196,6 +200,11 @@ namespace visimpl
     connect( _ui->actionAbout, SIGNAL( triggered( void ) ), this,
              SLOT( dialogAbout( void ) ) );
 
+    _subsetEventLoader = new SubsetEventLoader( this );
+
+    connect( _subsetEventLoader, SIGNAL( finished( const QString& ) ), this,
+             SLOT( _onSubsetEventsLoaded( const QString& ) ) );
+
     connect( _ui->actionHome, SIGNAL( triggered( void ) ), _openGLWidget,
              SLOT( home( void ) ) );
 
@@ -205,6 +214,18 @@ namespace visimpl
     connect( _openGLWidget, SIGNAL( pickedSingle( unsigned int ) ), this,
              SLOT( updateSelectedStatsPickingSingle( unsigned int ) ) );
 
+    connect( _openGLWidget, SIGNAL( dataLoadProgress( const QString&, int ) ),
+             this, SLOT( _onDataLoadProgress( const QString&, int ) ) );
+
+    connect( _openGLWidget, SIGNAL( dataLoaded( void ) ), this,
+             SLOT( _onDataLoaded( void ) ) );
+
+    connect( _openGLWidget, SIGNAL( dataLoadFailed( const QString& ) ), this,
+             SLOT( _onDataLoadFailed( const QString& ) ) );
+
+    connect( _openGLWidget, SIGNAL( dataLoadCanceled( void ) ), this,
+             SLOT( _onDataLoadCanceled( void ) ) );
+
     QAction* actionTogglePause = new QAction( this );
     actionTogglePause->setShortcut( Qt::Key_Space );
 
@@ -290,32 +311,10 @@ namespace visimpl
                                    const std::string& reportLabel,
                                    const std::string& subsetEventFile )
   {
-    QApplication::setOverrideCursor(Qt::WaitCursor);
-
-    try
-    {
-      _openGLWidget->loadData( fileName, simil::TDataType::TBlueConfig,
-                               simulationType, reportLabel );
-    }
-    catch(const std::exception &e)
-    {
-      QApplication::restoreOverrideCursor();
-      const auto errorText = QString::fromLocal8Bit(e.what());
-      QMessageBox::critical(this, tr("Error loading BlueConfig file"), errorText, QMessageBox::Ok);
-      return;
-    }
-
-    configureComponents( );
-
-    openSubsetEventFile( subsetEventFile, false );
+    _startLoad( tr( "Error loading BlueConfig file" ), subsetEventFile, true );
 
-    _configurePlayer( );
-
-    QStringList attributes = {"Morphological type", "Functional type"};
-
-    _comboAttribSelection->addItems( attributes );
-
-    QApplication::restoreOverrideCursor();
+    _openGLWidget->loadData( fileName, simil::TDataType::TBlueConfig,
+                             simulationType, reportLabel );
   }
 
   void MainWindow::openBlueConfigThroughDialog( void )
@@ -381,28 +380,10 @@ namespace visimpl
                                  const std::string& activityFile,
                                  const std::string& subsetEventFile )
   {
-    QApplication::setOverrideCursor(Qt::WaitCursor);
-
-    try
-    {
-      _openGLWidget->loadData( networkFile, simil::TDataType::THDF5,
-                               simulationType, activityFile );
-    }
-    catch(const std::exception &e)
-    {
-      QApplication::restoreOverrideCursor();
-      const auto errorText = QString::fromLocal8Bit(e.what());
-      QMessageBox::critical(this, tr("Error loading HDF5 file"), errorText, QMessageBox::Ok);
-      return;
-    }
-
-    configureComponents( );
-
-    openSubsetEventFile( subsetEventFile, false );
-
-    _configurePlayer( );
+    _startLoad( tr( "Error loading HDF5 file" ), subsetEventFile );
 
-    QApplication::restoreOverrideCursor();
+    _openGLWidget->loadData( networkFile, simil::TDataType::THDF5,
+                             simulationType, activityFile );
   }
 
   void MainWindow::openCSVFile( const std::string& networkFile,
@@ -410,28 +391,87 @@ namespace visimpl
                                 const std::string& activityFile,
                                 const std::string& subsetEventFile )
   {
-    QApplication::setOverrideCursor(Qt::WaitCursor);
+    _startLoad( tr( "Error loading CSV file" ), subsetEventFile );
 
-    try
+    _openGLWidget->loadData( networkFile, simil::TDataType::TCSV,
+                             simulationType, activityFile );
+  }
+
+  void MainWindow::_startLoad( const QString& errorTitle,
+                               const std::string& subsetEventFile,
+                               bool attributes )
+  {
+    _loadErrorTitle = errorTitle;
+    _loadSubsetEventFile = subsetEventFile;
+    _loadAttributes = attributes;
+
+    if( !_loadProgress )
     {
-      _openGLWidget->loadData( networkFile, simil::TDataType::TCSV,
-                               simulationType, activityFile );
+      _loadProgress = new QProgressDialog( this );
+      _loadProgress->setWindowTitle( tr( "Loading data" ));
+      _loadProgress->setRange( 0, 100 );
+      _loadProgress->setMinimumDuration( 0 );
+      _loadProgress->setAutoClose( false );
+      _loadProgress->setAutoReset( false );
+      _loadProgress->setWindowModality( Qt::WindowModal );
+
+      connect( _loadProgress, SIGNAL( canceled( void ) ), _openGLWidget,
+               SLOT( cancelLoad( void ) ) );
     }
-    catch(const std::exception &e)
+
+    _loadProgress->setLabelText( tr( "Loading..." ));
+    _loadProgress->setValue( 0 );
+    _loadProgress->show( );
+  }
+
+  void MainWindow::_onDataLoadProgress( const QString& stage, int percentage )
+  {
+    if( _loadProgress )
     {
-      QApplication::restoreOverrideCursor();
-      const auto errorText = QString::fromLocal8Bit(e.what());
-      QMessageBox::critical(this, tr("Error loading CSV file"), errorText, QMessageBox::Ok);
-      return;
+      _loadProgress->setLabelText( stage );
+      _loadProgress->setValue( percentage );
     }
 
+    showStatusBarMessage( stage );
+  }
+
+  void MainWindow::_onDataLoaded( void )
+  {
     configureComponents( );
 
-    openSubsetEventFile( subsetEventFile, false );
+    openSubsetEventFile( _loadSubsetEventFile, false );
 
     _configurePlayer( );
 
-    QApplication::restoreOverrideCursor();
+    if( _loadAttributes )
+    {
+      QStringList attributes = {"Morphological type", "Functional type"};
+
+      _comboAttribSelection->addItems( attributes );
+    }
+
+    if( _loadProgress )
+      _loadProgress->hide( );
+
+    LoadProfiler::report( );
+
+    showStatusBarMessage( tr( "Data loaded." ));
+  }
+
+  void MainWindow::_onDataLoadFailed( const QString& error )
+  {
+    if( _loadProgress )
+      _loadProgress->hide( );
+
+    QMessageBox::critical( this, _loadErrorTitle, error, QMessageBox::Ok );
+  }
+
+  void MainWindow::_onDataLoadCanceled( void )
+  {
+    if( _loadProgress )
+      _loadProgress->hide( );
+
+    showStatusBarMessage( tr( "Data loading canceled." ));
   }
 
 #ifdef SIMIL_WITH_REST_API
@@ -440,12 +480,16 @@ namespace visimpl
                                      const std::string& port,
                                      const std::string& )
   {
+    _loadErrorTitle = tr( "Error loading REST data" );
+    _loadSubsetEventFile.clear( );
+    _loadAttributes = false;
+
+    // Components are configured from _onDataLoaded once the first network
+    // batch has been received.
     _openGLWidget->loadRestData( url, simil::TDataType::TREST, simulationType,
                                  port );
 
-    configureComponents( );
-
-    _configurePlayer( );
+    showStatusBarMessage( tr( "Waiting for REST data..." ));
   }
 #endif
 
@@ -475,6 +519,9 @@ namespace visimpl
   void MainWindow::openSubsetEventFile( const std::string& filePath,
                                         bool append )
   {
+    // Subsets still being read belong to a previous file or dataset.
+    _subsetEventLoader->cancel( );
+
     if ( filePath.empty( ) || !_subsetEvents )
       return;
 
@@ -485,37 +532,33 @@ namespace visimpl
     if(!eventsFile.exists())
       return;
 
-    QString errorText;
-    try
-    {
-      if(eventsFile.suffix().toLower().compare("json") == 0)
-      {
-        _subsetEvents->loadJSON( filePath );
-      }
-      else if(eventsFile.suffix().toLower().compare("h5") == 0)
-      {
-        _subsetEvents->loadH5( filePath );
-      }
-      else
-      {
-        errorText = tr("Events file not supported: %1").arg(eventsFile.absoluteFilePath());
-      }
-    }
-    catch(const std::exception &e)
+    // Parsed on a worker thread, merged in _onSubsetEventsLoaded.
+    if( !_subsetEventLoader->load( filePath, false ))
     {
-      errorText = QString::fromLocal8Bit(e.what());
+      const auto errorText = tr("Events file not supported: %1").arg(eventsFile.absoluteFilePath());
+      QMessageBox::warning(this, tr("Error loading Events file"), errorText, QMessageBox::Ok);
+      return;
     }
 
+    showStatusBarMessage( tr( "Loading %1..." ).arg( eventsFile.fileName( )));
+  }
+
+  void MainWindow::_onSubsetEventsLoaded( const QString& errorText )
+  {
     if(!errorText.isEmpty())
     {
       QMessageBox::warning(this, tr("Error loading Events file"), errorText, QMessageBox::Ok);
       return;
     }
 
+    _subsetEventLoader->merge( _subsetEvents );
+
     _subsetImporter->reload(_subsetEvents);
 
     _openGLWidget->subsetEventsManager(_subsetEvents);
     _openGLWidget->showEventsActivityLabels(_ui->actionShowEventsActivity->isChecked());
+
+    showStatusBarMessage( tr( "Subsets and events loaded." ));
   }
 
   void MainWindow::openSubsetEventsFileThroughDialog( void )
@@ -916,13 +959,23 @@ namespace visimpl
     layoutScale->addWidget( _circuitScaleZ );
 
     QComboBox* comboShader = new QComboBox( );
-    comboShader->addItems( {"Default", "Solid"} );
+    comboShader->addItems( {"Default", "Solid", "Transparent (OIT)"} );
     comboShader->setCurrentIndex( 0 );
 
+    QCheckBox* checkGPUDecay = new QCheckBox( tr( "GPU decay" ));
+    checkGPUDecay->setToolTip( tr( "Compute activity decay on the GPU "
+                                   "(selection mode only)" ));
+
+    QCheckBox* checkLOD = new QCheckBox( tr( "Level of detail" ));
+    checkLOD->setToolTip( tr( "Aggregate distant neurons into impostors "
+                              "(selection mode only)" ));
+
     QGroupBox* shaderGB = new QGroupBox( "Shader Configuration" );
     QHBoxLayout* shaderLayout = new QHBoxLayout( );
     shaderLayout->addWidget( new QLabel( "Current shader: " ) );
     shaderLayout->addWidget( comboShader );
+    shaderLayout->addWidget( checkGPUDecay );
+    shaderLayout->addWidget( checkLOD );
     shaderGB->setLayout( shaderLayout );
 
     QGroupBox* dFunctionGB = new QGroupBox( "Decay function" );
@@ -1152,6 +1205,12 @@ namespace visimpl
     connect( comboShader, SIGNAL( currentIndexChanged( int ) ), _openGLWidget,
              SLOT( changeShader( int ) ) );
 
+    connect( checkGPUDecay, SIGNAL( toggled( bool ) ), _openGLWidget,
+             SLOT( gpuDecay( bool ) ) );
+
+    connect( checkLOD, SIGNAL( toggled( bool ) ), _openGLWidget,
+             SLOT( levelOfDetail( bool ) ) );
+
     connect( _tfWidget, SIGNAL( colorChanged( void ) ), this,
              SLOT( UpdateSimulationColorMapping( void ) ) );
     connect( _tfWidget, SIGNAL( colorChanged( void ) ), this,
@@ -1241,6 +1300,7 @@ namespace visimpl
       simil::SpikesPlayer* spikesPlayer =
         dynamic_cast< simil::SpikesPlayer* >( _openGLWidget->player( ) );
 
+      _summary->spikeStream( _openGLWidget->spikeStream( ));
       _summary->Init( spikesPlayer->data( ) );
 
       _summary->simulationPlayer( _openGLWidget->player( ) );
@@ -46,6 +46,7 @@ class QRadioButton;
 class QGroupBox;
 class QPushButton;
 class QToolBox;
+class QProgressDialog;
 
 namespace Ui
 {
@@ -189,7 +190,18 @@ namespace visimpl
     void clearSelection( void );
     void selectionFromPlanes( void );
 
+    void _onDataLoadProgress( const QString& stage, int percentage );
+    void _onDataLoaded( void );
+    void _onDataLoadFailed( const QString& error );
+    void _onDataLoadCanceled( void );
+
+    void _onSubsetEventsLoaded( const QString& errorText );
+
   protected:
+    void _startLoad( const QString& errorTitle,
+                     const std::string& subsetEventFile,
+                     bool attributes = false );
+
     void _initSimControlDock( void );
     void _initPlaybackDock( void );
     void _initSummaryWidget( void );
@@ -239,6 +251,7 @@ namespace visimpl
     OpenGLWidget* _openGLWidget;
     DomainManager* _domainManager;
     simil::SubsetEventManager* _subsetEvents;
+    SubsetEventLoader* _subsetEventLoader;
     visimpl::Summary* _summary;
 
     scoop::ColorPalette _colorPalette;
@@ -307,5 +320,11 @@ namespace visimpl
     QDoubleSpinBox* _spinBoxClippingDist;
     QPushButton* _frameClippingColor;
     QPushButton* _buttonSelectionFromClippingPlanes;
+
+    // Asynchronous loading
+    QProgressDialog* _loadProgress;
+    QString _loadErrorTitle;
+    std::string _loadSubsetEventFile;
+    bool _loadAttributes;
   };
 } // namespace visimpl
@@ -27,18 +27,21 @@
 
 // Qt
 #include <QOpenGLContext>
+#include <QOpenGLExtraFunctions>
 #include <QMouseEvent>
 #include <QColorDialog>
 #include <QShortcut>
 #include <QGraphicsOpacityEffect>
 #include <QLabel>
 #include <QDir>
+#include <QTimer>
 
 // C++
 #include <sstream>
 #include <string>
 #include <iostream>
 #include <map>
+#include <mutex>
 
 // GLM
 #include <glm/glm.hpp>
@@ -69,6 +72,9 @@ namespace visimpl
   const InitialConfig _initialConfigSimREST =
         std::make_tuple( 0.005f, 20.0f, 0.1f, 500.0f );
 
+  // Milliseconds between checks for newly received REST data.
+  constexpr int restPollInterval = 250;
+
   constexpr float invRGBInt = 1.0f / 255;
 
   OpenGLWidget::OpenGLWidget( QWidget* parent_,
@@ -89,6 +95,11 @@ namespace visimpl
   , _wireframe( false )
   , _camera( nullptr )
   , _lastCameraPosition( 0, 0, 0)
+  , _sortCameraPosition( 0, 0, 0 )
+  , _sortDriftTolerance( 0.05f )
+  , _flagSortParticles( false )
+  , _sortTimeAcc( 0.0 )
+  , _bufferUpdateTimeAcc( 0.0 )
   , _scaleFactor( 1.0f, 1.0f, 1.0f )
   , _scaleFactorExternal( false )
   , _focusOnSelection( true )
@@ -108,14 +119,39 @@ namespace visimpl
   , _shaderParticlesCurrent( nullptr )
   , _shaderParticlesDefault( nullptr )
   , _shaderParticlesSolid( nullptr )
+  , _shaderParticlesOIT( nullptr )
+  , _shaderCompositeOIT( nullptr )
   , _shaderPicking( nullptr )
   , _shaderClippingPlanes( nullptr )
+  , _startupBegin( std::chrono::steady_clock::now( ))
+  , _startupActive( false )
+  , _cameraUniforms( nullptr )
+  , _oitFramebuffer( 0 )
+  , _oitAccumTexture( 0 )
+  , _oitWeightTexture( 0 )
+  , _oitDepthBuffer( 0 )
+  , _oitVAO( 0 )
+  , _oitWidth( 0 )
+  , _oitHeight( 0 )
+  , _decayRenderer( nullptr )
+  , _gpuDecay( false )
+  , _gpuDecayRunning( false )
+  , _flagUpdateDecayRenderer( false )
+  , _flagUpdateDecayData( false )
+  , _flagUpdateDecaySelection( false )
+  , _lodRenderer( nullptr )
+  , _lod( false )
+  , _lodRunning( false )
+  , _dataLoader( nullptr )
+  , _spikeStream( nullptr )
   , _particleSystem( nullptr )
+  , _particleCapacity( 0 )
   , _pickRenderer( nullptr )
   , _simulationType( simil::TSimulationType::TSimNetwork )
   , _player( nullptr )
 #ifdef SIMIL_WITH_REST_API
   , _importer( nullptr )
+  , _restTimer( nullptr )
 #endif
   , _clippingPlaneLeft( nullptr )
   , _clippingPlaneRight( nullptr )
@@ -223,7 +259,7 @@ namespace visimpl
       "margin: 10px;"
       " border-radius: 10px;}" );
     _fpsLabel->setVisible( _showFps );
-    _fpsLabel->setMaximumSize( 100, 50 );
+    _fpsLabel->setMaximumSize( 200, 70 );
 
     _labelCurrentTime = new QLabel( );
     _labelCurrentTime->setStyleSheet(
@@ -261,6 +297,27 @@ namespace visimpl
     if( _shaderParticlesSolid )
       delete _shaderParticlesSolid;
 
+    if( _shaderParticlesOIT )
+      delete _shaderParticlesOIT;
+
+    if( _shaderCompositeOIT )
+      delete _shaderCompositeOIT;
+
+    if( _oitFramebuffer || _decayRenderer || _lodRenderer || _cameraUniforms )
+    {
+      makeCurrent( );
+      _releaseOITBuffers( );
+
+      if( _decayRenderer )
+        delete _decayRenderer;
+
+      if( _lodRenderer )
+        delete _lodRenderer;
+
+      if( _cameraUniforms )
+        delete _cameraUniforms;
+    }
+
     if( _shaderPicking )
       delete _shaderPicking;
 
@@ -269,6 +326,9 @@ namespace visimpl
 
     if( _player )
       delete _player;
+
+    if( _spikeStream )
+      delete _spikeStream;
 #ifdef SIMIL_WITH_REST_API
     if(_importer)
       delete _importer;
@@ -280,48 +340,34 @@ namespace visimpl
                                simil::TSimulationType simulationType,
                                const std::string& report)
   {
-    makeCurrent( );
-
     _simulationType = simulationType;
 
     _deltaTime = 0.5f;
 
-    try
-    {
-      auto spikeData = new simil::SpikeData( fileName, fileType, report );
-      spikeData->reduceDataToGIDS( );
-
-      _player = new simil::SpikesPlayer( );
-      _player->LoadData( spikeData );
-    }
-    catch(const std::exception &e)
-    {
-      std::cerr << "ERROR: " << e.what() << " " << __FILE__ << ":" << __LINE__ << std::endl;
-      throw;
-    }
-
-    InitialConfig config;
-    float scale = 1.0f;
+    // Startup stages are timed from here, not from the widget creation that
+    // may precede the file dialog.
+    _startupBegin = std::chrono::steady_clock::now( );
+    _startupActive = LoadProfiler::enabled( );
 
     switch (fileType)
     {
       case simil::TBlueConfig:
-        config = _initialConfigSimBlueConfig;
+        _loadConfig = _initialConfigSimBlueConfig;
         break;
       case simil::THDF5:
-        config = _initialConfigSimH5;
+        _loadConfig = _initialConfigSimH5;
         break;
       case simil::TCSV:
-        config = _initialConfigSimCSV;
+        _loadConfig = _initialConfigSimCSV;
         break;
       case simil::TREST:
-        config = _initialConfigSimREST;
+        _loadConfig = _initialConfigSimREST;
         break;
       default:
         break;
     }
 
-    scale = std::get< T_SCALE >( config );
+    const float scale = std::get< T_SCALE >( _loadConfig );
 
     if( !_scaleFactorExternal )
       _scaleFactor = vec3( scale, scale, scale );
@@ -331,11 +377,71 @@ namespace visimpl
               << ", " << _scaleFactor.z
               << std::endl;
 
+    // Parsing runs on the loader thread, the OpenGL setup is finished in
+    // _onDataLoaded once it is done.
+    if( !_dataLoader )
+    {
+      _dataLoader = new DataLoader( this );
+
+      connect( _dataLoader, SIGNAL( progress( const QString&, int )),
+               this, SIGNAL( dataLoadProgress( const QString&, int )));
+      connect( _dataLoader, SIGNAL( failed( const QString& )),
+               this, SIGNAL( dataLoadFailed( const QString& )));
+      connect( _dataLoader, SIGNAL( canceled( void )),
+               this, SIGNAL( dataLoadCanceled( void )));
+      connect( _dataLoader, SIGNAL( finished( void )),
+               this, SLOT( _onDataLoaded( void )));
+    }
+
+    _dataLoader->start( fileName, fileType, report, _scaleFactor );
+  }
+
+  void OpenGLWidget::cancelLoad( void )
+  {
+    if( _dataLoader )
+      _dataLoader->cancel( );
+  }
+
+  void OpenGLWidget::_growParticleSystem( unsigned int required )
+  {
+    unsigned int capacity = std::max( 1u, _particleCapacity );
+    while( capacity < required )
+      capacity *= 2;
+
+    makeCurrent( );
+
+    // Not deleted, like the systems of previous datasets: the visual groups
+    // own clusters and sources that were registered in it.
+    _particleSystem = new prefr::ParticleSystem( capacity, _camera );
+    _particleCapacity = capacity;
+
+    _domainManager->particleSystem( _particleSystem );
+
+    _pickRenderer =
+        dynamic_cast< prefr::GLPickRenderer* >( _particleSystem->renderer( ));
+
+    _pickRenderer->glPickProgram( _shaderPicking );
+    _pickRenderer->setDefaultFBO( defaultFramebufferObject( ));
+
+    // New particles start without activity.
+    if( _player )
+      _backtraceSimulation( );
+  }
+
+  void OpenGLWidget::_onDataLoaded( void )
+  {
+    makeCurrent( );
+
+    _player = _dataLoader->takePlayer( );
+    _gidPositions = _dataLoader->takePositions( );
+    _spikeStream = _dataLoader->takeSpikeStream( );
+
+    // Loader stages and the particle system setup are timed by LoadProfiler.
     createParticleSystem(  );
 
-    simulationDeltaTime( std::get< T_DELTATIME >( config ) );
-    simulationStepsPerSecond( std::get< T_STEPS_PER_SEC >( config ) );
-    changeSimulationDecayValue( std::get< T_DECAY >( config ) );
+    simulationDeltaTime( std::get< T_DELTATIME >( _loadConfig ) );
+    simulationStepsPerSecond( std::get< T_STEPS_PER_SEC >( _loadConfig ) );
+    changeSimulationDecayValue( std::get< T_DECAY >( _loadConfig ) );
 
   #ifdef VISIMPL_USE_ZEROEQ
     if( !_zeqUri.empty( ))
@@ -357,6 +463,8 @@ namespace visimpl
   #endif
     this->_paint = true;
     update( );
+
+    emit dataLoaded( );
   }
 
 #ifdef SIMIL_WITH_REST_API
@@ -365,48 +473,27 @@ namespace visimpl
                                simil::TSimulationType simulationType,
                                const std::string& port)
   {
-
-    makeCurrent( );
-
-    InitialConfig config;
-    float scale = 1.0f;
-
-    config = _initialConfigSimREST;
+    _loadConfig = _initialConfigSimREST;
 
     _simulationType = simulationType;
 
-    _deltaTime = std::get< T_DELTATIME >( config );
+    _deltaTime = std::get< T_DELTATIME >( _loadConfig );
 
     _importer = new simil::LoaderRestData( );
     static_cast<simil::LoaderRestData*>(_importer)->deltaTime(_deltaTime);
 
-    std::cout << "--------------------------------------" << std::endl;
-    std::cout << "Network" << std::endl;
-    std::cout << "--------------------------------------" << std::endl;
-
+    // The REST loader keeps filling the network and the simulation data from
+    // its own thread, so the player is built on them right away and
+    // _pollRestData picks up whatever has arrived.
     simil::Network* netData = _importer->loadNetwork(url,port);
 
     simil::SimulationData* simData = _importer->loadSimulationData(url,port);
 
-    // @felix REFACTOR NEEDED: if we continue the network will be empty as the
-    // data has not yet been received and nothing will be shown.
-    std::this_thread::sleep_for( std::chrono::milliseconds( 5000 ) );
-    //
-
-    std::cout << "Loaded GIDS: " << netData->gids( ).size( ) << std::endl;
-    std::cout << "Loaded positions: " << netData->positions( ).size( )
-              << std::endl;
-
-    std::cout << "--------------------------------------" << std::endl;
-    std::cout << "Spikes" << std::endl;
-    std::cout << "--------------------------------------" << std::endl;
-
     simil::SpikesPlayer* spPlayer = new simil::SpikesPlayer();
     spPlayer->LoadData( netData, simData );
     _player = spPlayer;
-    //_player->deltaTime( _deltaTime );
 
-    scale = std::get< T_SCALE >( config );
+    const float scale = std::get< T_SCALE >( _loadConfig );
 
     if( !_scaleFactorExternal )
       _scaleFactor = vec3( scale, scale, scale );
@@ -416,13 +503,52 @@ namespace visimpl
               << ", " << _scaleFactor.z
               << std::endl;
 
-    createParticleSystem( );
+    subsetEventsManager(netData->subsetsEvents());
 
-    simulationDeltaTime( std::get< T_DELTATIME >( config ) );
-    simulationStepsPerSecond( std::get< T_STEPS_PER_SEC >( config ) );
-    changeSimulationDecayValue( std::get< T_DECAY >( config ) );
+    if( !_restTimer )
+    {
+      _restTimer = new QTimer( this );
+      connect( _restTimer, SIGNAL( timeout( void )),
+               this, SLOT( _pollRestData( void )));
+    }
 
-    subsetEventsManager(netData->subsetsEvents());
+    _restTimer->start( restPollInterval );
+  }
+
+  void OpenGLWidget::_pollRestData( void )
+  {
+    if( !_player || !_copyRestNetwork( ))
+      return;
+
+    // Positions may arrive after their GIDs, only positioned neurons are used.
+    const size_t available = std::min( _restGIDs.size( ),
+                                       _restPositions.size( ));
+
+    if( _particleSystem )
+    {
+      if( available > _gidPositions.size( ))
+      {
+        _flagNewData = true;
+        update( );
+      }
+
+      return;
+    }
+
+    // Streams may never deliver the whole network, so the views start on
+    // the first positioned neurons and grow from there.
+    if( available == 0 )
+      return;
+
+    std::cout << "Loaded GIDS: " << available << std::endl;
+
+    makeCurrent( );
+
+    createParticleSystem( );
+
+    simulationDeltaTime( std::get< T_DELTATIME >( _loadConfig ) );
+    simulationStepsPerSecond( std::get< T_STEPS_PER_SEC >( _loadConfig ) );
+    changeSimulationDecayValue( std::get< T_DECAY >( _loadConfig ) );
 
   #ifdef VISIMPL_USE_ZEROEQ
     try
@@ -441,8 +567,49 @@ namespace visimpl
   #endif
     this->_paint = true;
     update( );
+
+    emit dataLoaded( );
+  }
+
+  bool OpenGLWidget::_copyRestNetwork( void )
+  {
+    // The REST loader appends to the network from its own thread, so its
+    // containers are only read under the loader's lock and the views work on
+    // the copy.
+    auto loader = static_cast< simil::LoaderRestData* >( _importer );
+    std::lock_guard< std::mutex > lock( loader->mutex( ));
+
+    const auto& gids = _player->gids( );
+    const auto& positions = _player->positions( );
+
+    if( gids.size( ) == _restGIDs.size( ) &&
+        positions.size( ) == _restPositions.size( ))
+      return false;
+
+    _restGIDs = gids;
+    _restPositions = positions;
+
+    return true;
+  }
+#endif
+
+  const TGIDSet& OpenGLWidget::_networkGIDs( void ) const
+  {
+#ifdef SIMIL_WITH_REST_API
+    if( _importer )
+      return _restGIDs;
+#endif
+    return _player->gids( );
   }
+
+  const TPosVect& OpenGLWidget::_networkPositions( void ) const
+  {
+#ifdef SIMIL_WITH_REST_API
+    if( _importer )
+      return _restPositions;
 #endif
+    return _player->positions( );
+  }
 
   void OpenGLWidget::initializeGL( void )
   {
@@ -458,6 +625,8 @@ namespace visimpl
 
     glLineWidth( 1.5 );
 
+    _startupStage( "GL context" );
+
     _then = std::chrono::system_clock::now( );
     _lastFrame = std::chrono::system_clock::now( );
 
@@ -481,8 +650,26 @@ namespace visimpl
 
     const float currentTime = _player->currentTime( );
 
-    _domainManager->processInput( _player->spikesNow( ), prevTime,
-                             currentTime, false );
+    if( _spikeStream )
+    {
+      _processInput( _spikesBetween( prevTime, currentTime, _streamSpikes ),
+                     prevTime, currentTime, false );
+      _spikeStream->prefetch( currentTime );
+    }
+    else
+    {
+      _processInput( _player->spikesNow( ), prevTime,
+                               currentTime, false );
+    }
+  }
+
+  simil::SpikesCRange OpenGLWidget::_spikesBetween( float begin, float end,
+                                                    simil::TSpikes& buffer )
+  {
+    if( _spikeStream )
+      return _spikeStream->spikesBetween( begin, end, buffer );
+
+    return _player->spikesBetween( begin, end );
   }
 
   void OpenGLWidget::_configurePreviousStep( void )
@@ -505,7 +692,7 @@ namespace visimpl
 
       _backtraceSimulation( );
 
-      _sbsStepSpikes = _player->spikesBetween( _sbsBeginTime, _sbsEndTime );
+      _sbsStepSpikes = _spikesBetween( _sbsBeginTime, _sbsEndTime, _sbsStreamSpikes );
 
       _sbsCurrentTime = _sbsBeginTime;
       _sbsCurrentSpike = _sbsStepSpikes.first;
@@ -531,7 +718,7 @@ namespace visimpl
       _backtraceSimulation( );
     }
 
-    _sbsStepSpikes = _player->spikesBetween( _sbsBeginTime, _sbsEndTime );
+    _sbsStepSpikes = _spikesBetween( _sbsBeginTime, _sbsEndTime, _sbsStreamSpikes );
 
     _sbsCurrentTime = _sbsBeginTime;
     _sbsCurrentSpike = _sbsStepSpikes.first;
@@ -570,7 +757,7 @@ namespace visimpl
       if( spikeIt != _sbsCurrentSpike )
       {
         simil::SpikesCRange frameSpikes = std::make_pair( _sbsCurrentSpike, spikeIt );
-        _domainManager->processInput( frameSpikes, _sbsCurrentTime, nextTime, false );
+        _processInput( frameSpikes, _sbsCurrentTime, nextTime, false );
       }
 
       _sbsCurrentTime = nextTime;
@@ -584,10 +771,167 @@ namespace visimpl
     float startTime = std::max( 0.0f, endTime - _domainManager->decay( ));
     if(startTime < endTime)
     {
-      const auto context = _player->spikesBetween( startTime, endTime );
+      const auto context = _spikesBetween( startTime, endTime, _streamSpikes );
 
       if( context.first != context.second )
-        _domainManager->processInput( context, startTime, endTime, true );
+        _processInput( context, startTime, endTime, true );
+    }
+  }
+
+  void OpenGLWidget::_processInput( const simil::SpikesCRange& spikes_,
+                                    float begin, float end, bool clear )
+  {
+    if( _lodActive( ))
+      _lodRenderer->processInput( spikes_, begin, end, clear );
+    else if( _gpuDecayActive( ))
+      _decayRenderer->processInput( spikes_, begin, end, clear );
+    else
+      _domainManager->processInput( spikes_, begin, end, clear );
+  }
+
+  void OpenGLWidget::gpuDecay( bool enabled )
+  {
+    _gpuDecay = enabled;
+    _flagUpdateDecayRenderer = true;
+
+    update( );
+  }
+
+  bool OpenGLWidget::gpuDecay( void ) const
+  {
+    return _gpuDecay;
+  }
+
+  void OpenGLWidget::levelOfDetail( bool enabled )
+  {
+    _lod = enabled;
+    _flagUpdateDecayRenderer = true;
+
+    update( );
+  }
+
+  bool OpenGLWidget::levelOfDetail( void ) const
+  {
+    return _lod;
+  }
+
+  bool OpenGLWidget::_gpuDecayActive( void ) const
+  {
+    return _gpuDecayRunning;
+  }
+
+  bool OpenGLWidget::_lodActive( void ) const
+  {
+    return _lodRunning;
+  }
+
+  void OpenGLWidget::_updateDecayRenderer( void )
+  {
+    // Only position or particle set changes rebuild the renderer data, the
+    // rest updates the transfer functions and selection flags in place.
+    const bool dataChanged = _flagUpdateDecayData;
+    const bool selectionChanged = _flagUpdateDecaySelection;
+
+    _flagUpdateDecayRenderer = false;
+    _flagUpdateDecayData = false;
+    _flagUpdateDecaySelection = false;
+
+    if( !_player || !_domainManager )
+      return;
+
+    // Only the selection mode is decayed on the GPU or aggregated, groups
+    // and attributes keep using their own prefr models.
+    if(( !_gpuDecay && !_lod ) || _domainManager->mode( ) != TMODE_SELECTION )
+    {
+      if( _gpuDecayRunning || _lodRunning )
+      {
+        // CPU particles were not updated meanwhile.
+        _gpuDecayRunning = false;
+        _lodRunning = false;
+        _domainManager->resetParticles( );
+        _backtraceSimulation( );
+        _flagUpdateRender = true;
+      }
+      return;
+    }
+
+    const float endTime = _player->currentTime( );
+    const float startTime = std::max( 0.0f, endTime - _domainManager->decay( ));
+
+    // Level of detail takes precedence, it already bounds the drawn elements.
+    if( _lod )
+    {
+      if( !_lodRenderer )
+      {
+        _lodRenderer = new LODRenderer( );
+        _lodRenderer->init( );
+      }
+
+      const bool rebuild = !_lodRunning || dataChanged;
+
+      if( rebuild )
+        _lodRenderer->setData( _networkGIDs( ), _gidPositions,
+                               _domainManager->selection( ));
+      else if( selectionChanged )
+        _lodRenderer->selection( _domainManager->selection( ));
+
+      _lodRenderer->transferFunction( _domainManager->modelSelectionBase( ));
+      _lodRenderer->offModel( _domainManager->modelOff( ));
+
+      // Node activity depends on the decay and on the selected neurons.
+      const bool replay = rebuild || selectionChanged ||
+                          _lodRenderer->decay( ) != _domainManager->decay( );
+
+      _lodRenderer->decay( _domainManager->decay( ));
+
+      if( replay )
+      {
+        _lodRenderer->reset( endTime );
+
+        if( startTime < endTime )
+          _lodRenderer->processInput( _spikesBetween( startTime, endTime, _streamSpikes ),
+                                      startTime, endTime, false );
+      }
+
+      _lodRunning = true;
+      _gpuDecayRunning = false;
+      return;
+    }
+
+    if( !_decayRenderer )
+    {
+      _decayRenderer = new DecayRenderer( );
+      _decayRenderer->init( );
+    }
+
+    const bool rebuild = !_gpuDecayRunning || dataChanged;
+
+    if( rebuild )
+      _decayRenderer->setData( _networkGIDs( ), _gidPositions,
+                               _domainManager->selection( ));
+    else if( selectionChanged )
+      _decayRenderer->selection( _domainManager->selection( ));
+
+    _decayRenderer->transferFunction( _domainManager->modelSelectionBase( ));
+    _decayRenderer->offModel( _domainManager->modelOff( ));
+
+    // Spike times are kept for every neuron, only a longer decay needs the
+    // spikes that fell out of the previous window.
+    const bool replay = rebuild ||
+                        _decayRenderer->decay( ) != _domainManager->decay( );
+
+    _decayRenderer->decay( _domainManager->decay( ));
+
+    _gpuDecayRunning = true;
+    _lodRunning = false;
+
+    if( replay )
+    {
+      _decayRenderer->reset( endTime );
+
+      if( startTime < endTime )
+        _decayRenderer->processInput( _spikesBetween( startTime, endTime, _streamSpikes ),
+                                      startTime, endTime, false );
     }
   }
 
@@ -613,9 +957,274 @@ namespace visimpl
       case T_SHADER_SOLID:
         _shaderParticlesCurrent = _shaderParticlesSolid;
         break;
+      case T_SHADER_OIT:
+        _shaderParticlesCurrent = _shaderParticlesOIT;
+        break;
       default:
         break;
     }
+
+    _buildProgram( _shaderParticlesCurrent );
+
+    _flagChangeShader = false;
+
+    // Depth order is not kept while rendering order independent.
+    _flagUpdateRender = true;
+  }
+
+  const ProgramUniforms& OpenGLWidget::_uniforms( const reto::ShaderProgram* program )
+  {
+    const unsigned int id = program->program( );
+
+    auto uniforms = _programUniforms.find( id );
+    if( uniforms == _programUniforms.end( ))
+    {
+      uniforms = _programUniforms.insert( std::make_pair( id, ProgramUniforms( ))).first;
+      uniforms->second.resolve( id );
+    }
+
+    return uniforms->second;
+  }
+
+  void OpenGLWidget::_createPrograms( const std::vector< std::string >& sources )
+  {
+    _shaderParticlesDefault = new reto::ShaderProgram( );
+    _shaderParticlesSolid = new reto::ShaderProgram( );
+    _shaderParticlesOIT = new reto::ShaderProgram( );
+    _shaderCompositeOIT = new reto::ShaderProgram( );
+    _shaderPicking = new prefr::RenderProgram( );
+    _shaderClippingPlanes = new reto::ShaderProgram( );
+
+    _pendingPrograms.clear( );
+    _pendingPrograms[ _shaderParticlesDefault ] = { sources[ 0 ], sources[ 1 ], true };
+    _pendingPrograms[ _shaderParticlesSolid ] = { sources[ 0 ], sources[ 2 ], true };
+    _pendingPrograms[ _shaderPicking ] = { sources[ 3 ], sources[ 4 ], false };
+    _pendingPrograms[ _shaderClippingPlanes ] = { sources[ 5 ], sources[ 6 ], true };
+
+    // Order independent transparency reuses the particle vertex shader.
+    _pendingPrograms[ _shaderParticlesOIT ] =
+      { sources[ 0 ], prefr::prefrFragmentShaderOIT, true };
+    _pendingPrograms[ _shaderCompositeOIT ] =
+      { prefr::oitCompositeVertCode, prefr::oitCompositeFragCode, false };
+  }
+
+  void OpenGLWidget::_deletePrograms( void )
+  {
+    for( reto::ShaderProgram* program :
+         { _shaderParticlesDefault, _shaderParticlesSolid, _shaderParticlesOIT,
+           _shaderCompositeOIT, static_cast< reto::ShaderProgram* >( _shaderPicking ),
+           _shaderClippingPlanes })
+      delete program;
+
+    // GL reuses the ids of deleted programs, locations resolved for them
+    // would be returned for unrelated programs.
+    _programUniforms.clear( );
+
+    _shaderParticlesDefault = nullptr;
+    _shaderParticlesSolid = nullptr;
+    _shaderParticlesOIT = nullptr;
+    _shaderCompositeOIT = nullptr;
+    _shaderPicking = nullptr;
+    _shaderClippingPlanes = nullptr;
+
+    _pendingPrograms.clear( );
+  }
+
+  bool OpenGLWidget::_buildProgram( reto::ShaderProgram* program )
+  {
+    auto pending = _pendingPrograms.find( program );
+    if( pending == _pendingPrograms.end( ))
+      return true;
+
+    const auto start = std::chrono::steady_clock::now( );
+
+    bool fromCache = false;
+    const bool success =
+        ShaderCache::build( program, pending->second.vertex,
+                            pending->second.fragment, &fromCache );
+
+    if( success && pending->second.autocatching )
+      program->autocatching( );
+
+    _pendingPrograms.erase( pending );
+
+    const auto end = std::chrono::steady_clock::now( );
+
+    if( !success )
+    {
+      std::cerr << "Unable to build shader program. "
+                << __FILE__ << ":" << __LINE__ << std::endl;
+    }
+    else if( LoadProfiler::enabled( ))
+    {
+      std::cout << "Built shader program " << program->program( )
+                << ( fromCache ? " from cache" : "" ) << " in "
+                << std::chrono::duration< double, std::milli >( end - start ).count( )
+                << " ms" << std::endl;
+    }
+
+    return success;
+  }
+
+  void OpenGLWidget::_startupStage( const std::string& stage )
+  {
+    if( !_startupActive )
+      return;
+
+    const auto now = std::chrono::steady_clock::now( );
+
+    std::cout << "Startup: " << stage << " at "
+              << std::chrono::duration< double, std::milli >( now - _startupBegin ).count( )
+              << " ms" << std::endl;
+  }
+
+  void OpenGLWidget::_initOITBuffers( int width_, int height_ )
+  {
+    auto functions = context( )->extraFunctions( );
+
+    _releaseOITBuffers( );
+
+    _oitWidth = width_;
+    _oitHeight = height_;
+
+    functions->glGenTextures( 1, &_oitAccumTexture );
+    functions->glBindTexture( GL_TEXTURE_2D, _oitAccumTexture );
+    functions->glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA16F, _oitWidth, _oitHeight, 0,
+                  GL_RGBA, GL_FLOAT, nullptr );
+    functions->glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST );
+    functions->glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST );
+
+    functions->glGenTextures( 1, &_oitWeightTexture );
+    functions->glBindTexture( GL_TEXTURE_2D, _oitWeightTexture );
+    functions->glTexImage2D( GL_TEXTURE_2D, 0, GL_R16F, _oitWidth, _oitHeight, 0,
+                  GL_RED, GL_FLOAT, nullptr );
+    functions->glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST );
+    functions->glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST );
+
+    functions->glBindTexture( GL_TEXTURE_2D, 0 );
+
+    // Same format as the QOpenGLWidget framebuffer so its depth can be blitted.
+    functions->glGenRenderbuffers( 1, &_oitDepthBuffer );
+    functions->glBindRenderbuffer( GL_RENDERBUFFER, _oitDepthBuffer );
+    functions->glRenderbufferStorage( GL_RENDERBUFFER, GL_DEPTH24_STENCIL8,
+                           _oitWidth, _oitHeight );
+    functions->glBindRenderbuffer( GL_RENDERBUFFER, 0 );
+
+    functions->glGenFramebuffers( 1, &_oitFramebuffer );
+    functions->glBindFramebuffer( GL_FRAMEBUFFER, _oitFramebuffer );
+    functions->glFramebufferTexture2D( GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                            GL_TEXTURE_2D, _oitAccumTexture, 0 );
+    functions->glFramebufferTexture2D( GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1,
+                            GL_TEXTURE_2D, _oitWeightTexture, 0 );
+    functions->glFramebufferRenderbuffer( GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT,
+                               GL_RENDERBUFFER, _oitDepthBuffer );
+
+    if( functions->glCheckFramebufferStatus( GL_FRAMEBUFFER ) != GL_FRAMEBUFFER_COMPLETE )
+    {
+      std::cerr << "Incomplete order independent transparency framebuffer. "
+                << __FILE__ << ":" << __LINE__ << std::endl;
+    }
+
+    functions->glBindFramebuffer( GL_FRAMEBUFFER, defaultFramebufferObject( ));
+
+    // Core profile needs a bound VAO even for attributeless draws.
+    if( !_oitVAO )
+      functions->glGenVertexArrays( 1, &_oitVAO );
+  }
+
+  void OpenGLWidget::_releaseOITBuffers( void )
+  {
+    auto functions = context( )->extraFunctions( );
+
+    if( _oitFramebuffer )
+      functions->glDeleteFramebuffers( 1, &_oitFramebuffer );
+
+    if( _oitDepthBuffer )
+      functions->glDeleteRenderbuffers( 1, &_oitDepthBuffer );
+
+    if( _oitAccumTexture )
+      functions->glDeleteTextures( 1, &_oitAccumTexture );
+
+    if( _oitWeightTexture )
+      functions->glDeleteTextures( 1, &_oitWeightTexture );
+
+    if( _oitVAO )
+      functions->glDeleteVertexArrays( 1, &_oitVAO );
+
+    _oitFramebuffer = _oitDepthBuffer = _oitVAO = 0;
+    _oitAccumTexture = _oitWeightTexture = 0;
+    _oitWidth = _oitHeight = 0;
+  }
+
+  void OpenGLWidget::_beginOITPass( void )
+  {
+    auto functions = context( )->extraFunctions( );
+
+    const int frameWidth = width( ) * devicePixelRatio( );
+    const int frameHeight = height( ) * devicePixelRatio( );
+
+    if( !_oitFramebuffer || frameWidth != _oitWidth || frameHeight != _oitHeight )
+      _initOITBuffers( frameWidth, frameHeight );
+
+    // Particles are still occluded by the opaque geometry already painted.
+    functions->glBindFramebuffer( GL_READ_FRAMEBUFFER, defaultFramebufferObject( ));
+    functions->glBindFramebuffer( GL_DRAW_FRAMEBUFFER, _oitFramebuffer );
+    functions->glBlitFramebuffer( 0, 0, _oitWidth, _oitHeight,
+                                  0, 0, _oitWidth, _oitHeight,
+                                  GL_DEPTH_BUFFER_BIT, GL_NEAREST );
+
+    functions->glBindFramebuffer( GL_FRAMEBUFFER, _oitFramebuffer );
+
+    const GLenum drawBuffers[ ] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+    functions->glDrawBuffers( 2, drawBuffers );
+
+    const GLfloat clearAccum[ ] = { 0.0f, 0.0f, 0.0f, 1.0f };
+    const GLfloat clearWeight[ ] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    functions->glClearBufferfv( GL_COLOR, 0, clearAccum );
+    functions->glClearBufferfv( GL_COLOR, 1, clearWeight );
+
+    // Color and weights are summed, revealage alpha is multiplied.
+    functions->glBlendFuncSeparate( GL_ONE, GL_ONE, GL_ZERO, GL_ONE_MINUS_SRC_ALPHA );
+  }
+
+  void OpenGLWidget::_endOITPass( void )
+  {
+    auto functions = context( )->extraFunctions( );
+
+    functions->glBindFramebuffer( GL_FRAMEBUFFER, defaultFramebufferObject( ));
+
+    functions->glDisable( GL_DEPTH_TEST );
+    functions->glBlendFunc( GL_ONE_MINUS_SRC_ALPHA, GL_SRC_ALPHA );
+
+    const bool compositePending = _pendingPrograms.count( _shaderCompositeOIT ) > 0;
+    _buildProgram( _shaderCompositeOIT );
+
+    _shaderCompositeOIT->use( );
+
+    // Sampler units are fixed, set them once.
+    if( compositePending )
+    {
+      functions->glUniform1i( functions->glGetUniformLocation( _shaderCompositeOIT->program( ), "accumTexture" ), 0 );
+      functions->glUniform1i( functions->glGetUniformLocation( _shaderCompositeOIT->program( ), "weightTexture" ), 1 );
+    }
+
+    functions->glActiveTexture( GL_TEXTURE0 );
+    functions->glBindTexture( GL_TEXTURE_2D, _oitAccumTexture );
+
+    functions->glActiveTexture( GL_TEXTURE1 );
+    functions->glBindTexture( GL_TEXTURE_2D, _oitWeightTexture );
+
+    functions->glBindVertexArray( _oitVAO );
+    functions->glDrawArrays( GL_TRIANGLES, 0, 3 );
+    functions->glBindVertexArray( 0 );
+
+    functions->glBindTexture( GL_TEXTURE_2D, 0 );
+    functions->glActiveTexture( GL_TEXTURE0 );
+    functions->glBindTexture( GL_TEXTURE_2D, 0 );
+
+    _shaderCompositeOIT->unuse( );
+
+    functions->glEnable( GL_DEPTH_TEST );
   }
 
   void OpenGLWidget::createParticleSystem( )
@@ -623,8 +1232,14 @@ namespace visimpl
     makeCurrent( );
     prefr::Config::init( );
 
-    // For debugging purposes only
-    bool success = false;
+    // Default sources, replaced by VISIMPL_SHADERS_FILE for debugging.
+    std::vector< std::string > sources =
+      { prefr::prefrVertexShader, prefr::prefrFragmentShaderDefault,
+        prefr::prefrFragmentShaderSolid, prefr::prefrVertexShaderPicking,
+        prefr::prefrFragmentShaderPicking, prefr::planeVertCode,
+        prefr::planeFragCode };
+
+    bool fromFile = false;
     const auto shadersFile = std::getenv("VISIMPL_SHADERS_FILE");
     if(shadersFile)
     {
@@ -636,60 +1251,10 @@ namespace visimpl
 
         if(shaders.size() == 7)
         {
-          bool shadersSuccess[4]{true, true, true, true};
-          auto prefrVertexShader = std::string(shaders.at(0).data(), shaders.at(0).size());
-
-          _shaderParticlesDefault = new reto::ShaderProgram( );
-          shadersSuccess[0] &= _shaderParticlesDefault->loadVertexShaderFromText( std::string(shaders.at(0).data(), shaders.at(0).size()) );
-          shadersSuccess[0] &= _shaderParticlesDefault->loadFragmentShaderFromText( std::string(shaders.at(1).data(), shaders.at(1).size()) );
-          shadersSuccess[0] &= _shaderParticlesDefault->compileAndLink( );
-          _shaderParticlesDefault->autocatching( );
-
-          if(!shadersSuccess[0])
-          {
-            std::cout << "shaders failed at _shaderParticlesDefault." << __FILE__ << ":" << __LINE__ << std::endl;
-          }
-
-          _shaderParticlesCurrent = _shaderParticlesDefault;
-          _currentShader = T_SHADER_DEFAULT;
-
-          _shaderParticlesSolid = new reto::ShaderProgram( );
-          shadersSuccess[1] &= _shaderParticlesSolid->loadVertexShaderFromText( std::string(shaders.at(0).data(), shaders.at(0).size()) );
-          shadersSuccess[1] &= _shaderParticlesSolid->loadFragmentShaderFromText( std::string(shaders.at(2).data(), shaders.at(2).size()) );
-          shadersSuccess[1] &= _shaderParticlesSolid->compileAndLink( );
-          _shaderParticlesSolid->autocatching( );
-
-          if(!shadersSuccess[1])
-          {
-            std::cout << "shaders failed at _shaderParticlesSolid." << __FILE__ << ":" << __LINE__ << std::endl;
-          }
+          for( int i = 0; i < 7; ++i )
+            sources[ i ] = std::string(shaders.at(i).data(), shaders.at(i).size());
 
-          _shaderPicking = new prefr::RenderProgram( );
-          shadersSuccess[2] &= _shaderPicking->loadVertexShaderFromText( std::string(shaders.at(3).data(), shaders.at(3).size()) );
-          shadersSuccess[2] &= _shaderPicking->loadFragmentShaderFromText( std::string(shaders.at(4).data(), shaders.at(4).size()) );
-          shadersSuccess[2] &= _shaderPicking->compileAndLink( );
-
-          if(!shadersSuccess[2])
-          {
-            std::cout << "shaders failed at _shaderPicking." << __FILE__ << ":" << __LINE__ << std::endl;
-          }
-
-          _shaderClippingPlanes = new reto::ShaderProgram( );
-          shadersSuccess[3] &= _shaderClippingPlanes->loadVertexShaderFromText( std::string(shaders.at(5).data(), shaders.at(5).size()) );
-          shadersSuccess[3] &= _shaderClippingPlanes->loadFragmentShaderFromText( std::string(shaders.at(6).data(), shaders.at(6).size()) );
-          shadersSuccess[3] &= _shaderClippingPlanes->compileAndLink( );
-          _shaderClippingPlanes->autocatching( );
-
-          if(!shadersSuccess[3])
-          {
-            std::cout << "shaders failed at _shaderClippingPlanes." << __FILE__ << ":" << __LINE__ << std::endl;
-          }
-
-          if(shadersSuccess[0] && shadersSuccess[1] && shadersSuccess[2] && shadersSuccess[3])
-          {
-            success = true;
-            std::cout << "Loaded shaders from: " << sFile.fileName().toStdString() << std::endl;
-          }
+          fromFile = true;
         }
       }
       else
@@ -698,56 +1263,88 @@ namespace visimpl
       }
     }
 
-    if(!success)
-    {
-      // Default shaders.
+    _deletePrograms( );
+    _createPrograms( sources );
 
-      // Initialize shader
-      _shaderParticlesDefault = new reto::ShaderProgram( );
-      _shaderParticlesDefault->loadVertexShaderFromText( prefr::prefrVertexShader );
-      _shaderParticlesDefault->loadFragmentShaderFromText( prefr::prefrFragmentShaderDefault );
-      _shaderParticlesDefault->compileAndLink( );
-      _shaderParticlesDefault->autocatching( );
+    // Shaders under development are built at once so a failure reverts to
+    // the default ones.
+    if( fromFile )
+    {
+      bool success = true;
+      for( reto::ShaderProgram* program :
+           { _shaderParticlesDefault, _shaderParticlesSolid,
+             static_cast< reto::ShaderProgram* >( _shaderPicking ),
+             _shaderClippingPlanes })
+      {
+        success &= _buildProgram( program );
+      }
 
-      _shaderParticlesCurrent = _shaderParticlesDefault;
-      _currentShader = T_SHADER_DEFAULT;
+      if( success )
+      {
+        std::cout << "Loaded shaders from: " << shadersFile << std::endl;
+      }
+      else
+      {
+        std::cout << "Shaders failed, reverting to default shaders." << __FILE__ << ":" << __LINE__ << std::endl;
+        _deletePrograms( );
+        _createPrograms(
+          { prefr::prefrVertexShader, prefr::prefrFragmentShaderDefault,
+            prefr::prefrFragmentShaderSolid, prefr::prefrVertexShaderPicking,
+            prefr::prefrFragmentShaderPicking, prefr::planeVertCode,
+            prefr::planeFragCode });
+      }
+    }
 
-      _shaderParticlesSolid = new reto::ShaderProgram( );
-      _shaderParticlesSolid->loadVertexShaderFromText( prefr::prefrVertexShader );
-      _shaderParticlesSolid->loadFragmentShaderFromText( prefr::prefrFragmentShaderSolid );
-      _shaderParticlesSolid->compileAndLink( );
-      _shaderParticlesSolid->autocatching( );
+    // Only the default program is needed for the first frame, the rest are
+    // built on first use, after the load profile is reported.
+    {
+      LoadProfiler::Scope scope( "Default shader program" );
+      _buildProgram( _shaderParticlesDefault );
+    }
 
-      _shaderPicking = new prefr::RenderProgram( );
-      _shaderPicking->loadVertexShaderFromText( prefr::prefrVertexShaderPicking );
-      _shaderPicking->loadFragmentShaderFromText( prefr::prefrFragmentShaderPicking );
-      _shaderPicking->compileAndLink( );
+    _shaderParticlesCurrent = _shaderParticlesDefault;
+    _currentShader = T_SHADER_DEFAULT;
 
-      _shaderClippingPlanes = new reto::ShaderProgram( );
-      _shaderClippingPlanes->loadVertexShaderFromText( prefr::planeVertCode );
-      _shaderClippingPlanes->loadFragmentShaderFromText( prefr::planeFragCode );
-      _shaderClippingPlanes->compileAndLink( );
-      _shaderClippingPlanes->autocatching( );
+    _startupStage( "Shaders" );
 
-      std::cout << "Loaded default shaders." << std::endl;
+    // Kept across datasets, its binding point does not change.
+    if( !_cameraUniforms )
+    {
+      _cameraUniforms = new CameraUniformBuffer( );
+      _cameraUniforms->init( );
     }
 
     const unsigned int maxParticles =
-        std::max(100000u, static_cast<unsigned int>( _player->gids( ).size( )));
+        std::max(100000u, static_cast<unsigned int>( _networkGIDs( ).size( )));
 
-    _updateData( );
+    // The loader thread may have built the positions already.
+    if( _gidPositions.empty( ))
+    {
+      LoadProfiler::Scope scope( "Positions" );
+      _updateData( );
+    }
 
     _particleSystem = new prefr::ParticleSystem( maxParticles, _camera );
+    _particleCapacity = maxParticles;
     _flagResetParticles = true;
 
-    _domainManager = new DomainManager( _particleSystem, _player->gids());
+    _domainManager = new DomainManager( _particleSystem, _networkGIDs( ));
+    {
+      LoadProfiler::Scope scope( "DomainManager init" );
 #ifdef SIMIL_USE_BRION
       _domainManager->init( _gidPositions, _player->data( )->blueConfig( ));
 #else
       _domainManager->init( _gidPositions );
 #endif
-    _domainManager->initializeParticleSystem( );
-    _domainManager->updateData( _player->gids(), _gidPositions);
+    }
+    {
+      LoadProfiler::Scope scope( "Particle system init" );
+      _domainManager->initializeParticleSystem( );
+    }
+    {
+      LoadProfiler::Scope scope( "DomainManager update" );
+      _domainManager->updateData( _networkGIDs( ), _gidPositions);
+    }
 
     _pickRenderer =
         dynamic_cast< prefr::GLPickRenderer* >( _particleSystem->renderer( ));
@@ -760,6 +1357,12 @@ namespace visimpl
     updateCameraBoundingBox( true );
 
     _initClippingPlanes( );
+
+    // A new particle set, the decay renderers rebuild their data.
+    _flagUpdateDecayRenderer = true;
+    _flagUpdateDecayData = true;
+
+    _startupStage( "Particle system" );
   }
 
   void OpenGLWidget::_paintParticles( void )
@@ -767,64 +1370,124 @@ namespace visimpl
     if( !_particleSystem )
       return;
 
+    // Depth test is already enabled by paintGL.
     glDepthMask(GL_FALSE);
     glEnable(GL_BLEND);
-
-    glEnable(GL_DEPTH_TEST);
     glDisable(GL_CULL_FACE);
 
-    if( _alphaBlendingAccumulative )
+    const bool orderIndependent =
+        _alphaBlendingAccumulative || _currentShader == T_SHADER_OIT;
+
+    const bool gpuDecay = _gpuDecayActive( );
+    const bool lod = _lodActive( );
+
+    if( _currentShader == T_SHADER_OIT )
+      _beginOITPass( );
+    else if( gpuDecay )
+      // Unsorted instances, additive blending does not depend on their order.
+      glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+    else if( _alphaBlendingAccumulative )
       glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_CONSTANT_ALPHA);
     else
       glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
+    reto::ShaderProgram* program = gpuDecay ?
+        _decayRenderer->program( _currentShader ) : _shaderParticlesCurrent;
 
-    glFrontFace(GL_CCW);
+    const ProgramUniforms& uniforms = _uniforms( program );
 
-    _shaderParticlesCurrent->use();
-    unsigned int shader = _shaderParticlesCurrent->program( );
+    program->use();
 
-    unsigned int uModelViewProjM;
-    unsigned int cameraUp;
-    unsigned int cameraRight;
-    unsigned int particleRadius;
+    uniforms.sendCamera( _camera->camera()->projectionViewMatrix( ),
+                         _camera->camera()->viewMatrix( ));
 
-    uModelViewProjM = glGetUniformLocation( shader, "modelViewProjM" );
-    glUniformMatrix4fv( uModelViewProjM, 1, GL_FALSE,
-                       _camera->camera()->projectionViewMatrix() );
-
-    cameraUp = glGetUniformLocation( shader, "cameraUp" );
-    cameraRight = glGetUniformLocation( shader, "cameraRight" );
-    particleRadius = glGetUniformLocation( shader, "radiusThreshold" );
-
-    float* viewM = _camera->camera()->viewMatrix( );
-
-    glUniform3f( cameraUp, viewM[1], viewM[5], viewM[9] );
-    glUniform3f( cameraRight, viewM[0], viewM[4], viewM[8] );
-
-    glUniform1f( particleRadius, _particleRadiusThreshold );
+    glUniform1f( uniforms.radiusThreshold, _particleRadiusThreshold );
 
     glm::vec3 cameraPosition ( _camera->position( )[ 0 ],
                                _camera->position( )[ 1 ],
                                _camera->position( )[ 2 ] );
 
-    if( _player->isPlaying( ) || _lastCameraPosition != cameraPosition || _flagUpdateRender )
+    // Particles do not move, so the depth order only depends on the camera.
+    // Accumulative blending and weighted blended transparency are order
+    // independent and never need a new sort.
+    // Otherwise sorting is throttled: the stale order is drawn while the
+    // camera drift stays small compared to its distance to the scene, and a
+    // full prefr sort runs once it grows or the camera comes to rest.
+    if( _lastCameraPosition != cameraPosition )
     {
-      _particleSystem->updateCameraDistances( cameraPosition );
       _lastCameraPosition = cameraPosition;
 
-      _particleSystem->updateRender( );
+      if( !orderIndependent )
+      {
+        const glm::vec3 center =
+            ( _boundingBoxHome.first + _boundingBoxHome.second ) * 0.5f;
+        const float drift = glm::distance( cameraPosition, _sortCameraPosition );
+        const float tolerance =
+            _sortDriftTolerance * glm::distance( cameraPosition, center );
+
+        if( drift > tolerance )
+          _flagUpdateRender = true;
+        else
+          _flagSortParticles = true;
+      }
+    }
+    else if( _flagSortParticles )
+    {
+      _flagUpdateRender = true;
+    }
+
+    if( lod )
+    {
+      _lodRenderer->update( _camera->camera()->viewMatrix( ),
+                            _camera->camera()->fieldOfView( ),
+                            height( ) * devicePixelRatio( ));
+      _flagUpdateRender = false;
+    }
+    else if( !gpuDecay && ( _player->isPlaying( ) || _flagUpdateRender ))
+    {
+      auto start = std::chrono::steady_clock::now( );
+
+      // updateRender would sort every frame, so the full sort is only run
+      // here when throttling allows it and the render buffers are otherwise
+      // filled in the order of the last sort.
+      if( _flagUpdateRender )
+      {
+        _particleSystem->updateCameraDistances( cameraPosition );
+
+        if( !orderIndependent )
+        {
+          _particleSystem->sorter( )->sort( );
+          _sortCameraPosition = cameraPosition;
+          _flagSortParticles = false;
+        }
+      }
+
+      auto sorted = std::chrono::steady_clock::now( );
+
+      _particleSystem->renderer( )->setupRender( );
+
+      auto updated = std::chrono::steady_clock::now( );
+
+      _sortTimeAcc += std::chrono::duration_cast< std::chrono::microseconds >
+                        ( sorted - start ).count( );
+      _bufferUpdateTimeAcc += std::chrono::duration_cast< std::chrono::microseconds >
+                                ( updated - sorted ).count( );
 
       _flagUpdateRender = false;
     }
 
     if( _clipping )
     {
-      _clippingPlaneLeft->activate( _shaderParticlesCurrent, 0 );
-      _clippingPlaneRight->activate( _shaderParticlesCurrent, 1 );
+      _clippingPlaneLeft->activate( program, 0 );
+      _clippingPlaneRight->activate( program, 1 );
     }
 
-    _particleSystem->render( );
+    if( lod )
+      _lodRenderer->render( );
+    else if( gpuDecay )
+      _decayRenderer->render( program );
+    else
+      _particleSystem->render( );
 
     if( _clipping )
     {
@@ -832,15 +1495,22 @@ namespace visimpl
       _clippingPlaneRight->deactivate( 1 );
     }
 
-    _shaderParticlesCurrent->unuse( );
+    program->unuse( );
+
+    if( _currentShader == T_SHADER_OIT )
+      _endOITPass( );
   }
 
   void OpenGLWidget::_paintPlanes( void )
   {
     if( _clipping && _paintClippingPlanes )
     {
-      _planeLeft.render( _shaderClippingPlanes );
-      _planeRight.render( _shaderClippingPlanes );
+      _buildProgram( _shaderClippingPlanes );
+
+      const ProgramUniforms& uniforms = _uniforms( _shaderClippingPlanes );
+
+      _planeLeft.render( _shaderClippingPlanes, uniforms );
+      _planeRight.render( _shaderClippingPlanes, uniforms );
     }
   }
 
@@ -873,10 +1543,20 @@ namespace visimpl
     if( _flagResetParticles )
     {
       if(_domainManager) _domainManager->resetParticles( );
+
+      // Spike times of the previous run would look recent after a rewind.
+      if( _gpuDecayActive( ))
+        _decayRenderer->reset( _player->currentTime( ));
+      else if( _lodActive( ))
+        _lodRenderer->reset( _player->currentTime( ));
+
       _flagResetParticles = false;
     }
 
-    if( _particleSystem )
+    if( _flagUpdateDecayRenderer )
+      _updateDecayRenderer( );
+
+    if( _particleSystem && !_gpuDecayActive( ) && !_lodActive( ))
       _particleSystem->update( 0.0f );
   }
 
@@ -970,6 +1650,9 @@ namespace visimpl
 
           } // if player && player->isPlaying
 
+          _cameraUniforms->update( _camera->camera()->projectionViewMatrix( ),
+                                   _camera->camera()->viewMatrix( ));
+
           _paintPlanes( );
 
           _paintParticles( );
@@ -978,6 +1661,13 @@ namespace visimpl
           {
             _pickSingle( );
           }
+
+          if( _startupActive )
+          {
+            glFinish( );
+            _startupStage( "First frame" );
+            _startupActive = false;
+          }
         } // if particleSystem
 
       }
@@ -1016,12 +1706,21 @@ namespace visimpl
 
             if( _showFps)
             {
-              _fpsLabel->setText(QString::number(fps) + QString(" FPS"));
+              const double invFrames = 0.001 / _frameCount;
+              _fpsLabel->setText( QString::number( fps ) + QString( " FPS" ) +
+                                  QString( "\nSort: " ) +
+                                  QString::number( _sortTimeAcc * invFrames, 'f', 2 ) +
+                                  QString( " ms" ) +
+                                  QString( "\nBuffers: " ) +
+                                  QString::number( _bufferUpdateTimeAcc * invFrames, 'f', 2 ) +
+                                  QString( " ms" ));
             }
           }
         }
 
         _frameCount = 0;
+        _sortTimeAcc = 0.0;
+        _bufferUpdateTimeAcc = 0.0;
       }
 
       if( _idleUpdate && _player)
@@ -1071,6 +1770,7 @@ namespace visimpl
 
     _flagModeChange = false;
     _flagUpdateRender = true;
+    _flagUpdateDecayRenderer = true;
 
     if( _domainManager && ( _domainManager->mode( ) == TMODE_ATTRIBUTE ) )
       emit attributeStatsComputed( );
@@ -1101,6 +1801,8 @@ namespace visimpl
 
       _flagUpdateSelection = false;
       _flagUpdateRender = true;
+      _flagUpdateDecayRenderer = true;
+      _flagUpdateDecaySelection = true;
     }
   }
 
@@ -1167,30 +1869,51 @@ namespace visimpl
 
   void OpenGLWidget::_updateData( void )
   {
-    const auto &positions = _player->positions();
+    buildPositions( _gidPositions, _networkGIDs( ), _networkPositions( ),
+                    _scaleFactor );
+  }
+
+  void OpenGLWidget::_updateNewData( void )
+  {
+    _flagNewData = false;
 
-    _gidPositions.clear();
-    _gidPositions.reserve(positions.size());
+    const auto& gids = _networkGIDs( );
+    const auto& positions = _networkPositions( );
 
-    auto gidit = _player->gids().begin();
-    for (const auto &pos : positions)
+    // Received networks only grow, and positions may lag behind their GIDs,
+    // so append the positioned GIDs that are not known yet.
+    const size_t available = std::min( gids.size( ), positions.size( ));
+    if( available <= _gidPositions.size( ))
+      return;
+
+    TGIDSet newGids;
+
+    auto gidit = gids.begin( );
+    auto posit = positions.begin( );
+    for( size_t i = 0; i < available; ++i, ++gidit, ++posit )
     {
-      const vec3 position(pos.x() * _scaleFactor.x,
-                          pos.y() * _scaleFactor.y,
-                          pos.z() * _scaleFactor.z);
+      if( _gidPositions.find( *gidit ) != _gidPositions.end( ))
+        continue;
 
-      _gidPositions.insert(std::make_pair(*gidit, position));
-      ++gidit;
+      const vec3 position( posit->x( ) * _scaleFactor.x,
+                           posit->y( ) * _scaleFactor.y,
+                           posit->z( ) * _scaleFactor.z );
+
+      _gidPositions.emplace( *gidit, position );
+      newGids.insert( *gidit );
     }
-  }
 
-  void OpenGLWidget::_updateNewData( void )
-  {
-    _updateData();
-    _domainManager->updateData(_player->gids(), _gidPositions );
-    _focusOn( _domainManager->boundingBox( ));
-    _flagNewData = false;
+    if( _gidPositions.size( ) > _particleCapacity )
+      _growParticleSystem( _gidPositions.size( ));
+
+    _domainManager->appendData( newGids, _gidPositions );
+
+    // Keep the camera where the user left it, only home covers the new data.
+    _boundingBoxHome = _domainManager->boundingBox( );
+
     _flagUpdateRender = true;
+    _flagUpdateDecayRenderer = true;
+    _flagUpdateDecayData = true;
   }
 
   void OpenGLWidget::setMode( int mode )
@@ -1249,11 +1972,12 @@ namespace visimpl
 
   void OpenGLWidget::_pickSingle( void )
   {
+    _buildProgram( _shaderPicking );
+
     _shaderPicking->use( );
-    unsigned int shader = _shaderPicking->program( );
-    unsigned int particleRadius = glGetUniformLocation( shader, "radiusThreshold" );
 
-    glUniform1f( particleRadius, _particleRadiusThreshold );
+    glUniform1f( _uniforms( _shaderPicking ).radiusThreshold,
+                 _particleRadiusThreshold );
 
     auto result =
         _pickRenderer->pick( _pickingPosition.x( ), _pickingPosition.y( ));
@@ -1305,12 +2029,25 @@ namespace visimpl
 
     if( update && _player )
     {
-      _updateData();
-      _domainManager->updateData(_player->gids(), _gidPositions );
+      // A scale change only rewrites the known positions from the network
+      // ones, instead of rebuilding the maps and the domain views.
+      if( !_gidPositions.empty( ))
+      {
+        rescalePositions( _gidPositions, _networkGIDs( ), _networkPositions( ),
+                          _scaleFactor );
+        _domainManager->rescalePositions( _gidPositions );
+      }
+      else
+      {
+        _updateData();
+        _domainManager->updateData( _networkGIDs( ), _gidPositions );
+      }
       _focusOn( _domainManager->boundingBox( ));
     }
 
     _flagUpdateRender = true;
+    _flagUpdateDecayRenderer = true;
+    _flagUpdateDecayData = true;
   }
 
   vec3 OpenGLWidget::circuitScaleFactor( void ) const
@@ -1322,8 +2059,13 @@ namespace visimpl
   {
     if( _player->isPlaying( ) || _firstFrame )
     {
+      if( _lodActive( ))
+        _lodRenderer->advance( renderDelta );
+      else if( _gpuDecayActive( ))
+        _decayRenderer->advance( renderDelta );
+      else
+        _particleSystem->update( renderDelta );
 
-      _particleSystem->update( renderDelta );
       _firstFrame = false;
     }
   }
@@ -1869,6 +2611,11 @@ namespace visimpl
     update( );
   }
 
+  SpikeStream* OpenGLWidget::spikeStream( void )
+  {
+    return _spikeStream;
+  }
+
   simil::SubsetEventManager* OpenGLWidget::subsetEventsManager( void )
   {
     return _subsetEvents;
@@ -2047,6 +2794,9 @@ namespace visimpl
   void OpenGLWidget::SetAlphaBlendingAccumulative( bool accumulative )
   {
     _alphaBlendingAccumulative = accumulative;
+
+    // Order was not maintained while accumulating.
+    _flagUpdateRender = true;
   }
 
   void OpenGLWidget::changeSimulationColorMapping( const TTransferFunction& colors )
@@ -2069,6 +2819,7 @@ namespace visimpl
       _domainManager->modelSelectionBase( )->color = gcolors;
 
       _flagUpdateRender = true;
+      _flagUpdateDecayRenderer = true;
     }
   }
 
@@ -2105,6 +2856,7 @@ namespace visimpl
       _domainManager->modelSelectionBase( )->size = newSize;
 
       _flagUpdateRender = true;
+      _flagUpdateDecayRenderer = true;
     }
   }
 
@@ -2174,6 +2926,8 @@ namespace visimpl
   {
     if( _domainManager )
       _domainManager->decay( value );
+
+    _flagUpdateDecayRenderer = true;
   }
 
   float OpenGLWidget::getSimulationDecayValue( void )
@@ -52,6 +52,11 @@
 #include "prefr/ColorOperationModel.h"
 
 #include "render/Plane.h"
+#include "DataLoader.h"
+#include "render/DecayRenderer.h"
+#include "render/LODRenderer.h"
+#include "render/ShaderCache.h"
+#include "render/ShaderUniforms.h"
 
 #include "DomainManager.h"
 
@@ -67,6 +72,7 @@
 #endif
 
 class QLabel;
+class QTimer;
 
 namespace visimpl
 {
@@ -149,6 +155,9 @@ namespace visimpl
 
     simil::SubsetEventManager* subsetEventsManager( void );
 
+    //! Spike source of streamed reports, nullptr when spikes are in memory.
+    SpikeStream* spikeStream( void );
+
     const scoop::ColorPalette& colorPalette( void );
 
   signals:
@@ -161,8 +170,15 @@ namespace visimpl
 
     void pickedSingle( unsigned int );
 
+    void dataLoadProgress( const QString& stage, int percentage );
+    void dataLoaded( void );
+    void dataLoadFailed( const QString& error );
+    void dataLoadCanceled( void );
+
   public slots:
 
+    void cancelLoad( void );
+
     void updateData( void );
 
     void home( void );
@@ -173,6 +189,12 @@ namespace visimpl
 
     void changeShader( int i );
 
+    void gpuDecay( bool enabled );
+    bool gpuDecay( void ) const;
+
+    void levelOfDetail( bool enabled );
+    bool levelOfDetail( void ) const;
+
     void setSelectedGIDs( const std::unordered_set< uint32_t >& gids  );
     void clearSelection( void );
 
@@ -233,6 +255,13 @@ namespace visimpl
 
     GIDVec getPlanesContainedElements( void ) const;
 
+  protected slots:
+    void _onDataLoaded( void );
+
+#ifdef SIMIL_WITH_REST_API
+    void _pollRestData( void );
+#endif
+
   protected:
     void _resolveFlagsOperations( void );
 
@@ -242,6 +271,15 @@ namespace visimpl
 
     void _focusOn( const tBoundingBox& boundingBox );
 
+    //! Network the views are built on, the received copy for REST streams.
+    const TGIDSet& _networkGIDs( void ) const;
+    const TPosVect& _networkPositions( void ) const;
+
+#ifdef SIMIL_WITH_REST_API
+    //! Copies the received network, returns whether it has grown.
+    bool _copyRestNetwork( void );
+#endif
+
     void _initClippingPlanes( void );
 
     void _genPlanesFromBoundingBox( void );
@@ -251,10 +289,33 @@ namespace visimpl
 
     void _setShaderParticles( void );
 
+    const ProgramUniforms& _uniforms( const reto::ShaderProgram* program );
+
+    void _createPrograms( const std::vector< std::string >& sources );
+    void _deletePrograms( void );
+    bool _buildProgram( reto::ShaderProgram* program );
+
+    void _startupStage( const std::string& stage );
+
+    void _initOITBuffers( int width_, int height_ );
+    void _releaseOITBuffers( void );
+    void _beginOITPass( void );
+    void _endOITPass( void );
+
     void _pickSingle( void );
 
     void _backtraceSimulation( void );
 
+    void _processInput( const simil::SpikesCRange& spikes_,
+                        float begin, float end, bool clear );
+
+    simil::SpikesCRange _spikesBetween( float begin, float end,
+                                        simil::TSpikes& buffer );
+
+    bool _gpuDecayActive( void ) const;
+    bool _lodActive( void ) const;
+    void _updateDecayRenderer( void );
+
     void _configureSimulationFrame( void );
     void _configureStepByStepFrame( double elapsedRenderTimeMilliseconds );
 
@@ -270,6 +331,9 @@ namespace visimpl
     void _updateAttributes( void );
     void _updateNewData( void );
 
+    //! Moves the domain to a particle system with at least required slots.
+    void _growParticleSystem( unsigned int required );
+
     void _updateData( void );
 
     void _createEventLabels( void );
@@ -306,6 +370,13 @@ namespace visimpl
 
     Camera* _camera;
     glm::vec3 _lastCameraPosition;
+    glm::vec3 _sortCameraPosition;
+    //! Camera drift, relative to its distance to the scene, drawn unsorted.
+    float _sortDriftTolerance;
+    bool _flagSortParticles;
+
+    double _sortTimeAcc;
+    double _bufferUpdateTimeAcc;
 
     vec3 _scaleFactor;
     bool _scaleFactorExternal;
@@ -335,10 +406,55 @@ namespace visimpl
     reto::ShaderProgram* _shaderParticlesCurrent;
     reto::ShaderProgram* _shaderParticlesDefault;
     reto::ShaderProgram* _shaderParticlesSolid;
+    reto::ShaderProgram* _shaderParticlesOIT;
+    reto::ShaderProgram* _shaderCompositeOIT;
     prefr::RenderProgram* _shaderPicking;
     reto::ShaderProgram* _shaderClippingPlanes;
 
+    //! Sources of the programs not built yet, they are built on first use.
+    struct PendingProgram
+    {
+      std::string vertex;
+      std::string fragment;
+      bool autocatching;
+    };
+
+    std::unordered_map< reto::ShaderProgram*, PendingProgram > _pendingPrograms;
+
+    //! Startup stages are only printed with --profile-load.
+    std::chrono::time_point< std::chrono::steady_clock > _startupBegin;
+    bool _startupActive;
+
+    CameraUniformBuffer* _cameraUniforms;
+    std::unordered_map< unsigned int, ProgramUniforms > _programUniforms;
+
+    unsigned int _oitFramebuffer;
+    unsigned int _oitAccumTexture;
+    unsigned int _oitWeightTexture;
+    unsigned int _oitDepthBuffer;
+    unsigned int _oitVAO;
+    int _oitWidth;
+    int _oitHeight;
+
+    DecayRenderer* _decayRenderer;
+    bool _gpuDecay;
+    bool _gpuDecayRunning;
+    bool _flagUpdateDecayRenderer;
+    bool _flagUpdateDecayData;
+    bool _flagUpdateDecaySelection;
+
+    LODRenderer* _lodRenderer;
+    bool _lod;
+    bool _lodRunning;
+
+    DataLoader* _dataLoader;
+    InitialConfig _loadConfig;
+
+    SpikeStream* _spikeStream;
+    simil::TSpikes _streamSpikes;
+
     prefr::ParticleSystem* _particleSystem;
+    unsigned int _particleCapacity;
     prefr::GLPickRenderer* _pickRenderer;
 
     simil::TSimulationType _simulationType;
@@ -346,6 +462,9 @@ namespace visimpl
 
 #ifdef SIMIL_WITH_REST_API
     simil::LoaderSimData* _importer;
+    QTimer* _restTimer;
+    TGIDSet _restGIDs;
+    TPosVect _restPositions;
 #endif
 
     reto::ClippingPlane* _clippingPlaneLeft;
@@ -377,6 +496,7 @@ namespace visimpl
 
     simil::SpikesCRange _sbsStepSpikes;
     simil::SpikesCIter _sbsCurrentSpike;
+    simil::TSpikes _sbsStreamSpikes;
 
     bool _sbsPlaying;
     bool _sbsFirstStep;
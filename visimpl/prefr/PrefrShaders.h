@@ -30,9 +30,13 @@ const static std::string prefrVertexShader = R"(
 #version 400
 //#extension GL_ARB_separate_shader_objects: enable
 
-uniform mat4 modelViewProjM;
-uniform vec3 cameraUp;
-uniform vec3 cameraRight;
+// Per-frame camera data, shared through a uniform buffer.
+layout(std140) uniform CameraData
+{
+  mat4 modelViewProjM;
+  vec3 cameraUp;
+  vec3 cameraRight;
+};
 
 // Clipping planes
 uniform vec4 plane[ 2 ];
@@ -62,6 +66,98 @@ void main()
 
 )";
 
+// Particles decaying on the GPU from their last spike time. Unselected
+// neurons (w = 0) keep the inactive appearance.
+const static std::string prefrVertexShaderDecay = R"(#version 400
+
+layout(std140) uniform CameraData
+{
+  mat4 modelViewProjM;
+  vec3 cameraUp;
+  vec3 cameraRight;
+};
+
+uniform sampler2D spikeTimes;
+uniform sampler1D colorFunction;
+uniform sampler1D sizeFunction;
+uniform float currentTime;
+uniform float invDecay;
+uniform vec4 offColor;
+uniform float offSize;
+
+// Clipping planes
+uniform vec4 plane[ 2 ];
+out float gl_ClipDistance[ 2 ];
+
+layout(location = 0) in vec3 vertexPosition;
+layout(location = 1) in vec4 particlePosition;
+
+out vec4 color;
+out vec2 uvCoord;
+
+void main()
+{
+  int width = textureSize( spikeTimes, 0 ).x;
+  float lastSpike = texelFetch( spikeTimes,
+    ivec2( gl_InstanceID % width, gl_InstanceID / width ), 0 ).r;
+
+  float refLife = clamp(( currentTime - lastSpike ) * invDecay, 0.0, 1.0 );
+
+  float samples = float( textureSize( colorFunction, 0 ));
+  float coord = ( refLife * ( samples - 1.0 ) + 0.5 ) / samples;
+
+  vec4 particleColor = offColor;
+  float size = offSize;
+
+  if( particlePosition.w > 0.0 )
+  {
+    particleColor = texture( colorFunction, coord );
+    size = texture( sizeFunction, coord ).r;
+  }
+
+  vec4 position = vec4((vertexPosition.x * size * cameraRight) +
+                  (vertexPosition.y * size * cameraUp) +
+                  particlePosition.xyz, 1.0);
+
+  gl_ClipDistance[ 0 ] = dot( position, plane[ 0 ]);
+  gl_ClipDistance[ 1 ] = dot( position, plane[ 1 ]);
+
+  gl_Position = modelViewProjM * position;
+
+  color = particleColor;
+  uvCoord = vertexPosition.rg + vec2(0.5, 0.5);
+})";
+
+// Writes each spike time into the texel of its neuron.
+const static std::string decayScatterVertCode = R"(#version 400
+
+uniform int width;
+uniform int height;
+
+layout(location = 0) in uint spikeIndex;
+layout(location = 1) in float spikeTime;
+
+flat out float time;
+
+void main()
+{
+  ivec2 texel = ivec2( int( spikeIndex ) % width, int( spikeIndex ) / width );
+  vec2 position = ( vec2( texel ) + 0.5 ) / vec2( width, height );
+
+  gl_Position = vec4( position * 2.0 - 1.0, 0.0, 1.0 );
+  time = spikeTime;
+})";
+
+const static std::string decayScatterFragCode = R"(#version 400
+
+flat in float time;
+out vec4 outputColor;
+
+void main()
+{
+  outputColor = vec4( time, 0.0, 0.0, 1.0 );
+})";
+
 const static std::string prefrFragmentShaderDefault = R"(
 #version 400
 in vec4 color; 
@@ -95,13 +191,62 @@ void main()
   outputColor = color;
 })";
 
+// Weighted blended order-independent transparency (McGuire & Bavoil 2013).
+// Attachment 0 accumulates weighted premultiplied color in rgb and the
+// revealage product in alpha, attachment 1 accumulates the weights.
+const static std::string prefrFragmentShaderOIT = R"(#version 400
+in vec4 color;
+in vec2 uvCoord;
+layout(location = 0) out vec4 accumColor;
+layout(location = 1) out vec4 accumWeight;
+void main()
+{
+  vec2 p = -1.0 + 2.0 * uvCoord;
+  float l = sqrt(dot(p,p));
+  l = 1.0 - clamp(l, 0.0, 1.0);
+  float alpha = l * color.a;
+
+  float depth = 1.0 - gl_FragCoord.z * 0.9;
+  float weight = clamp( pow( min( 1.0, alpha * 10.0 ) + 0.01, 3.0 ) * 1e8 *
+                        depth * depth * depth, 1e-2, 3e3 );
+
+  accumColor = vec4( color.rgb * alpha * weight, alpha );
+  accumWeight = vec4( alpha * weight, 0.0, 0.0, 0.0 );
+})";
+
+const static std::string oitCompositeVertCode = R"(#version 400
+void main( )
+{
+  vec2 position = vec2(( gl_VertexID << 1 ) & 2, gl_VertexID & 2 );
+  gl_Position = vec4( position * 2.0 - 1.0, 0.0, 1.0 );
+})";
+
+const static std::string oitCompositeFragCode = R"(#version 400
+uniform sampler2D accumTexture;
+uniform sampler2D weightTexture;
+out vec4 outputColor;
+void main( )
+{
+  ivec2 coord = ivec2( gl_FragCoord.xy );
+  vec4 accum = texelFetch( accumTexture, coord, 0 );
+
+  float revealage = accum.a;
+  if( revealage >= 1.0 )
+    discard;
+
+  float weight = texelFetch( weightTexture, coord, 0 ).r;
+  outputColor = vec4( accum.rgb / max( weight, 1e-5 ), revealage );
+})";
+
 const static std::string prefrVertexShaderPicking = R"(#version 400
 #extension GL_ARB_separate_shader_objects: enable
 
-uniform mat4 modelViewProjM;
-
-uniform vec3 cameraUp;
-uniform vec3 cameraRight;
+layout(std140) uniform CameraData
+{
+  mat4 modelViewProjM;
+  vec3 cameraUp;
+  vec3 cameraRight;
+};
 
 uniform vec4 plane[ 2 ];
 out float gl_ClipDistance[ 2 ];
@@ -172,7 +317,13 @@ const static std::string planeVertCode = R"(
 
 in vec3 inPos;
 
-uniform mat4 viewProj;
+layout(std140) uniform CameraData
+{
+  mat4 modelViewProjM;
+  vec3 cameraUp;
+  vec3 cameraRight;
+};
+
 uniform vec4 inColor;
 
 out vec4 outColor;
@@ -182,7 +333,7 @@ void main( )
   outColor = inColor;
   //gl_Position = vec4( quadVertices[ gl_VertexID ], 0.0, 1.0 );
   //gl_Position = vec4( inPos.rg, 1.0 );
-  gl_Position = viewProj * vec4( inPos, 1.0 ); 
+  gl_Position = modelViewProjM * vec4( inPos, 1.0 );
 }
 
 )";
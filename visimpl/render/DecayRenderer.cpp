@@ -0,0 +1,437 @@
+/*
+ * Copyright (c) 2015-2020 VG-Lab/URJC.
+ *
+ * Authors: Sergio E. Galindo <sergio.galindo@urjc.es>
+ *
+ * This file is part of ViSimpl <https://github.com/vg-lab/visimpl>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "DecayRenderer.h"
+
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <string>
+
+#include "../prefr/PrefrShaders.h"
+
+constexpr int SPIKE_TIMES_WIDTH = 4096;
+constexpr int TRANSFER_FUNCTION_SAMPLES = 256;
+
+// Time of neurons that never spiked, far enough to be always fully decayed.
+constexpr float NO_SPIKE_TIME = -1e30f;
+
+namespace visimpl
+{
+  DecayRenderer::DecayRenderer( )
+  : _vao( 0 )
+  , _vboVertices( 0 )
+  , _vboPositions( 0 )
+  , _scatterVao( 0 )
+  , _vboSpikes( 0 )
+  , _spikeTimesTexture( 0 )
+  , _spikeTimesFramebuffer( 0 )
+  , _spikeTimesWidth( SPIKE_TIMES_WIDTH )
+  , _spikeTimesHeight( 0 )
+  , _colorTexture( 0 )
+  , _sizeTexture( 0 )
+  , _scatterProgram( nullptr )
+  , _scatterWidth( -1 )
+  , _scatterHeight( -1 )
+  , _instances( 0 )
+  , _currentTime( 0.0f )
+  , _decay( 1.0f )
+  , _offColor( 0.1f, 0.1f, 0.1f, 0.2f )
+  , _offSize( 10.0f )
+  {
+    std::fill( _programs, _programs + T_SHADER_UNDEFINED, nullptr );
+  }
+
+  DecayRenderer::~DecayRenderer( )
+  {
+    for( auto program : _programs )
+      delete program;
+
+    delete _scatterProgram;
+
+    if( _vao )
+    {
+      glDeleteVertexArrays( 1, &_vao );
+      glDeleteVertexArrays( 1, &_scatterVao );
+
+      const unsigned int buffers[ ] = { _vboVertices, _vboPositions, _vboSpikes };
+      glDeleteBuffers( 3, buffers );
+
+      const unsigned int textures[ ] =
+          { _spikeTimesTexture, _colorTexture, _sizeTexture };
+      glDeleteTextures( 3, textures );
+
+      glDeleteFramebuffers( 1, &_spikeTimesFramebuffer );
+    }
+  }
+
+  void DecayRenderer::init( void )
+  {
+    const std::string* fragmentShaders[ T_SHADER_UNDEFINED ] =
+        { &prefr::prefrFragmentShaderDefault,
+          &prefr::prefrFragmentShaderSolid,
+          &prefr::prefrFragmentShaderOIT };
+
+    for( unsigned int i = 0; i < T_SHADER_UNDEFINED; ++i )
+    {
+      _programs[ i ] = new reto::ShaderProgram( );
+      _programs[ i ]->loadVertexShaderFromText( prefr::prefrVertexShaderDecay );
+      _programs[ i ]->loadFragmentShaderFromText( *fragmentShaders[ i ]);
+      _programs[ i ]->compileAndLink( );
+      _programs[ i ]->autocatching( );
+
+      const unsigned int program = _programs[ i ]->program( );
+      DecayUniforms& uniforms = _uniforms[ i ];
+      uniforms.spikeTimes = glGetUniformLocation( program, "spikeTimes" );
+      uniforms.colorFunction = glGetUniformLocation( program, "colorFunction" );
+      uniforms.sizeFunction = glGetUniformLocation( program, "sizeFunction" );
+      uniforms.currentTime = glGetUniformLocation( program, "currentTime" );
+      uniforms.invDecay = glGetUniformLocation( program, "invDecay" );
+      uniforms.offColor = glGetUniformLocation( program, "offColor" );
+      uniforms.offSize = glGetUniformLocation( program, "offSize" );
+
+      // Texture units never change.
+      _programs[ i ]->use( );
+      glUniform1i( uniforms.spikeTimes, 0 );
+      glUniform1i( uniforms.colorFunction, 1 );
+      glUniform1i( uniforms.sizeFunction, 2 );
+      _programs[ i ]->unuse( );
+    }
+
+    _scatterProgram = new reto::ShaderProgram( );
+    _scatterProgram->loadVertexShaderFromText( prefr::decayScatterVertCode );
+    _scatterProgram->loadFragmentShaderFromText( prefr::decayScatterFragCode );
+    _scatterProgram->compileAndLink( );
+
+    _scatterWidth = glGetUniformLocation( _scatterProgram->program( ), "width" );
+    _scatterHeight = glGetUniformLocation( _scatterProgram->program( ), "height" );
+
+    // Billboard quad, same layout as prefr particles.
+    const float vertices[ ] = { -0.5f, -0.5f, 0.0f,
+                                0.5f, -0.5f, 0.0f,
+                                -0.5f, 0.5f, 0.0f,
+                                0.5f, 0.5f, 0.0f };
+
+    glGenVertexArrays( 1, &_vao );
+    glBindVertexArray( _vao );
+
+    glGenBuffers( 1, &_vboVertices );
+    glBindBuffer( GL_ARRAY_BUFFER, _vboVertices );
+    glBufferData( GL_ARRAY_BUFFER, sizeof( vertices ), vertices, GL_STATIC_DRAW );
+    glVertexAttribPointer( 0, 3, GL_FLOAT, GL_FALSE, 0, 0 );
+    glEnableVertexAttribArray( 0 );
+
+    glGenBuffers( 1, &_vboPositions );
+    glBindBuffer( GL_ARRAY_BUFFER, _vboPositions );
+    glVertexAttribPointer( 1, 4, GL_FLOAT, GL_FALSE, 0, 0 );
+    glEnableVertexAttribArray( 1 );
+    glVertexAttribDivisor( 1, 1 );
+
+    glGenVertexArrays( 1, &_scatterVao );
+    glBindVertexArray( _scatterVao );
+
+    glGenBuffers( 1, &_vboSpikes );
+    glBindBuffer( GL_ARRAY_BUFFER, _vboSpikes );
+    glVertexAttribIPointer( 0, 1, GL_UNSIGNED_INT, sizeof( SpikeEntry ),
+                            ( void* ) offsetof( SpikeEntry, instance ));
+    glEnableVertexAttribArray( 0 );
+    glVertexAttribPointer( 1, 1, GL_FLOAT, GL_FALSE, sizeof( SpikeEntry ),
+                           ( void* ) offsetof( SpikeEntry, time ));
+    glEnableVertexAttribArray( 1 );
+
+    glBindVertexArray( 0 );
+    glBindBuffer( GL_ARRAY_BUFFER, 0 );
+
+    glGenTextures( 1, &_spikeTimesTexture );
+    glGenFramebuffers( 1, &_spikeTimesFramebuffer );
+
+    glGenTextures( 1, &_colorTexture );
+    glBindTexture( GL_TEXTURE_1D, _colorTexture );
+    glTexParameteri( GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
+    glTexParameteri( GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+    glTexParameteri( GL_TEXTURE_1D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
+
+    glGenTextures( 1, &_sizeTexture );
+    glBindTexture( GL_TEXTURE_1D, _sizeTexture );
+    glTexParameteri( GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
+    glTexParameteri( GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+    glTexParameteri( GL_TEXTURE_1D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
+
+    glBindTexture( GL_TEXTURE_1D, 0 );
+  }
+
+  void DecayRenderer::setData( const TGIDSet& gids,
+                               const tGidPosMap& positions,
+                               const GIDUSet& selection )
+  {
+    _instances = gids.size( );
+
+    _gidToInstance.clear( );
+    _gidToInstance.reserve( _instances );
+
+    // Position plus a selected flag in w.
+    std::vector< float >& buffer = _instanceData;
+    buffer.clear( );
+    buffer.reserve( _instances * 4 );
+
+    uint32_t instance = 0;
+    for( const auto gid : gids )
+    {
+      const auto position = positions.find( gid );
+      const vec3 pos = position == positions.end( ) ? vec3( 0.0f ) : position->second;
+      const bool selected = selection.empty( ) || selection.find( gid ) != selection.end( );
+
+      buffer.insert( buffer.end( ), { pos.x, pos.y, pos.z, selected ? 1.0f : 0.0f });
+
+      _gidToInstance.insert( std::make_pair( gid, instance ));
+      ++instance;
+    }
+
+    glBindBuffer( GL_ARRAY_BUFFER, _vboPositions );
+    glBufferData( GL_ARRAY_BUFFER, sizeof( float ) * buffer.size( ),
+                  buffer.data( ), GL_STATIC_DRAW );
+    glBindBuffer( GL_ARRAY_BUFFER, 0 );
+
+    _spikeTimesHeight = std::max( 1, static_cast< int >(
+        ( _instances + _spikeTimesWidth - 1 ) / _spikeTimesWidth ));
+
+    glBindTexture( GL_TEXTURE_2D, _spikeTimesTexture );
+    glTexImage2D( GL_TEXTURE_2D, 0, GL_R32F, _spikeTimesWidth, _spikeTimesHeight,
+                  0, GL_RED, GL_FLOAT, nullptr );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST );
+    glBindTexture( GL_TEXTURE_2D, 0 );
+
+    GLint previousFramebuffer = 0;
+    glGetIntegerv( GL_FRAMEBUFFER_BINDING, &previousFramebuffer );
+
+    glBindFramebuffer( GL_FRAMEBUFFER, _spikeTimesFramebuffer );
+    glFramebufferTexture2D( GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                            GL_TEXTURE_2D, _spikeTimesTexture, 0 );
+
+    if( glCheckFramebufferStatus( GL_FRAMEBUFFER ) != GL_FRAMEBUFFER_COMPLETE )
+    {
+      std::cerr << "Incomplete spike times framebuffer. "
+                << __FILE__ << ":" << __LINE__ << std::endl;
+    }
+
+    glBindFramebuffer( GL_FRAMEBUFFER, previousFramebuffer );
+
+    _clearSpikeTimes( );
+  }
+
+  void DecayRenderer::selection( const GIDUSet& selection )
+  {
+    if( _instanceData.empty( ))
+      return;
+
+    for( const auto& instance : _gidToInstance )
+    {
+      const bool selected = selection.empty( ) ||
+                            selection.find( instance.first ) != selection.end( );
+      _instanceData[ instance.second * 4 + 3 ] = selected ? 1.0f : 0.0f;
+    }
+
+    glBindBuffer( GL_ARRAY_BUFFER, _vboPositions );
+    glBufferSubData( GL_ARRAY_BUFFER, 0, sizeof( float ) * _instanceData.size( ),
+                     _instanceData.data( ));
+    glBindBuffer( GL_ARRAY_BUFFER, 0 );
+  }
+
+  void DecayRenderer::transferFunction( prefr::Model* model )
+  {
+    std::vector< glm::vec4 > colors( TRANSFER_FUNCTION_SAMPLES );
+    std::vector< float > sizes( TRANSFER_FUNCTION_SAMPLES );
+
+    const float invSamples = 1.0f / ( TRANSFER_FUNCTION_SAMPLES - 1 );
+    for( int i = 0; i < TRANSFER_FUNCTION_SAMPLES; ++i )
+    {
+      colors[ i ] = model->color.GetValue( i * invSamples );
+      sizes[ i ] = model->size.GetValue( i * invSamples );
+    }
+
+    glBindTexture( GL_TEXTURE_1D, _colorTexture );
+    glTexImage1D( GL_TEXTURE_1D, 0, GL_RGBA32F, TRANSFER_FUNCTION_SAMPLES, 0,
+                  GL_RGBA, GL_FLOAT, colors.data( ));
+
+    glBindTexture( GL_TEXTURE_1D, _sizeTexture );
+    glTexImage1D( GL_TEXTURE_1D, 0, GL_R32F, TRANSFER_FUNCTION_SAMPLES, 0,
+                  GL_RED, GL_FLOAT, sizes.data( ));
+
+    glBindTexture( GL_TEXTURE_1D, 0 );
+  }
+
+  void DecayRenderer::offModel( prefr::Model* model )
+  {
+    _offColor = model->color.GetValue( 0.0f );
+    _offSize = model->size.GetValue( 0.0f );
+  }
+
+  void DecayRenderer::decay( float decayValue )
+  {
+    _decay = decayValue;
+  }
+
+  float DecayRenderer::decay( void ) const
+  {
+    return _decay;
+  }
+
+  void DecayRenderer::_clearSpikeTimes( void )
+  {
+    GLint previousFramebuffer = 0;
+    glGetIntegerv( GL_FRAMEBUFFER_BINDING, &previousFramebuffer );
+
+    const GLfloat clearValue[ ] = { NO_SPIKE_TIME, 0.0f, 0.0f, 0.0f };
+
+    glBindFramebuffer( GL_FRAMEBUFFER, _spikeTimesFramebuffer );
+    glClearBufferfv( GL_COLOR, 0, clearValue );
+    glBindFramebuffer( GL_FRAMEBUFFER, previousFramebuffer );
+  }
+
+  void DecayRenderer::processInput( const simil::SpikesCRange& spikes_,
+                                    float /*begin*/, float end, bool clear )
+  {
+    if( clear )
+      _clearSpikeTimes( );
+
+    _currentTime = end;
+
+    _spikes.clear( );
+    for( auto spike = spikes_.first; spike != spikes_.second; ++spike )
+    {
+      const auto instance = _gidToInstance.find( spike->second );
+      if( instance != _gidToInstance.end( ))
+        _spikes.push_back( SpikeEntry{ instance->second, spike->first });
+    }
+
+    if( _spikes.empty( ))
+      return;
+
+    glBindBuffer( GL_ARRAY_BUFFER, _vboSpikes );
+    glBufferData( GL_ARRAY_BUFFER, sizeof( SpikeEntry ) * _spikes.size( ),
+                  _spikes.data( ), GL_STREAM_DRAW );
+    glBindBuffer( GL_ARRAY_BUFFER, 0 );
+
+    GLint previousFramebuffer = 0;
+    GLint previousViewport[ 4 ];
+    glGetIntegerv( GL_FRAMEBUFFER_BINDING, &previousFramebuffer );
+    glGetIntegerv( GL_VIEWPORT, previousViewport );
+
+    const GLboolean depthTest = glIsEnabled( GL_DEPTH_TEST );
+    const GLboolean blend = glIsEnabled( GL_BLEND );
+
+    glBindFramebuffer( GL_FRAMEBUFFER, _spikeTimesFramebuffer );
+    glViewport( 0, 0, _spikeTimesWidth, _spikeTimesHeight );
+
+    glDisable( GL_DEPTH_TEST );
+
+    // Keep the latest spike when a neuron fires several times in a frame.
+    glEnable( GL_BLEND );
+    glBlendEquation( GL_MAX );
+
+    _scatterProgram->use( );
+    glUniform1i( _scatterWidth, _spikeTimesWidth );
+    glUniform1i( _scatterHeight, _spikeTimesHeight );
+
+    glBindVertexArray( _scatterVao );
+    glDrawArrays( GL_POINTS, 0, _spikes.size( ));
+    glBindVertexArray( 0 );
+
+    _scatterProgram->unuse( );
+
+    glBlendEquation( GL_FUNC_ADD );
+
+    if( !blend )
+      glDisable( GL_BLEND );
+
+    if( depthTest )
+      glEnable( GL_DEPTH_TEST );
+
+    glBindFramebuffer( GL_FRAMEBUFFER, previousFramebuffer );
+    glViewport( previousViewport[ 0 ], previousViewport[ 1 ],
+                previousViewport[ 2 ], previousViewport[ 3 ]);
+  }
+
+  void DecayRenderer::advance( float delta )
+  {
+    _currentTime += delta;
+  }
+
+  void DecayRenderer::currentTime( float time )
+  {
+    _currentTime = time;
+  }
+
+  void DecayRenderer::reset( float time )
+  {
+    _clearSpikeTimes( );
+    _currentTime = time;
+  }
+
+  reto::ShaderProgram* DecayRenderer::program( tShaderParticlesType shader )
+  {
+    if( shader >= T_SHADER_UNDEFINED )
+      return _programs[ T_SHADER_DEFAULT ];
+
+    return _programs[ shader ];
+  }
+
+  void DecayRenderer::render( reto::ShaderProgram* program_ )
+  {
+    if( _instances == 0 )
+      return;
+
+    const auto found = std::find( _programs, _programs + T_SHADER_UNDEFINED, program_ );
+    if( found == _programs + T_SHADER_UNDEFINED )
+      return;
+
+    const DecayUniforms& uniforms = _uniforms[ found - _programs ];
+
+    glActiveTexture( GL_TEXTURE0 );
+    glBindTexture( GL_TEXTURE_2D, _spikeTimesTexture );
+
+    glActiveTexture( GL_TEXTURE1 );
+    glBindTexture( GL_TEXTURE_1D, _colorTexture );
+
+    glActiveTexture( GL_TEXTURE2 );
+    glBindTexture( GL_TEXTURE_1D, _sizeTexture );
+
+    glUniform1f( uniforms.currentTime, _currentTime );
+    glUniform1f( uniforms.invDecay, _decay > 0.0f ? 1.0f / _decay : 0.0f );
+    glUniform4f( uniforms.offColor, _offColor.r, _offColor.g, _offColor.b,
+                 _offColor.a );
+    glUniform1f( uniforms.offSize, _offSize );
+
+    glBindVertexArray( _vao );
+    glDrawArraysInstanced( GL_TRIANGLE_STRIP, 0, 4, _instances );
+    glBindVertexArray( 0 );
+
+    glBindTexture( GL_TEXTURE_1D, 0 );
+    glActiveTexture( GL_TEXTURE1 );
+    glBindTexture( GL_TEXTURE_1D, 0 );
+    glActiveTexture( GL_TEXTURE0 );
+    glBindTexture( GL_TEXTURE_2D, 0 );
+  }
+}
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2015-2020 VG-Lab/URJC.
+ *
+ * Authors: Sergio E. Galindo <sergio.galindo@urjc.es>
+ *
+ * This file is part of ViSimpl <https://github.com/vg-lab/visimpl>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef VISIMPL_RENDER_DECAYRENDERER_H_
+#define VISIMPL_RENDER_DECAYRENDERER_H_
+
+// ReTo
+#include <reto/reto.h>
+
+// Prefr
+#include <prefr/prefr.h>
+
+// Simil
+#include <simil/simil.h>
+
+// Visimpl
+#include "../types.h"
+
+namespace visimpl
+{
+  /*! \brief Renders neuron activity decaying on the GPU.
+   *
+   * Every neuron keeps its last spike time in a float texture. Each frame
+   * only the spikes of that frame are uploaded and scattered into that
+   * texture, and the vertex shader computes color and size from the elapsed
+   * time through the transfer function textures. CPU work per frame is
+   * proportional to the number of spikes instead of the number of neurons.
+   *
+   * Particles are drawn in GID order, without depth sorting, so they are
+   * blended additively or through order independent transparency.
+   */
+  class DecayRenderer
+  {
+  public:
+    DecayRenderer( );
+    ~DecayRenderer( );
+
+    void init( void );
+
+    void setData( const TGIDSet& gids, const tGidPosMap& positions,
+                  const GIDUSet& selection );
+
+    //! Rewrites the selected flags only, positions and spike times are kept.
+    void selection( const GIDUSet& selection );
+
+    void transferFunction( prefr::Model* model );
+
+    //! Color and size of unselected neurons, from the model's first value.
+    void offModel( prefr::Model* model );
+
+    void decay( float decayValue );
+    float decay( void ) const;
+
+    void processInput( const simil::SpikesCRange& spikes_,
+                       float begin, float end, bool clear );
+
+    void advance( float delta );
+    void currentTime( float time );
+
+    //! Forgets every spike time, after the playback is rewound or moved.
+    void reset( float time );
+
+    reto::ShaderProgram* program( tShaderParticlesType shader );
+
+    void render( reto::ShaderProgram* program_ );
+
+  protected:
+
+    void _clearSpikeTimes( void );
+
+    unsigned int _vao;
+    unsigned int _vboVertices;
+    unsigned int _vboPositions;
+
+    unsigned int _scatterVao;
+    unsigned int _vboSpikes;
+
+    unsigned int _spikeTimesTexture;
+    unsigned int _spikeTimesFramebuffer;
+    int _spikeTimesWidth;
+    int _spikeTimesHeight;
+
+    unsigned int _colorTexture;
+    unsigned int _sizeTexture;
+
+    struct DecayUniforms
+    {
+      int spikeTimes;
+      int colorFunction;
+      int sizeFunction;
+      int currentTime;
+      int invDecay;
+      int offColor;
+      int offSize;
+    };
+
+    reto::ShaderProgram* _programs[ T_SHADER_UNDEFINED ];
+    DecayUniforms _uniforms[ T_SHADER_UNDEFINED ];
+
+    reto::ShaderProgram* _scatterProgram;
+    int _scatterWidth;
+    int _scatterHeight;
+
+    std::unordered_map< uint32_t, uint32_t > _gidToInstance;
+    unsigned int _instances;
+
+    // Host copy of the instance buffer, position plus selected flag in w.
+    std::vector< float > _instanceData;
+
+    struct SpikeEntry
+    {
+      uint32_t instance;
+      float time;
+    };
+
+    std::vector< SpikeEntry > _spikes;
+
+    float _currentTime;
+    float _decay;
+
+    glm::vec4 _offColor;
+    float _offSize;
+  };
+}
+
+#endif /* VISIMPL_RENDER_DECAYRENDERER_H_ */
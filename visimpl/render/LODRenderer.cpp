@@ -0,0 +1,511 @@
+/*
+ * Copyright (c) 2015-2020 VG-Lab/URJC.
+ *
+ * Authors: Sergio E. Galindo <sergio.galindo@urjc.es>
+ *
+ * This file is part of ViSimpl <https://github.com/vg-lab/visimpl>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "LODRenderer.h"
+
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+constexpr unsigned int LOD_MAX_LEAF_SIZE = 32;
+constexpr unsigned int LOD_MAX_DEPTH = 16;
+
+constexpr unsigned int TRANSFER_FUNCTION_SAMPLES = 256;
+
+// Mean member activity mapped to a fully active impostor.
+constexpr float LOD_ACTIVITY_GAIN = 10.0f;
+
+constexpr float NO_SPIKE_TIME = -std::numeric_limits< float >::infinity( );
+
+namespace visimpl
+{
+  LODRenderer::LODRenderer( )
+  : _vao( 0 )
+  , _vboVertices( 0 )
+  , _vboPositions( 0 )
+  , _vboColors( 0 )
+  , _offColor( 0.1f, 0.1f, 0.1f, 0.2f )
+  , _offSize( 10.0f )
+  , _pixelThreshold( 8.0f )
+  , _currentTime( 0.0f )
+  , _decay( 1.0f )
+  { }
+
+  LODRenderer::~LODRenderer( )
+  {
+    if( _vao )
+    {
+      glDeleteVertexArrays( 1, &_vao );
+
+      const unsigned int buffers[ ] = { _vboVertices, _vboPositions, _vboColors };
+      glDeleteBuffers( 3, buffers );
+    }
+  }
+
+  void LODRenderer::init( void )
+  {
+    // Same attribute layout as prefr particles so the particle programs apply.
+    const float vertices[ ] = { -0.5f, -0.5f, 0.0f,
+                                0.5f, -0.5f, 0.0f,
+                                -0.5f, 0.5f, 0.0f,
+                                0.5f, 0.5f, 0.0f };
+
+    glGenVertexArrays( 1, &_vao );
+    glBindVertexArray( _vao );
+
+    glGenBuffers( 1, &_vboVertices );
+    glBindBuffer( GL_ARRAY_BUFFER, _vboVertices );
+    glBufferData( GL_ARRAY_BUFFER, sizeof( vertices ), vertices, GL_STATIC_DRAW );
+    glVertexAttribPointer( 0, 3, GL_FLOAT, GL_FALSE, 0, 0 );
+    glEnableVertexAttribArray( 0 );
+
+    glGenBuffers( 1, &_vboPositions );
+    glBindBuffer( GL_ARRAY_BUFFER, _vboPositions );
+    glVertexAttribPointer( 1, 4, GL_FLOAT, GL_FALSE, 0, 0 );
+    glEnableVertexAttribArray( 1 );
+    glVertexAttribDivisor( 1, 1 );
+
+    glGenBuffers( 1, &_vboColors );
+    glBindBuffer( GL_ARRAY_BUFFER, _vboColors );
+    glVertexAttribPointer( 2, 4, GL_FLOAT, GL_FALSE, 0, 0 );
+    glEnableVertexAttribArray( 2 );
+    glVertexAttribDivisor( 2, 1 );
+
+    glBindVertexArray( 0 );
+    glBindBuffer( GL_ARRAY_BUFFER, 0 );
+  }
+
+  void LODRenderer::setData( const TGIDSet& gids,
+                             const tGidPosMap& positions,
+                             const GIDUSet& selection )
+  {
+    _positions.clear( );
+    _selected.clear( );
+    _gidToNeuron.clear( );
+    _nodes.clear( );
+
+    _positions.reserve( gids.size( ));
+    _selected.reserve( gids.size( ));
+    _gidToNeuron.reserve( gids.size( ));
+
+    for( const auto gid : gids )
+    {
+      const auto position = positions.find( gid );
+      if( position == positions.end( ))
+        continue;
+
+      _gidToNeuron.insert( std::make_pair( gid, _positions.size( )));
+      _positions.push_back( position->second );
+      _selected.push_back( selection.empty( ) ||
+                           selection.find( gid ) != selection.end( ));
+    }
+
+    _order.resize( _positions.size( ));
+    for( unsigned int i = 0; i < _order.size( ); ++i )
+      _order[ i ] = i;
+
+    _neuronLeaf.assign( _positions.size( ), -1 );
+    _lastSpike.assign( _positions.size( ), NO_SPIKE_TIME );
+
+    if( _positions.empty( ))
+      return;
+
+    OctreeNode root;
+    root.first = 0;
+    root.count = _order.size( );
+    root.parent = -1;
+    _nodes.push_back( root );
+
+    _build( 0, 0 );
+
+    _clearActivity( );
+  }
+
+  void LODRenderer::_build( unsigned int nodeIdx, unsigned int depth )
+  {
+    const unsigned int first = _nodes[ nodeIdx ].first;
+    const unsigned int count = _nodes[ nodeIdx ].count;
+
+    vec3 minimum( std::numeric_limits< float >::max( ));
+    vec3 maximum( std::numeric_limits< float >::lowest( ));
+    unsigned int selected = 0;
+
+    for( unsigned int i = first; i < first + count; ++i )
+    {
+      minimum = glm::min( minimum, _positions[ _order[ i ]]);
+      maximum = glm::max( maximum, _positions[ _order[ i ]]);
+
+      if( _selected[ _order[ i ]])
+        ++selected;
+    }
+
+    const vec3 center = ( minimum + maximum ) * 0.5f;
+
+    OctreeNode& node = _nodes[ nodeIdx ];
+    node.center = center;
+    node.selected = selected;
+    node.radius = glm::length( maximum - center );
+    std::fill( node.children, node.children + 8, -1 );
+
+    if( count <= LOD_MAX_LEAF_SIZE || depth >= LOD_MAX_DEPTH ||
+        node.radius <= 0.0f )
+    {
+      for( unsigned int i = first; i < first + count; ++i )
+        _neuronLeaf[ _order[ i ]] = nodeIdx;
+
+      return;
+    }
+
+    auto octant = [ this, &center ]( unsigned int neuron )
+    {
+      const vec3& position = _positions[ neuron ];
+      return ( position.x > center.x ? 1 : 0 ) |
+             ( position.y > center.y ? 2 : 0 ) |
+             ( position.z > center.z ? 4 : 0 );
+    };
+
+    // Counting sort of the node range by octant.
+    unsigned int sizes[ 8 ] = { 0 };
+    for( unsigned int i = first; i < first + count; ++i )
+      ++sizes[ octant( _order[ i ])];
+
+    unsigned int offsets[ 8 ];
+    unsigned int offset = first;
+    for( unsigned int i = 0; i < 8; ++i )
+    {
+      offsets[ i ] = offset;
+      offset += sizes[ i ];
+    }
+
+    std::vector< unsigned int > sorted( count );
+    unsigned int cursors[ 8 ];
+    std::copy( offsets, offsets + 8, cursors );
+    for( unsigned int i = first; i < first + count; ++i )
+    {
+      const unsigned int neuron = _order[ i ];
+      sorted[ cursors[ octant( neuron )]++ - first ] = neuron;
+    }
+    std::copy( sorted.begin( ), sorted.end( ), _order.begin( ) + first );
+
+    for( unsigned int i = 0; i < 8; ++i )
+    {
+      if( sizes[ i ] == 0 )
+        continue;
+
+      OctreeNode child;
+      child.first = offsets[ i ];
+      child.count = sizes[ i ];
+      child.parent = nodeIdx;
+
+      // _nodes may reallocate, do not keep references across push_back.
+      const int childIdx = _nodes.size( );
+      _nodes.push_back( child );
+      _nodes[ nodeIdx ].children[ i ] = childIdx;
+
+      _build( childIdx, depth + 1 );
+    }
+  }
+
+  void LODRenderer::selection( const GIDUSet& selection )
+  {
+    for( const auto& neuron : _gidToNeuron )
+      _selected[ neuron.second ] = selection.empty( ) ||
+                                   selection.find( neuron.first ) != selection.end( );
+
+    for( auto& node : _nodes )
+      node.selected = 0;
+
+    for( unsigned int neuron = 0; neuron < _positions.size( ); ++neuron )
+    {
+      if( !_selected[ neuron ])
+        continue;
+
+      for( int nodeIdx = _neuronLeaf[ neuron ]; nodeIdx >= 0;
+           nodeIdx = _nodes[ nodeIdx ].parent )
+        ++_nodes[ nodeIdx ].selected;
+    }
+
+    // Unselected neurons do not add activity, it has to be replayed.
+    _clearActivity( );
+  }
+
+  void LODRenderer::transferFunction( prefr::Model* model )
+  {
+    _colors.resize( TRANSFER_FUNCTION_SAMPLES );
+    _sizes.resize( TRANSFER_FUNCTION_SAMPLES );
+
+    const float invSamples = 1.0f / ( TRANSFER_FUNCTION_SAMPLES - 1 );
+    for( unsigned int i = 0; i < TRANSFER_FUNCTION_SAMPLES; ++i )
+    {
+      _colors[ i ] = model->color.GetValue( i * invSamples );
+      _sizes[ i ] = model->size.GetValue( i * invSamples );
+    }
+  }
+
+  void LODRenderer::offModel( prefr::Model* model )
+  {
+    _offColor = model->color.GetValue( 0.0f );
+    _offSize = model->size.GetValue( 0.0f );
+  }
+
+  unsigned int LODRenderer::_sample( float refLife ) const
+  {
+    return std::round( refLife * ( TRANSFER_FUNCTION_SAMPLES - 1 ));
+  }
+
+  void LODRenderer::decay( float decayValue )
+  {
+    _decay = decayValue;
+  }
+
+  float LODRenderer::decay( void ) const
+  {
+    return _decay;
+  }
+
+  void LODRenderer::pixelThreshold( float pixels )
+  {
+    _pixelThreshold = std::max( 1.0f, pixels );
+  }
+
+  float LODRenderer::pixelThreshold( void ) const
+  {
+    return _pixelThreshold;
+  }
+
+  void LODRenderer::_clearActivity( void )
+  {
+    std::fill( _lastSpike.begin( ), _lastSpike.end( ), NO_SPIKE_TIME );
+
+    for( auto& node : _nodes )
+    {
+      node.activity = 0.0f;
+      node.time = _currentTime;
+    }
+  }
+
+  float LODRenderer::_activity( const OctreeNode& node ) const
+  {
+    // Exponential decay with most of the contribution gone after _decay.
+    const float invTau = _decay > 0.0f ? 3.0f / _decay : 0.0f;
+    const float elapsed = std::max( 0.0f, _currentTime - node.time );
+    return node.activity * std::exp( -elapsed * invTau );
+  }
+
+  void LODRenderer::_addSpike( unsigned int neuron, float time )
+  {
+    _lastSpike[ neuron ] = std::max( _lastSpike[ neuron ], time );
+
+    const float invTau = _decay > 0.0f ? 3.0f / _decay : 0.0f;
+
+    for( int nodeIdx = _neuronLeaf[ neuron ]; nodeIdx >= 0;
+         nodeIdx = _nodes[ nodeIdx ].parent )
+    {
+      OctreeNode& node = _nodes[ nodeIdx ];
+
+      if( time >= node.time )
+      {
+        node.activity = node.activity * std::exp( -( time - node.time ) * invTau ) + 1.0f;
+        node.time = time;
+      }
+      else
+      {
+        node.activity += std::exp( -( node.time - time ) * invTau );
+      }
+    }
+  }
+
+  void LODRenderer::processInput( const simil::SpikesCRange& spikes_,
+                                  float /*begin*/, float end, bool clear )
+  {
+    if( clear )
+      _clearActivity( );
+
+    _currentTime = end;
+
+    for( auto spike = spikes_.first; spike != spikes_.second; ++spike )
+    {
+      const auto neuron = _gidToNeuron.find( spike->second );
+      if( neuron != _gidToNeuron.end( ) && _selected[ neuron->second ])
+        _addSpike( neuron->second, spike->first );
+    }
+  }
+
+  void LODRenderer::advance( float delta )
+  {
+    _currentTime += delta;
+  }
+
+  void LODRenderer::currentTime( float time )
+  {
+    _currentTime = time;
+  }
+
+  void LODRenderer::reset( float time )
+  {
+    // Node times are set to the current time when cleared.
+    _currentTime = time;
+    _clearActivity( );
+  }
+
+  void LODRenderer::_emitNeuron( unsigned int neuron, const vec3& eye )
+  {
+    if( !_selected[ neuron ])
+    {
+      DrawElement element;
+      element.position = glm::vec4( _positions[ neuron ], _offSize );
+      element.color = _offColor;
+      element.distance = glm::distance( eye, _positions[ neuron ]);
+
+      _elements.push_back( element );
+      return;
+    }
+
+    const float refLife = _decay > 0.0f ?
+        glm::clamp(( _currentTime - _lastSpike[ neuron ]) / _decay, 0.0f, 1.0f ) : 1.0f;
+
+    const vec3& position = _positions[ neuron ];
+
+    const unsigned int sample = _sample( refLife );
+
+    DrawElement element;
+    element.position = glm::vec4( position, _sizes[ sample ]);
+    element.color = _colors[ sample ];
+    element.distance = glm::distance( eye, position );
+
+    _elements.push_back( element );
+  }
+
+  void LODRenderer::_emitNode( const OctreeNode& node, float distance )
+  {
+    if( node.selected == 0 )
+    {
+      DrawElement element;
+      element.position = glm::vec4( node.center,
+                                    std::max( 2.0f * node.radius, _offSize ));
+      element.color = _offColor;
+      element.distance = distance;
+
+      _elements.push_back( element );
+      return;
+    }
+
+    const float meanActivity = _activity( node ) / node.selected;
+    const float refLife =
+        1.0f - glm::clamp( meanActivity * LOD_ACTIVITY_GAIN, 0.0f, 1.0f );
+
+    const unsigned int sample = _sample( refLife );
+
+    DrawElement element;
+    element.position = glm::vec4( node.center,
+                                  std::max( 2.0f * node.radius, _sizes[ sample ]));
+    element.color = _colors[ sample ];
+    element.distance = distance;
+
+    _elements.push_back( element );
+  }
+
+  void LODRenderer::update( const float* viewMatrix, float fieldOfView,
+                            int viewportHeight )
+  {
+    _elements.clear( );
+
+    if( _nodes.empty( ) || _colors.empty( ))
+      return;
+
+    // Eye position from the column-major view matrix: -R^T * t.
+    const float* t = viewMatrix + 12;
+    const vec3 eye( -( viewMatrix[ 0 ] * t[ 0 ] + viewMatrix[ 1 ] * t[ 1 ] + viewMatrix[ 2 ] * t[ 2 ]),
+                    -( viewMatrix[ 4 ] * t[ 0 ] + viewMatrix[ 5 ] * t[ 1 ] + viewMatrix[ 6 ] * t[ 2 ]),
+                    -( viewMatrix[ 8 ] * t[ 0 ] + viewMatrix[ 9 ] * t[ 1 ] + viewMatrix[ 10 ] * t[ 2 ]));
+
+    const float pixelsPerUnit = viewportHeight / ( 2.0f * std::tan( fieldOfView * 0.5f ));
+
+    std::vector< unsigned int > pending = { 0 };
+    while( !pending.empty( ))
+    {
+      const OctreeNode& node = _nodes[ pending.back( )];
+      pending.pop_back( );
+
+      const float centerDistance = glm::distance( eye, node.center );
+      const float distance = std::max( centerDistance - node.radius, 1e-3f );
+      const float pixels = 2.0f * node.radius / distance * pixelsPerUnit;
+
+      if( pixels <= _pixelThreshold )
+      {
+        _emitNode( node, centerDistance );
+      }
+      else if( std::none_of( node.children, node.children + 8,
+                             []( int child ){ return child >= 0; }))
+      {
+        for( unsigned int i = node.first; i < node.first + node.count; ++i )
+          _emitNeuron( _order[ i ], eye );
+      }
+      else
+      {
+        for( const int child : node.children )
+          if( child >= 0 )
+            pending.push_back( child );
+      }
+    }
+
+    // The cut is small, sort it back to front every frame.
+    std::sort( _elements.begin( ), _elements.end( ),
+               []( const DrawElement& a, const DrawElement& b )
+               { return a.distance > b.distance; });
+
+    _bufferPositions.resize( _elements.size( ));
+    _bufferColors.resize( _elements.size( ));
+    for( unsigned int i = 0; i < _elements.size( ); ++i )
+    {
+      _bufferPositions[ i ] = _elements[ i ].position;
+      _bufferColors[ i ] = _elements[ i ].color;
+    }
+
+    glBindBuffer( GL_ARRAY_BUFFER, _vboPositions );
+    glBufferData( GL_ARRAY_BUFFER, sizeof( glm::vec4 ) * _bufferPositions.size( ),
+                  _bufferPositions.data( ), GL_STREAM_DRAW );
+
+    glBindBuffer( GL_ARRAY_BUFFER, _vboColors );
+    glBufferData( GL_ARRAY_BUFFER, sizeof( glm::vec4 ) * _bufferColors.size( ),
+                  _bufferColors.data( ), GL_STREAM_DRAW );
+
+    glBindBuffer( GL_ARRAY_BUFFER, 0 );
+  }
+
+  void LODRenderer::render( void )
+  {
+    if( _elements.empty( ))
+      return;
+
+    glBindVertexArray( _vao );
+    glDrawArraysInstanced( GL_TRIANGLE_STRIP, 0, 4, _elements.size( ));
+    glBindVertexArray( 0 );
+  }
+
+  unsigned int LODRenderer::drawnElements( void ) const
+  {
+    return _elements.size( );
+  }
+}
@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2015-2020 VG-Lab/URJC.
+ *
+ * Authors: Sergio E. Galindo <sergio.galindo@urjc.es>
+ *
+ * This file is part of ViSimpl <https://github.com/vg-lab/visimpl>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef VISIMPL_RENDER_LODRENDERER_H_
+#define VISIMPL_RENDER_LODRENDERER_H_
+
+// Prefr
+#include <prefr/prefr.h>
+
+// Simil
+#include <simil/simil.h>
+
+// Visimpl
+#include "../types.h"
+
+namespace visimpl
+{
+  /*! \brief Level of detail rendering of large circuits.
+   *
+   * An octree is built over the neuron positions. Every frame the tree is
+   * cut where nodes project below a pixel threshold and those nodes are
+   * drawn as a single impostor colored by the summed activity of their
+   * members, while nodes close to the camera are refined down to individual
+   * neurons. The number of drawn elements depends on the screen resolution
+   * and not on the circuit size.
+   *
+   * Node activity decays exponentially so spikes only update the path from
+   * their leaf to the root. Neurons outside the selection are drawn with
+   * the off model and do not add activity to their nodes.
+   */
+  class LODRenderer
+  {
+  public:
+    LODRenderer( );
+    ~LODRenderer( );
+
+    void init( void );
+
+    void setData( const TGIDSet& gids, const tGidPosMap& positions,
+                  const GIDUSet& selection );
+
+    //! Updates the selected neurons and node counts, the octree is kept.
+    void selection( const GIDUSet& selection );
+
+    void transferFunction( prefr::Model* model );
+
+    //! Color and size of the neurons outside the selection.
+    void offModel( prefr::Model* model );
+
+    void decay( float decayValue );
+    float decay( void ) const;
+
+    void pixelThreshold( float pixels );
+    float pixelThreshold( void ) const;
+
+    void processInput( const simil::SpikesCRange& spikes_,
+                       float begin, float end, bool clear );
+
+    void advance( float delta );
+    void currentTime( float time );
+
+    //! Forgets every activity, after the playback is rewound or moved.
+    void reset( float time );
+
+    void update( const float* viewMatrix, float fieldOfView, int viewportHeight );
+
+    void render( void );
+
+    unsigned int drawnElements( void ) const;
+
+  protected:
+
+    struct OctreeNode
+    {
+      vec3 center;
+      float radius;
+      unsigned int first;
+      unsigned int count;
+      unsigned int selected;
+      int children[ 8 ];
+      int parent;
+      float activity;
+      float time;
+    };
+
+    struct DrawElement
+    {
+      glm::vec4 position;
+      glm::vec4 color;
+      float distance;
+    };
+
+    void _build( unsigned int nodeIdx, unsigned int depth );
+    void _clearActivity( void );
+    void _addSpike( unsigned int neuron, float time );
+    float _activity( const OctreeNode& node ) const;
+    unsigned int _sample( float refLife ) const;
+
+    void _emitNeuron( unsigned int neuron, const vec3& eye );
+    void _emitNode( const OctreeNode& node, float distance );
+
+    std::vector< OctreeNode > _nodes;
+
+    std::vector< vec3 > _positions;
+    std::vector< unsigned int > _order;
+    std::vector< int > _neuronLeaf;
+    std::vector< float > _lastSpike;
+    std::vector< bool > _selected;
+
+    std::unordered_map< uint32_t, unsigned int > _gidToNeuron;
+
+    std::vector< DrawElement > _elements;
+    std::vector< glm::vec4 > _bufferPositions;
+    std::vector< glm::vec4 > _bufferColors;
+
+    std::vector< glm::vec4 > _colors;
+    std::vector< float > _sizes;
+
+    glm::vec4 _offColor;
+    float _offSize;
+
+    unsigned int _vao;
+    unsigned int _vboVertices;
+    unsigned int _vboPositions;
+    unsigned int _vboColors;
+
+    float _pixelThreshold;
+    float _currentTime;
+    float _decay;
+  };
+}
+
+#endif /* VISIMPL_RENDER_LODRENDERER_H_ */
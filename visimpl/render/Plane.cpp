@@ -97,7 +97,8 @@ namespace visimpl
     return _points;
   }
 
-  void Plane::render( reto::ShaderProgram* program_ )
+  void Plane::render( reto::ShaderProgram* program_,
+                      const ProgramUniforms& uniforms )
   {
     assert( _camera );
 
@@ -108,8 +109,10 @@ namespace visimpl
 
     glDisable( GL_CULL_FACE );
 
-    program_->sendUniform4m( "viewProj", _camera->projectionViewMatrix( ));
-    program_->sendUniform4v( "inColor", _color.data( ));
+    if( !uniforms.cameraBlock )
+      program_->sendUniform4m( "viewProj", _camera->projectionViewMatrix( ));
+
+    glUniform4fv( uniforms.inColor, 1, _color.data( ));
 
     glDrawArrays(GL_LINE_LOOP, 0, 4);
 
@@ -28,6 +28,7 @@
 
 // Visimpl
 #include "../types.h"
+#include "ShaderUniforms.h"
 
 namespace visimpl
 {
@@ -41,7 +42,8 @@ namespace visimpl
     const std::vector< evec3 >& points( void ) const;
 
     void init( reto::Camera* camera );
-    void render( reto::ShaderProgram* program_ );
+    void render( reto::ShaderProgram* program_,
+                 const ProgramUniforms& uniforms );
 
     void color( evec4 color_ );
 
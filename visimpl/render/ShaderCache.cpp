@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2015-2020 VG-Lab/URJC.
+ *
+ * Authors: Sergio E. Galindo <sergio.galindo@urjc.es>
+ *
+ * This file is part of ViSimpl <https://github.com/vg-lab/visimpl>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+#include "ShaderCache.h"
+
+#include <GL/glew.h>
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+namespace visimpl
+{
+  static const char SHADER_CACHE_MAGIC[ 4 ] = { 'V', 'S', 'H', 'B' };
+
+  static const int SHADER_CACHE_HEADER =
+      sizeof( SHADER_CACHE_MAGIC ) + sizeof( uint32_t );
+
+  static std::string glString( GLenum name )
+  {
+    const auto value = reinterpret_cast< const char* >( glGetString( name ));
+    return value ? std::string( value ) : std::string( );
+  }
+
+  bool ShaderCache::build( reto::ShaderProgram* program,
+                           const std::string& vertexSource,
+                           const std::string& fragmentSource,
+                           bool* fromCache )
+  {
+    if( fromCache )
+      *fromCache = false;
+
+    const bool useCache = enabled( ) && _supported( );
+    const QString fileName = useCache ?
+        _cacheFile( vertexSource, fragmentSource ) : QString( );
+
+    if( useCache && _loadBinary( program, fileName ))
+    {
+      if( fromCache )
+        *fromCache = true;
+
+      return true;
+    }
+
+    if( !program->loadVertexShaderFromText( vertexSource ) ||
+        !program->loadFragmentShaderFromText( fragmentSource ) ||
+        !program->create( ))
+      return false;
+
+    if( useCache )
+      glProgramParameteri( program->program( ),
+                           GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE );
+
+    if( !program->link( ))
+      return false;
+
+    if( useCache )
+      _storeBinary( program->program( ), fileName );
+
+    return true;
+  }
+
+  bool ShaderCache::enabled( void )
+  {
+    return std::getenv( "VISIMPL_DISABLE_SHADER_CACHE" ) == nullptr;
+  }
+
+  bool ShaderCache::_supported( void )
+  {
+    if( !glGetProgramBinary || !glProgramBinary || !glProgramParameteri )
+      return false;
+
+    GLint formats = 0;
+    glGetIntegerv( GL_NUM_PROGRAM_BINARY_FORMATS, &formats );
+
+    return formats > 0;
+  }
+
+  QString ShaderCache::_cacheFile( const std::string& vertexSource,
+                                   const std::string& fragmentSource )
+  {
+    // Binaries are only valid for the driver that produced them.
+    const std::string key =
+        glString( GL_VENDOR ) + "|" + glString( GL_RENDERER ) + "|" +
+        glString( GL_VERSION ) + "|" + vertexSource + '\0' + fragmentSource;
+
+    const QByteArray hash =
+        QCryptographicHash::hash( QByteArray::fromStdString( key ),
+                                  QCryptographicHash::Sha1 ).toHex( );
+
+    const QString dir =
+        QStandardPaths::writableLocation( QStandardPaths::CacheLocation ) +
+        "/shaders";
+
+    return dir + "/" + QString::fromLatin1( hash ) + ".bin";
+  }
+
+  bool ShaderCache::_loadBinary( reto::ShaderProgram* program,
+                                 const QString& fileName )
+  {
+    QFile file( fileName );
+    if( !file.exists( ) || !file.open( QIODevice::ReadOnly ))
+      return false;
+
+    const QByteArray contents = file.readAll( );
+    if( contents.size( ) <= SHADER_CACHE_HEADER ||
+        std::memcmp( contents.constData( ), SHADER_CACHE_MAGIC,
+                     sizeof( SHADER_CACHE_MAGIC )) != 0 )
+      return false;
+
+    uint32_t format = 0;
+    std::memcpy( &format, contents.constData( ) + sizeof( SHADER_CACHE_MAGIC ),
+                 sizeof( format ));
+
+    const char* binary = contents.constData( ) + SHADER_CACHE_HEADER;
+    const GLsizei length = contents.size( ) - SHADER_CACHE_HEADER;
+
+    // Drivers reject binaries they can no longer use. They are tried on a
+    // program of our own first, so a rejected one leaves the ReTo program
+    // untouched and it is built from source as usual.
+    const GLuint probe = glCreateProgram( );
+    glProgramBinary( probe, format, binary, length );
+    const bool accepted = _linked( probe );
+    glDeleteProgram( probe );
+
+    if( !accepted || !program->create( ))
+      return false;
+
+    glProgramBinary( program->program( ), format, binary, length );
+
+    return _linked( program->program( ));
+  }
+
+  bool ShaderCache::_linked( unsigned int program )
+  {
+    GLint linked = GL_FALSE;
+    glGetProgramiv( program, GL_LINK_STATUS, &linked );
+
+    return linked == GL_TRUE;
+  }
+
+  void ShaderCache::_storeBinary( unsigned int program, const QString& fileName )
+  {
+    GLint length = 0;
+    glGetProgramiv( program, GL_PROGRAM_BINARY_LENGTH, &length );
+    if( length <= 0 )
+      return;
+
+    std::vector< char > binary( length );
+    GLsizei written = 0;
+    GLenum format = 0;
+    glGetProgramBinary( program, length, &written, &format, binary.data( ));
+    if( written <= 0 )
+      return;
+
+    QDir( ).mkpath( QFileInfo( fileName ).absolutePath( ));
+
+    QSaveFile file( fileName );
+    if( !file.open( QIODevice::WriteOnly ))
+    {
+      std::cerr << "Unable to write shader cache "
+                << fileName.toStdString( ) << " "
+                << __FILE__ << ":" << __LINE__ << std::endl;
+      return;
+    }
+
+    const uint32_t storedFormat = format;
+    file.write( SHADER_CACHE_MAGIC, sizeof( SHADER_CACHE_MAGIC ));
+    file.write( reinterpret_cast< const char* >( &storedFormat ),
+                sizeof( storedFormat ));
+    file.write( binary.data( ), written );
+
+    if( !file.commit( ))
+    {
+      std::cerr << "Unable to write shader cache "
+                << fileName.toStdString( ) << " "
+                << __FILE__ << ":" << __LINE__ << std::endl;
+    }
+  }
+}
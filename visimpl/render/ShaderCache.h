@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2015-2020 VG-Lab/URJC.
+ *
+ * Authors: Sergio E. Galindo <sergio.galindo@urjc.es>
+ *
+ * This file is part of ViSimpl <https://github.com/vg-lab/visimpl>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+#ifndef VISIMPL_RENDER_SHADERCACHE_H_
+#define VISIMPL_RENDER_SHADERCACHE_H_
+
+// ReTo
+#include <reto/reto.h>
+
+// Qt
+#include <QString>
+
+#include <string>
+
+namespace visimpl
+{
+  /*! \brief On-disk cache of linked shader program binaries.
+   *
+   * Programs are linked once from source and their driver specific binary
+   * is stored in the user cache directory, keyed by the GL vendor, renderer
+   * and version and by the program sources. Later builds of the same program
+   * on the same driver load that binary instead of compiling again.
+   *
+   * Setting VISIMPL_DISABLE_SHADER_CACHE in the environment bypasses it.
+   */
+  class ShaderCache
+  {
+  public:
+
+    /*! \brief Builds the program from the cached binary if present,
+     * otherwise compiles and links the sources and stores the binary.
+     * Requires a current GL context.
+     * \param fromCache optionally returns whether the cache was used.
+     */
+    static bool build( reto::ShaderProgram* program,
+                       const std::string& vertexSource,
+                       const std::string& fragmentSource,
+                       bool* fromCache = nullptr );
+
+    static bool enabled( void );
+
+  protected:
+
+    static bool _supported( void );
+
+    static QString _cacheFile( const std::string& vertexSource,
+                               const std::string& fragmentSource );
+
+    static bool _loadBinary( reto::ShaderProgram* program,
+                             const QString& fileName );
+    static bool _linked( unsigned int program );
+    static void _storeBinary( unsigned int program, const QString& fileName );
+  };
+}
+
+#endif /* VISIMPL_RENDER_SHADERCACHE_H_ */
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2015-2020 VG-Lab/URJC.
+ *
+ * Authors: Sergio E. Galindo <sergio.galindo@urjc.es>
+ *
+ * This file is part of ViSimpl <https://github.com/vg-lab/visimpl>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "ShaderUniforms.h"
+
+#include <GL/glew.h>
+
+#include <cstring>
+
+namespace visimpl
+{
+  ProgramUniforms::ProgramUniforms( )
+  : modelViewProjM( -1 )
+  , cameraUp( -1 )
+  , cameraRight( -1 )
+  , radiusThreshold( -1 )
+  , inColor( -1 )
+  , cameraBlock( false )
+  { }
+
+  void ProgramUniforms::resolve( unsigned int program )
+  {
+    modelViewProjM = glGetUniformLocation( program, "modelViewProjM" );
+    cameraUp = glGetUniformLocation( program, "cameraUp" );
+    cameraRight = glGetUniformLocation( program, "cameraRight" );
+    radiusThreshold = glGetUniformLocation( program, "radiusThreshold" );
+    inColor = glGetUniformLocation( program, "inColor" );
+
+    const unsigned int blockIndex = glGetUniformBlockIndex( program, "CameraData" );
+    cameraBlock = ( blockIndex != GL_INVALID_INDEX );
+
+    if( cameraBlock )
+      glUniformBlockBinding( program, blockIndex, CAMERA_UNIFORM_BINDING );
+  }
+
+  void ProgramUniforms::sendCamera( const float* projectionView,
+                                     const float* view ) const
+  {
+    if( cameraBlock )
+      return;
+
+    glUniformMatrix4fv( modelViewProjM, 1, GL_FALSE, projectionView );
+    glUniform3f( cameraUp, view[ 1 ], view[ 5 ], view[ 9 ]);
+    glUniform3f( cameraRight, view[ 0 ], view[ 4 ], view[ 8 ]);
+  }
+
+  CameraUniformBuffer::CameraUniformBuffer( )
+  : _ubo( 0 )
+  {
+    std::memset( _data, 0, sizeof( _data ));
+  }
+
+  CameraUniformBuffer::~CameraUniformBuffer( )
+  {
+    if( _ubo )
+      glDeleteBuffers( 1, &_ubo );
+  }
+
+  void CameraUniformBuffer::init( void )
+  {
+    glGenBuffers( 1, &_ubo );
+    glBindBuffer( GL_UNIFORM_BUFFER, _ubo );
+    glBufferData( GL_UNIFORM_BUFFER, sizeof( _data ), _data, GL_DYNAMIC_DRAW );
+    glBindBuffer( GL_UNIFORM_BUFFER, 0 );
+
+    glBindBufferBase( GL_UNIFORM_BUFFER, CAMERA_UNIFORM_BINDING, _ubo );
+  }
+
+  void CameraUniformBuffer::update( const float* projectionView,
+                                    const float* view )
+  {
+    // std140: mat4 at 0, vec3 cameraUp at 64, vec3 cameraRight at 80.
+    std::memcpy( _data, projectionView, sizeof( float ) * 16 );
+
+    _data[ 16 ] = view[ 1 ];
+    _data[ 17 ] = view[ 5 ];
+    _data[ 18 ] = view[ 9 ];
+
+    _data[ 20 ] = view[ 0 ];
+    _data[ 21 ] = view[ 4 ];
+    _data[ 22 ] = view[ 8 ];
+
+    glBindBuffer( GL_UNIFORM_BUFFER, _ubo );
+    glBufferSubData( GL_UNIFORM_BUFFER, 0, sizeof( _data ), _data );
+    glBindBuffer( GL_UNIFORM_BUFFER, 0 );
+
+    glBindBufferBase( GL_UNIFORM_BUFFER, CAMERA_UNIFORM_BINDING, _ubo );
+  }
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2015-2020 VG-Lab/URJC.
+ *
+ * Authors: Sergio E. Galindo <sergio.galindo@urjc.es>
+ *
+ * This file is part of ViSimpl <https://github.com/vg-lab/visimpl>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef VISIMPL_RENDER_SHADERUNIFORMS_H_
+#define VISIMPL_RENDER_SHADERUNIFORMS_H_
+
+namespace visimpl
+{
+  constexpr unsigned int CAMERA_UNIFORM_BINDING = 0;
+
+  /*! \brief Uniform locations of a particle or plane program.
+   *
+   * Resolved once after linking. Programs declaring the CameraData block get
+   * the camera from the shared uniform buffer, others (e.g. shaders loaded
+   * through VISIMPL_SHADERS_FILE) keep receiving plain uniforms.
+   */
+  struct ProgramUniforms
+  {
+    ProgramUniforms( );
+
+    void resolve( unsigned int program );
+
+    void sendCamera( const float* projectionView, const float* view ) const;
+
+    int modelViewProjM;
+    int cameraUp;
+    int cameraRight;
+    int radiusThreshold;
+    int inColor;
+    bool cameraBlock;
+  };
+
+  //! Per-frame camera data shared by particle, picking and plane programs.
+  class CameraUniformBuffer
+  {
+  public:
+    CameraUniformBuffer( );
+    ~CameraUniformBuffer( );
+
+    void init( void );
+
+    void update( const float* projectionView, const float* view );
+
+  protected:
+    unsigned int _ubo;
+    float _data[ 24 ];
+  };
+}
+
+#endif /* VISIMPL_RENDER_SHADERUNIFORMS_H_ */
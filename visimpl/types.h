@@ -26,6 +26,9 @@
 #include <sumrice/sumrice.h>
 #include <reto/reto.h>
 
+#include <algorithm>
+#include <iterator>
+
 namespace visimpl
 {
   typedef Eigen::Vector3f evec3;
@@ -46,6 +49,7 @@ namespace visimpl
   {
     T_SHADER_DEFAULT = 0,
     T_SHADER_SOLID,
+    T_SHADER_OIT,
     T_SHADER_UNDEFINED
   };
 
@@ -56,6 +60,63 @@ namespace visimpl
   typedef std::unordered_multimap< unsigned int, unsigned int > tUintUMultimap;
   typedef std::vector< std::pair< unsigned int, unsigned int >> tUintPairs;
 
+  //! Fills the GID to position map, scaling the positions in parallel before
+  //! the (inherently serial) hash insertion.
+  static inline void buildPositions( tGidPosMap& result, const TGIDSet& gids,
+                                     const TPosVect& positions,
+                                     const vec3& scale )
+  {
+    const int count =
+        static_cast< int >( std::min( positions.size( ), gids.size( )));
+    std::vector< vec3 > scaled( count );
+
+    #pragma omp parallel for
+    for( int i = 0; i < count; ++i )
+    {
+      const auto& pos = positions[ i ];
+      scaled[ i ] = vec3( pos.x( ) * scale.x,
+                          pos.y( ) * scale.y,
+                          pos.z( ) * scale.z );
+    }
+
+    result.clear( );
+    result.reserve( count );
+
+    auto gidit = gids.begin( );
+    for( const auto& pos : scaled )
+    {
+      result.emplace( *gidit, pos );
+      ++gidit;
+    }
+  }
+
+  //! Rewrites the positions of the GIDs already in result as their original
+  //! position times scale, in parallel. Starting from the originals keeps
+  //! repeated scale changes from accumulating rounding errors. Keys and
+  //! buckets are left untouched.
+  static inline void rescalePositions( tGidPosMap& result, const TGIDSet& gids,
+                                       const TPosVect& positions,
+                                       const vec3& scale )
+  {
+    const int count =
+        static_cast< int >( std::min( positions.size( ), gids.size( )));
+    const std::vector< unsigned int > ids( gids.begin( ),
+                                           std::next( gids.begin( ), count ));
+
+    #pragma omp parallel for
+    for( int i = 0; i < count; ++i )
+    {
+      const auto it = result.find( ids[ i ]);
+      if( it == result.end( ))
+        continue;
+
+      const auto& pos = positions[ i ];
+      it->second = vec3( pos.x( ) * scale.x,
+                         pos.y( ) * scale.y,
+                         pos.z( ) * scale.z );
+    }
+  }
+
   enum tNeuronAttributes
   {
     T_TYPE_MORPHO = 0,
@@ -95,6 +95,10 @@ int main( int argc, char** argv )
     {
       dumpVersion( );
     }
+    if ( std::strcmp( argv[i], "--profile-load" ) == 0 )
+    {
+      visimpl::LoadProfiler::enabled( true );
+    }
     if( std::strcmp( argv[ i ], "-zeq" ) == 0 )
     {
 #ifdef VISIMPL_USE_ZEROEQ
@@ -348,6 +352,8 @@ void usageMessage( char* progName )
             << std::endl
             << "\t[ --testFile [path] ]"
             << std::endl
+            << "\t[ --profile-load ]"
+            << std::endl
             << "\t[ --version ]"
             << std::endl
             << "\t[ --help | -h ]"